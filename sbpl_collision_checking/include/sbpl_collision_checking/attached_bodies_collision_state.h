@@ -95,6 +95,8 @@ public:
     bool updateSphereStates(int ssidx);
     bool updateSphereState(const SphereIndex& sidx);
 
+    auto updateSpheresStateTransform(int ssidx) -> const Eigen::Affine3d&;
+
     auto groupSpheresStateIndices(const std::string& group_name) const
             -> const std::vector<int>&;
     auto groupSpheresStateIndices(int gidx) const -> const std::vector<int>&;
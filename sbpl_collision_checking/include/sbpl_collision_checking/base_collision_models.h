@@ -165,13 +165,39 @@ public: // TODO: mimic iterators from CollisionSphereTree
 
 std::ostream& operator<<(std::ostream& o, const CollisionSphereModelTree& tree);
 
+/// Maximum number of cells an oriented bounding box is split into along its
+/// longest axis when tested against a distance field
+constexpr int OBB_MAX_CELLS = 8;
+
+/// \brief Bounding volumes enclosing all leaf spheres of a spheres model
+///
+/// All quantities are expressed in the frame of the owning link. The oriented
+/// bounding box is additionally decomposed into cells along its longest axis so
+/// that it may be tested against a distance field by testing the (tight)
+/// circumscribing sphere of each cell.
+struct CollisionSpheresBound
+{
+    Eigen::Vector3d sphere_center = Eigen::Vector3d::Zero();
+    double sphere_radius = 0.0;
+
+    Eigen::Vector3d obb_center = Eigen::Vector3d::Zero();
+    Eigen::Matrix3d obb_axes = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d obb_half_extents = Eigen::Vector3d::Zero();
+
+    std::vector<Eigen::Vector3d> obb_cell_centers;
+    double obb_cell_radius = 0.0;
+};
+
 /// \brief Collision Spheres Model Specification
 struct CollisionSpheresModel
 {
     int link_index;
     CollisionSphereModelTree spheres;
+    CollisionSpheresBound bound;
 };
 
+void ComputeSpheresModelBound(CollisionSpheresModel& model);
+
 std::ostream& operator<<(std::ostream& o, const CollisionSpheresModel& csm);
 
 /// \brief Collision Voxels Model Specification
@@ -57,7 +57,9 @@
 namespace smpl {
 namespace collision {
 
-class CollisionSpace : public CollisionChecker
+class CollisionSpace :
+    public CollisionChecker,
+    public ObstacleCostExtension
 {
 public:
 
@@ -215,6 +217,16 @@ public:
         -> std::vector<visual::Marker> override;
     ///@}
 
+    /// \name Required Functions from ObstacleCostExtension
+    ///@{
+    double obstacleCost(const RobotState& state, double margin) override;
+
+    double obstacleCostGradient(
+        const RobotState& state,
+        double margin,
+        std::vector<double>& grad) override;
+    ///@}
+
 public:
 
     OccupancyGrid*                  m_grid;
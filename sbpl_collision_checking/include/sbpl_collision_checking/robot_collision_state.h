@@ -34,6 +34,7 @@
 
 // standard includes
 #include <string>
+#include <utility>
 #include <vector>
 
 // system includes
@@ -111,6 +112,10 @@ public:
     bool updateSphereStates(int ssidx);
     bool updateSphereState(const SphereIndex& sidx);
 
+    /// \brief Update and return the transform of the link that the given
+    ///        spheres state is attached to, without updating any spheres
+    auto updateSpheresStateTransform(int ssidx) -> const Eigen::Affine3d&;
+
     /// \brief Return the indices of the collision sphere states belonging to
     ///        this group
     auto groupSpheresStateIndices(const std::string& group_name) const
@@ -143,6 +148,15 @@ private:
     std::vector<bool>                       m_dirty_link_transforms;
     Affine3dVector                          m_link_transforms;
     std::vector<int>                        m_link_transform_versions;
+
+    // links in depth-first order, such that the links affected by each joint
+    // form a contiguous range [first, second) of this order
+    std::vector<int>                        m_link_order;
+    std::vector<std::pair<int, int>>        m_joint_link_ranges;
+
+    // range of the link order containing all dirty link transforms
+    int                                     m_dirty_links_begin;
+    int                                     m_dirty_links_end;
     ///@}
 
     /// \name Collision State
@@ -161,14 +175,14 @@ private:
     std::vector<CollisionVoxelsState*>      m_link_voxels_states;
     std::vector<CollisionSpheresState*>     m_link_spheres_states;
 
-    std::vector<int> m_q;
-    std::vector<int> m_ancestors;
     ///@}
 
     void initRobotState();
     void initCollisionState();
 
     bool checkCollisionStateReferences() const;
+
+    void dirtyJointLinks(int jidx);
 };
 
 typedef std::shared_ptr<RobotCollisionState> RobotCollisionStatePtr;
@@ -291,6 +305,8 @@ inline bool RobotCollisionState::setWorldToModelTransform(
         m_link_transforms[0] = M;
         std::fill(m_dirty_link_transforms.begin(), m_dirty_link_transforms.end(), true);
         m_dirty_link_transforms[0] = false;
+        m_dirty_links_begin = 0;
+        m_dirty_links_end = (int)m_link_order.size();
         ++m_link_transform_versions[0];
         std::fill(m_dirty_voxels_states.begin(), m_dirty_voxels_states.end(), true);
         return true;
@@ -367,10 +383,14 @@ inline bool RobotCollisionState::linkTransformDirty(int lidx) const
 inline bool RobotCollisionState::updateLinkTransforms()
 {
     ROS_DEBUG_NAMED(RCS_LOGGER, "Updating all link transforms");
+    // links outside the dirty range, e.g. upstream of the joints that changed
+    // since the last update, are left untouched
     bool updated = false;
-    for (size_t lidx = 0; lidx < m_model->linkCount(); ++lidx) {
-        updated |= updateLinkTransform(lidx);
+    for (int i = m_dirty_links_begin; i < m_dirty_links_end; ++i) {
+        updated |= updateLinkTransform(m_link_order[i]);
     }
+    m_dirty_links_begin = (int)m_link_order.size();
+    m_dirty_links_end = 0;
     return updated;
 }
 
@@ -556,6 +576,15 @@ inline bool RobotCollisionState::updateSphereState(const SphereIndex& sidx)
     return true;
 }
 
+inline auto RobotCollisionState::updateSpheresStateTransform(int ssidx)
+    -> const Eigen::Affine3d&
+{
+    ASSERT_VECTOR_RANGE(m_spheres_states, ssidx);
+    const int lidx = m_spheres_states[ssidx].model->link_index;
+    updateLinkTransform(lidx);
+    return m_link_transforms[lidx];
+}
+
 inline auto RobotCollisionState::groupSpheresStateIndices(
     const std::string& group_name) const
     -> const std::vector<int>&
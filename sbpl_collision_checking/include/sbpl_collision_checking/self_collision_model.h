@@ -71,6 +71,7 @@ public:
     void setAllowedCollisionMatrix(const AllowedCollisionMatrix& acm);
 
     void setPadding(double padding);
+    double padding() const;
 
     void setWorldToModelTransform(const Eigen::Affine3d& transform);
 
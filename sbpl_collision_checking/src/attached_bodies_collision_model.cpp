@@ -226,6 +226,8 @@ CollisionSpheresModel* AttachedBodiesCollisionModel::createSpheresModel(
         sphere.parent = spheres_model;
     }
 
+    ComputeSpheresModelBound(*spheres_model);
+
     return spheres_model;
 }
 
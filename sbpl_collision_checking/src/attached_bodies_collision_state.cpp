@@ -105,6 +105,16 @@ bool AttachedBodiesCollisionState::updateSphereState(
     return true;
 }
 
+auto AttachedBodiesCollisionState::updateSpheresStateTransform(int ssidx)
+    -> const Eigen::Affine3d&
+{
+    reinitCollisionState();
+    ASSERT_VECTOR_RANGE(m_spheres_states, ssidx);
+    const int bidx = m_spheres_states[ssidx].model->link_index;
+    updateAttachedBodyTransform(bidx);
+    return attachedBodyTransform(bidx);
+}
+
 void AttachedBodiesCollisionState::reinitCollisionState()
 {
     if (m_version == m_model->version()) {
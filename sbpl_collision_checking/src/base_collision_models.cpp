@@ -30,9 +30,13 @@
 /// \author Andrew Dornbush
 
 // standard includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <sstream>
 
 // system includes
+#include <Eigen/Eigenvalues>
 #include <leatherman/print.h>
 
 // project includes
@@ -674,6 +678,122 @@ std::ostream& operator<<(std::ostream& o, const CollisionSphereModelTree& tree)
     return o;
 }
 
+// Compute the extents of a set of spheres projected onto a set of axes.
+// Returns the volume of the resulting box.
+static
+double ComputeBoxExtents(
+    const std::vector<const CollisionSphereModel*>& leaves,
+    const Eigen::Matrix3d& axes,
+    Eigen::Vector3d& center,
+    Eigen::Vector3d& half_extents)
+{
+    Eigen::Vector3d lo = Eigen::Vector3d::Constant(std::numeric_limits<double>::infinity());
+    Eigen::Vector3d hi = -lo;
+    for (const CollisionSphereModel* s : leaves) {
+        const Eigen::Vector3d p = axes.transpose() * s->center;
+        lo = lo.cwiseMin(p - Eigen::Vector3d::Constant(s->radius));
+        hi = hi.cwiseMax(p + Eigen::Vector3d::Constant(s->radius));
+    }
+    center = axes * (0.5 * (lo + hi));
+    half_extents = 0.5 * (hi - lo);
+    return half_extents.prod();
+}
+
+/// Compute the bounding sphere and oriented bounding box, in the link frame, of
+/// all leaf spheres of a spheres model. The box axes are chosen as the smaller
+/// of the axis-aligned box and the box aligned with the principal axes of the
+/// leaf sphere centers.
+void ComputeSpheresModelBound(CollisionSpheresModel& model)
+{
+    CollisionSpheresBound& bound = model.bound;
+    bound = CollisionSpheresBound();
+
+    std::vector<const CollisionSphereModel*> leaves;
+    for (const CollisionSphereModel& s : model.spheres) {
+        if (s.isLeaf()) {
+            leaves.push_back(&s);
+        }
+    }
+
+    if (leaves.empty()) {
+        return;
+    }
+
+    Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+    for (const CollisionSphereModel* s : leaves) {
+        mean += s->center;
+    }
+    mean /= (double)leaves.size();
+
+    Eigen::Matrix3d cov = Eigen::Matrix3d::Zero();
+    for (const CollisionSphereModel* s : leaves) {
+        const Eigen::Vector3d d = s->center - mean;
+        cov += d * d.transpose();
+    }
+
+    // oriented bounding box
+    bound.obb_axes = Eigen::Matrix3d::Identity();
+    const double volume = ComputeBoxExtents(
+            leaves, bound.obb_axes, bound.obb_center, bound.obb_half_extents);
+
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(cov);
+    if (solver.info() == Eigen::Success) {
+        Eigen::Matrix3d axes = solver.eigenvectors();
+        if (axes.determinant() < 0.0) {
+            axes.col(2) = -axes.col(2);
+        }
+        Eigen::Vector3d center, half_extents;
+        const double pca_volume = ComputeBoxExtents(
+                leaves, axes, center, half_extents);
+        if (pca_volume < volume) {
+            bound.obb_axes = axes;
+            bound.obb_center = center;
+            bound.obb_half_extents = half_extents;
+        }
+    }
+
+    // bounding sphere, the smaller of the one centered at the box center and
+    // the root of the sphere tree
+    bound.sphere_center = bound.obb_center;
+    bound.sphere_radius = 0.0;
+    for (const CollisionSphereModel* s : leaves) {
+        const double r = (s->center - bound.sphere_center).norm() + s->radius;
+        bound.sphere_radius = std::max(bound.sphere_radius, r);
+    }
+    const CollisionSphereModel* root = model.spheres.root();
+    if (root->radius < bound.sphere_radius) {
+        bound.sphere_center = root->center;
+        bound.sphere_radius = root->radius;
+    }
+
+    // split the box into roughly cubic cells along its longest axis
+    const Eigen::Vector3d& e = bound.obb_half_extents;
+    int long_axis, short_axis;
+    e.maxCoeff(&long_axis);
+    e.minCoeff(&short_axis);
+    if (long_axis == short_axis) {
+        short_axis = (long_axis + 1) % 3;
+    }
+    const int mid_axis = 3 - long_axis - short_axis;
+
+    int cell_count = 1;
+    if (e[mid_axis] > 0.0) {
+        cell_count = (int)std::ceil(e[long_axis] / e[mid_axis]);
+        cell_count = std::max(1, std::min(cell_count, OBB_MAX_CELLS));
+    }
+
+    Eigen::Vector3d cell_half_extents = e;
+    cell_half_extents[long_axis] = e[long_axis] / cell_count;
+    bound.obb_cell_radius = cell_half_extents.norm();
+
+    const Eigen::Vector3d axis = bound.obb_axes.col(long_axis);
+    for (int i = 0; i < cell_count; ++i) {
+        const double offset =
+                -e[long_axis] + (2 * i + 1) * cell_half_extents[long_axis];
+        bound.obb_cell_centers.push_back(bound.obb_center + offset * axis);
+    }
+}
+
 std::ostream& operator<<(std::ostream& o, const CollisionSpheresModel& csm)
 {
     o << "{ link_index: " << csm.link_index << ", spheres: " << csm.spheres <<
@@ -53,6 +53,17 @@ double SphereCollisionDistance(
     const CollisionSphereState& s,
     double padding);
 
+bool CheckSphereCollisionCoarse(
+    const DistancePyramid& pyramid,
+    const CollisionSphereState& s,
+    double padding);
+
+bool CheckSpheresBoundCollision(
+    const OccupancyGrid& grid,
+    const CollisionSpheresBound& bound,
+    const Eigen::Affine3d& T_grid_link,
+    double padding);
+
 template <typename StateType>
 bool CheckVoxelsCollisions(
     StateType& state,
@@ -76,6 +87,21 @@ bool CheckSphereCollision(
     return dist >= effective_radius * effective_radius;
 }
 
+/// Check a single sphere against the coarse levels of a distance pyramid. A
+/// return value of true guarantees that the sphere is not in collision; false
+/// indicates that the sphere must be checked against the full resolution grid.
+inline
+bool CheckSphereCollisionCoarse(
+    const DistancePyramid& pyramid,
+    const CollisionSphereState& s,
+    double padding)
+{
+    const double effective_radius = s.model->radius + padding;
+    const double dist = pyramid.getDistanceLowerBound(
+            s.pos.x(), s.pos.y(), s.pos.z(), effective_radius);
+    return dist >= effective_radius;
+}
+
 /// Compute the closest distance between a sphere and an occupied voxel
 inline
 double SphereCollisionDistance(
@@ -88,13 +114,79 @@ double SphereCollisionDistance(
     return dist - effective_radius;
 }
 
+// Test a sphere, given in the grid frame, against the distance pyramid, if
+// available, and then the full resolution grid
+inline
+bool CheckBoundingSphereCollision(
+    const OccupancyGrid& grid,
+    const DistancePyramid* pyramid,
+    const Eigen::Vector3d& pos,
+    double radius)
+{
+    if (pyramid &&
+        pyramid->getDistanceLowerBound(pos.x(), pos.y(), pos.z(), radius) >= radius)
+    {
+        return true;
+    }
+    return grid.getSquaredDist(pos.x(), pos.y(), pos.z()) >= radius * radius;
+}
+
+/// Check the bounding volumes of a spheres model against an occupancy grid,
+/// using only the transform of the link the spheres are attached to. A return
+/// value of true guarantees that none of the spheres of the model are in
+/// collision; false indicates that the sphere tree must be checked.
+///
+/// The bounding sphere is tested first. If it is not clear, each cell of the
+/// oriented bounding box is tested by its circumscribing sphere, which is
+/// considerably tighter than the bounding sphere for elongated links.
+inline
+bool CheckSpheresBoundCollision(
+    const OccupancyGrid& grid,
+    const CollisionSpheresBound& bound,
+    const Eigen::Affine3d& T_grid_link,
+    double padding)
+{
+    const DistancePyramid* pyramid = grid.getDistancePyramid();
+
+    const Eigen::Vector3d center = T_grid_link * bound.sphere_center;
+    if (CheckBoundingSphereCollision(
+            grid, pyramid, center, bound.sphere_radius + padding))
+    {
+        return true;
+    }
+
+    if (bound.obb_cell_centers.empty()) {
+        return false;
+    }
+
+    const double cell_radius = bound.obb_cell_radius + padding;
+    for (const Eigen::Vector3d& cell_center : bound.obb_cell_centers) {
+        const Eigen::Vector3d pos = T_grid_link * cell_center;
+        if (!CheckBoundingSphereCollision(grid, pyramid, pos, cell_radius)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 std::vector<SphereIndex> GatherSphereIndices(
     const RobotCollisionState& state, int gidx);
 
 /// Check sphere hierarchies for collisions against an occupancy grid
 ///
-/// \param state The aggregate state of the collision trees. Must have a method
-///     updateSphereState(const SphereIndex&)
+/// Before the root sphere of a link's sphere tree is transformed, the
+/// precomputed bounding volumes of the link are tested using only the link
+/// transform. Links whose bounds are clear of obstacles are skipped without
+/// transforming or traversing any of their spheres.
+///
+/// If the occupancy grid maintains a distance pyramid, each sphere is first
+/// tested against the pyramid's coarse levels. Root and internal spheres that
+/// are not cleared by the pyramid are expanded without consulting the full
+/// resolution grid, so that only leaf spheres near obstacles touch it.
+///
+/// \param state The aggregate state of the collision trees. Must have methods
+///     updateSphereState(const SphereIndex&) and
+///     updateSpheresStateTransform(int)
 /// \param q A queue for maintaining the list of remaining spheres to check,
 ///     preseeded with the roots of all collision sphere trees to check
 /// \param grid The distance map to check spheres against
@@ -109,18 +201,41 @@ bool CheckVoxelsCollisions(
     double padding,
     double& dist)
 {
+    const DistancePyramid* pyramid = grid.getDistancePyramid();
+
     while (!q.empty()) {
         const CollisionSphereState* s = q.back();
         q.pop_back();
 
-        if (s->parent_state->index != -1) {
-            state.updateSphereState(SphereIndex(s->parent_state->index, s->index()));
+        const CollisionSpheresState* ss = s->parent_state;
+        if (ss->index != -1) {
+            if (s == ss->spheres.root()) {
+                const Eigen::Affine3d& T_grid_link =
+                        state.updateSpheresStateTransform(ss->index);
+                if (CheckSpheresBoundCollision(
+                        grid, ss->model->bound, T_grid_link, padding))
+                {
+                    ROS_DEBUG_NAMED(COP_LOGGER, "Bounds of spheres on link %d clear -> ok!", ss->model->link_index);
+                    continue; // no collision -> ok!
+                }
+            }
+            state.updateSphereState(SphereIndex(ss->index, s->index()));
         }
 
         ROS_DEBUG_NAMED(COP_LOGGER, "Checking sphere '%s' with radius %0.3f at (%0.3f, %0.3f, %0.3f)", s->model->name.c_str(), s->model->radius, s->pos.x(), s->pos.y(), s->pos.z());
 
-        double obs_dist;
-        if (CheckSphereCollision(grid, *s, padding, obs_dist)) {
+        if (pyramid && CheckSphereCollisionCoarse(*pyramid, *s, padding)) {
+            ROS_DEBUG_NAMED(COP_LOGGER, " clear at coarse level -> ok!");
+            continue; // no collision -> ok!
+        }
+
+        // with a pyramid, interior and meta-leaf spheres are expanded without
+        // consulting the full resolution grid
+        const bool check_fine =
+                !pyramid || (s->isLeaf() && s->parent_state->index != -1);
+
+        double obs_dist = 0.0;
+        if (check_fine && CheckSphereCollision(grid, *s, padding, obs_dist)) {
             ROS_DEBUG_NAMED(COP_LOGGER, " dist^2: %0.3f -> ok!", obs_dist);
             continue; // no collision -> ok!
         }
@@ -397,6 +397,9 @@ Extension* CollisionSpace::getExtension(size_t class_code)
     if (class_code == GetClassCode<CollisionChecker>()) {
         return this;
     }
+    if (class_code == GetClassCode<ObstacleCostExtension>()) {
+        return this;
+    }
     return nullptr;
 }
 
@@ -501,6 +504,168 @@ auto CollisionSpace::getCollisionModelVisualization(const RobotState& state)
     return markers;
 }
 
+// Return the obstacle penalty of a sphere whose surface is a signed distance
+// d from the nearest obstacle, as in CHOMP
+static
+double SphereObstacleCost(double d, double margin)
+{
+    if (d < 0.0) {
+        return 0.5 * margin - d;
+    } else if (d < margin) {
+        const double e = d - margin;
+        return 0.5 * e * e / margin;
+    } else {
+        return 0.0;
+    }
+}
+
+// Return the derivative of SphereObstacleCost with respect to d
+static
+double SphereObstacleCostDerivative(double d, double margin)
+{
+    if (d < 0.0) {
+        return -1.0;
+    } else if (d < margin) {
+        return (d - margin) / margin;
+    } else {
+        return 0.0;
+    }
+}
+
+// A leaf sphere within the margin of an obstacle, along with the gradient of
+// its obstacle cost with respect to its position
+struct SphereCostGradient
+{
+    SphereIndex index;
+    bool attached;
+    Eigen::Vector3d pos;
+    Eigen::Vector3d grad;
+};
+
+// Return the obstacle cost of the leaf spheres of a collision state. Distances
+// are interpolated from the distance field so that the cost varies smoothly
+// with the positions of the spheres. If \p gradients is non-null, append the
+// cost gradient of each sphere that contributes to the cost.
+template <typename StateType>
+double SpheresObstacleCost(
+    StateType& state,
+    const std::vector<int>& spheres_indices,
+    const OccupancyGrid& grid,
+    double padding,
+    double margin,
+    bool attached = false,
+    std::vector<SphereCostGradient>* gradients = NULL)
+{
+    double cost = 0.0;
+    for (int ssidx : spheres_indices) {
+        auto& spheres = state.spheresState(ssidx).spheres;
+        for (size_t sidx = 0; sidx < spheres.size(); ++sidx) {
+            auto& s = spheres[sidx];
+            if (!s.isLeaf()) {
+                continue;
+            }
+            state.updateSphereState(SphereIndex(ssidx, sidx));
+            Eigen::Vector3d dgrad;
+            const double d =
+                    grid.getInterpDistanceFromPoint(
+                            s.pos.x(), s.pos.y(), s.pos.z(), dgrad) -
+                    s.model->radius - padding;
+            cost += SphereObstacleCost(d, margin);
+
+            const double dcost = SphereObstacleCostDerivative(d, margin);
+            if (gradients != NULL && dcost != 0.0) {
+                SphereCostGradient g;
+                g.index = SphereIndex(ssidx, sidx);
+                g.attached = attached;
+                g.pos = s.pos;
+                g.grad = dcost * dgrad;
+                gradients->push_back(g);
+            }
+        }
+    }
+    return cost;
+}
+
+/// Return the CHOMP obstacle cost of the leaf spheres of the robot and its
+/// attached bodies, evaluated against the distance field of the occupancy grid
+double CollisionSpace::obstacleCost(const RobotState& state, double margin)
+{
+    updateState(state);
+
+    const double padding = m_scm->padding();
+    double cost = SpheresObstacleCost(
+            *m_rcs,
+            m_rcs->groupSpheresStateIndices(m_gidx),
+            *m_grid,
+            padding,
+            margin);
+    cost += SpheresObstacleCost(
+            *m_abcs,
+            m_abcs->groupSpheresStateIndices(m_gidx),
+            *m_grid,
+            padding,
+            margin);
+    return cost;
+}
+
+/// Return the obstacle cost of a state, as obstacleCost(), along with its
+/// gradient. The gradient of each sphere's cost with respect to its position,
+/// from the interpolated distance field, is chained through the change in the
+/// sphere's position under a small change in each joint variable.
+double CollisionSpace::obstacleCostGradient(
+    const RobotState& state,
+    double margin,
+    std::vector<double>& grad)
+{
+    updateState(state);
+
+    const double padding = m_scm->padding();
+    std::vector<SphereCostGradient> gradients;
+    double cost = SpheresObstacleCost(
+            *m_rcs,
+            m_rcs->groupSpheresStateIndices(m_gidx),
+            *m_grid,
+            padding,
+            margin,
+            false,
+            &gradients);
+    cost += SpheresObstacleCost(
+            *m_abcs,
+            m_abcs->groupSpheresStateIndices(m_gidx),
+            *m_grid,
+            padding,
+            margin,
+            true,
+            &gradients);
+
+    grad.assign(state.size(), 0.0);
+    if (gradients.empty()) {
+        return cost;
+    }
+
+    const double step = 1e-5;
+    auto q = state;
+    for (size_t vidx = 0; vidx < q.size(); ++vidx) {
+        q[vidx] = state[vidx] + step;
+        updateState(q);
+        for (auto& g : gradients) {
+            const Eigen::Vector3d* pos;
+            if (g.attached) {
+                m_abcs->updateSphereState(g.index);
+                pos = &m_abcs->sphereState(g.index).pos;
+            } else {
+                m_rcs->updateSphereState(g.index);
+                pos = &m_rcs->sphereState(g.index).pos;
+            }
+            grad[vidx] += g.grad.dot(*pos - g.pos) / step;
+        }
+        q[vidx] = state[vidx];
+    }
+
+    updateState(state);
+    return cost;
+}
+
 /// \brief Initialize the Collision Space
 /// \param urdf_string String description of the robot in URDF format
 /// \param config Collision model configuration
@@ -574,6 +574,8 @@ bool RobotCollisionModel::initCollisionModel(
             for (auto& sphere : spheres_model.spheres.m_tree) {
                 sphere.parent = &spheres_model;
             }
+
+            ComputeSpheresModelBound(spheres_model);
         }
     }
 
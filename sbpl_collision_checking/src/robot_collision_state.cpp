@@ -63,38 +63,7 @@ bool RobotCollisionState::setJointVarPosition(int vidx, double position)
         ROS_DEBUG_NAMED(RCS_LOGGER, "Setting joint position of joint %d to %0.3f", vidx, position);
 
         m_jvar_positions[vidx] = position;
-
-        const int jidx = m_model->jointVarJointIndex(vidx);
-
-        m_dirty_joint_transforms[jidx] = true;
-
-        // TODO: cache affected link transforms in a per-joint array?
-
-        std::vector<int>& q = m_q;
-        q.clear();
-        q.push_back(m_model->jointChildLinkIndex(jidx));
-        while (!q.empty()) {
-            int lidx = q.back();
-            q.pop_back();
-
-            ROS_DEBUG_NAMED(RCS_LOGGER, "Dirtying transform to link '%s'", m_model->linkName(lidx).c_str());
-
-            // dirty the transform of the affected link
-            m_dirty_link_transforms[lidx] = true;
-
-            // dirty the voxels states of any attached voxels model
-            CollisionVoxelsState* voxels_state = m_link_voxels_states[lidx];
-            if (voxels_state) {
-                int dvsidx = std::distance(m_voxels_states.data(), voxels_state);
-                m_dirty_voxels_states[dvsidx] = true;
-            }
-
-            // add child links to the queue
-            for (int cjidx : m_model->linkChildJointIndices(lidx)) {
-                q.push_back(m_model->jointChildLinkIndex(cjidx));
-            }
-        }
-
+        dirtyJointLinks(m_model->jointVarJointIndex(vidx));
         return true;
     }
     else {
@@ -104,65 +73,15 @@ bool RobotCollisionState::setJointVarPosition(int vidx, double position)
 
 bool RobotCollisionState::setJointVarPositions(const double* positions)
 {
-    std::vector<int>& ancestors = m_ancestors;
-    ancestors.clear();
+    bool updated = false;
     for (size_t vidx = 0; vidx < m_jvar_positions.size(); ++vidx) {
         if (m_jvar_positions[vidx] != positions[vidx]) {
             m_jvar_positions[vidx] = positions[vidx];
-            const int jidx = m_model->jointVarJointIndex(vidx);
-            m_dirty_joint_transforms[jidx] = true;
-            bool add = true;
-            for (int& ancestor : ancestors) {
-                if (m_model->isDescendantJoint(jidx, ancestor)) {
-                    // only keep most ancestral joints
-                    add = false;
-                    break;
-                }
-                else if (m_model->isDescendantJoint(ancestor, jidx)) {
-                    // replace the ancestor joint with this joint
-                    add = false;
-                    ancestor = jidx;
-                    break;
-                }
-            }
-            if (add) {
-                ancestors.push_back(jidx);
-            }
+            dirtyJointLinks(m_model->jointVarJointIndex(vidx));
+            updated = true;
         }
     }
-
-    if (ancestors.empty()) {
-        return false;
-    }
-
-    std::vector<int>& q = m_q;
-    q.clear();
-    for (int ancestor : ancestors) {
-        q.push_back(m_model->jointChildLinkIndex(ancestor));
-    }
-    while (!q.empty()) {
-        int lidx = q.back();
-        q.pop_back();
-
-        ROS_DEBUG_NAMED(RCS_LOGGER, "Dirtying transform to link '%s'", m_model->linkName(lidx).c_str());
-
-        // dirty the transform of the affected link
-        m_dirty_link_transforms[lidx] = true;
-
-        // dirty the voxels states of any attached voxels model
-        CollisionVoxelsState* voxels_state = m_link_voxels_states[lidx];
-        if (voxels_state) {
-            int dvsidx = std::distance(m_voxels_states.data(), voxels_state);
-            m_dirty_voxels_states[dvsidx] = true;
-        }
-
-        // add child links to the queue
-        for (int cjidx : m_model->linkChildJointIndices(lidx)) {
-            q.push_back(m_model->jointChildLinkIndex(cjidx));
-        }
-    }
-
-    return true;
+    return updated;
 }
 
 auto RobotCollisionState::getVisualization() const
@@ -254,12 +173,81 @@ void RobotCollisionState::initRobotState()
     m_dirty_link_transforms[0] = false;
     m_link_transform_versions[0] = 0;
 
+    // order links depth-first so that the subtree below each joint occupies a
+    // contiguous range
+    m_link_order.clear();
+    m_link_order.reserve(m_model->linkCount());
+    std::vector<int> link_positions(m_model->linkCount(), -1);
+    std::vector<int> q;
+    q.push_back(m_model->jointChildLinkIndex(0));
+    while (!q.empty()) {
+        int lidx = q.back();
+        q.pop_back();
+        link_positions[lidx] = (int)m_link_order.size();
+        m_link_order.push_back(lidx);
+        auto& child_joints = m_model->linkChildJointIndices(lidx);
+        for (auto it = child_joints.rbegin(); it != child_joints.rend(); ++it) {
+            q.push_back(m_model->jointChildLinkIndex(*it));
+        }
+    }
+
+    std::vector<int> subtree_sizes(m_model->linkCount(), 1);
+    for (auto it = m_link_order.rbegin(); it != m_link_order.rend(); ++it) {
+        for (int cjidx : m_model->linkChildJointIndices(*it)) {
+            subtree_sizes[*it] += subtree_sizes[m_model->jointChildLinkIndex(cjidx)];
+        }
+    }
+
+    m_joint_link_ranges.resize(m_model->jointCount());
+    for (size_t jidx = 0; jidx < m_model->jointCount(); ++jidx) {
+        int clidx = m_model->jointChildLinkIndex(jidx);
+        m_joint_link_ranges[jidx].first = link_positions[clidx];
+        m_joint_link_ranges[jidx].second =
+                link_positions[clidx] + subtree_sizes[clidx];
+    }
+
+    m_dirty_links_begin = 0;
+    m_dirty_links_end = (int)m_link_order.size();
+
     ROS_DEBUG_NAMED(RCS_LOGGER, "Robot State:");
     ROS_DEBUG_NAMED(RCS_LOGGER, "  %zu Joint Positions", m_jvar_positions.size());
     ROS_DEBUG_NAMED(RCS_LOGGER, "  %zu Dirty Link Transforms", m_dirty_link_transforms.size());
     ROS_DEBUG_NAMED(RCS_LOGGER, "  %zu Link Transforms", m_link_transforms.size());
 }
 
+// Dirty the transform of a joint and the transforms of all links, and voxels
+// states, downstream of it. A dirty link implies that its entire subtree is
+// dirty, so nothing needs to be done if the joint's child link is already
+// dirty.
+void RobotCollisionState::dirtyJointLinks(int jidx)
+{
+    m_dirty_joint_transforms[jidx] = true;
+
+    const std::pair<int, int>& range = m_joint_link_ranges[jidx];
+    if (m_dirty_link_transforms[m_link_order[range.first]]) {
+        return;
+    }
+
+    for (int i = range.first; i < range.second; ++i) {
+        int lidx = m_link_order[i];
+
+        ROS_DEBUG_NAMED(RCS_LOGGER, "Dirtying transform to link '%s'", m_model->linkName(lidx).c_str());
+
+        // dirty the transform of the affected link
+        m_dirty_link_transforms[lidx] = true;
+
+        // dirty the voxels states of any attached voxels model
+        CollisionVoxelsState* voxels_state = m_link_voxels_states[lidx];
+        if (voxels_state) {
+            int dvsidx = std::distance(m_voxels_states.data(), voxels_state);
+            m_dirty_voxels_states[dvsidx] = true;
+        }
+    }
+
+    m_dirty_links_begin = std::min(m_dirty_links_begin, range.first);
+    m_dirty_links_end = std::max(m_dirty_links_end, range.second);
+}
+
 void RobotCollisionState::initCollisionState()
 {
     // initialize sphere and spheres states
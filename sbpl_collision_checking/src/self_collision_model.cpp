@@ -197,6 +197,11 @@ void SelfCollisionModel::setPadding(double padding)
     m_padding = padding;
 }
 
+double SelfCollisionModel::padding() const
+{
+    return m_padding;
+}
+
 void SelfCollisionModel::setWorldToModelTransform(
     const Eigen::Affine3d& transform)
 {
@@ -44,6 +44,7 @@
 #include <kdl/chainiksolvervel_pinv.hpp>
 #include <kdl/jntarray.hpp>
 #include <kdl/tree.hpp>
+#include <smpl/ik/analytic_ik_solver.h>
 #include <smpl/robot_model.h>
 #include <smpl_urdf_robot_model/smpl_urdf_robot_model.h>
 #include <urdf/model.h>
@@ -73,12 +74,26 @@ public:
         const RobotState& start,
         RobotState& solution);
 
+    /// \brief Install a closed-form solver to use in place of the numerical
+    ///     solver for all inverse kinematics queries.
+    ///
+    /// The solver receives poses of the tip link in the frame of the base link
+    /// and must compute values for every (revolute) planning variable in the
+    /// chain. Its free variable, if any, is reported as the redundant variable
+    /// of this model. The model only provides the RedundantManipulatorInterface
+    /// extension while a solver is installed. Passing NULL restores the
+    /// numerical solver. Solvers may be constructed by name, e.g. from a robot
+    /// model parameter, with MakeAnalyticIKSolver().
+    bool setAnalyticIKSolver(std::unique_ptr<AnalyticIKSolver> solver);
+
+    auto analyticIKSolver() const -> AnalyticIKSolver*;
+
     void printRobotModelInformation();
 
     /// \name RedundantManipulatorInterface
     /// @{
-    const int redundantVariableCount() const override { return 0; }
-    const int redundantVariableIndex(int vidx) const override { return 0.0; }
+    const int redundantVariableCount() const override;
+    const int redundantVariableIndex(int vidx) const override;
     bool computeFastIK(
         const Eigen::Affine3d& pose,
         const RobotState& start,
@@ -123,6 +138,8 @@ public:
     std::unique_ptr<KDL::ChainIkSolverVel_pinv>         m_ik_vel_solver;
     std::unique_ptr<KDL::ChainIkSolverPos_NR_JL>        m_ik_solver;
 
+    std::unique_ptr<AnalyticIKSolver> m_analytic_ik;
+
     // ik solver settings
     int m_max_iterations;
     double m_kdl_eps;
@@ -130,6 +147,7 @@ public:
     // temporary storage
     KDL::JntArray m_jnt_pos_in;
     KDL::JntArray m_jnt_pos_out;
+    std::vector<RobotState> m_ik_solutions;
 
     // ik search configuration
     int m_free_angle;
@@ -32,6 +32,10 @@
 
 #include <sbpl_kdl_robot_model/kdl_robot_model.h>
 
+// standard includes
+#include <cmath>
+#include <limits>
+
 // system includes
 #include <eigen_conversions/eigen_kdl.h>
 #include <kdl/frames.hpp>
@@ -221,6 +225,188 @@ double GetSolverMinPosition(KDLRobotModel* model, int vidx)
     }
 }
 
+static
+double GetSolverMaxPosition(KDLRobotModel* model, int vidx)
+{
+    if (model->vprops[vidx].continuous) {
+        return M_PI;
+    } else {
+        return model->vprops[vidx].max_position;
+    }
+}
+
+static
+bool IsRevoluteVariable(KDLRobotModel* model, int vidx)
+{
+    auto* var = GetVariable(model->robot_model, model->planning_to_state_variable[vidx]);
+    return GetJointOfVariable(var)->type == urdf::JointType::Revolute;
+}
+
+// Bring a solution from the analytic solver within the limits of the model by
+// wrapping revolute joint values by multiples of 2pi. Return false if no
+// equivalent value is within limits.
+static
+bool WrapToJointLimits(KDLRobotModel* model, RobotState* q)
+{
+    for (auto i = 0; i < model->jointVariableCount(); ++i) {
+        auto& v = (*q)[i];
+        if (!std::isfinite(v)) {
+            return false;
+        }
+        if (model->vprops[i].continuous) {
+            v = smpl::angles::normalize_angle(v);
+        } else if (!IsRevoluteVariable(model, i)) {
+            if (model->vprops[i].bounded &&
+                (v < model->vprops[i].min_position ||
+                v > model->vprops[i].max_position))
+            {
+                return false;
+            }
+        } else if (model->vprops[i].bounded) {
+            if (!WrapAngleToLimits(
+                    v,
+                    model->vprops[i].min_position,
+                    model->vprops[i].max_position))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Append all solution branches within joint limits for a pose, in the planning
+// frame, with the free variable of the analytic solver fixed.
+static
+int ComputeAnalyticIK(
+    KDLRobotModel* model,
+    const Eigen::Affine3d& pose,
+    double free_value,
+    std::vector<RobotState>& solutions)
+{
+    auto* T_map_kinematics = GetLinkTransform(&model->robot_state, model->m_kinematics_link);
+    auto T_kinematics_tip = Eigen::Affine3d(T_map_kinematics->inverse() * pose);
+
+    auto prev_count = solutions.size();
+    model->m_analytic_ik->computeIKBatch(T_kinematics_tip, free_value, solutions);
+
+    // filter in place
+    auto dst = prev_count;
+    for (auto i = prev_count; i < solutions.size(); ++i) {
+        if (solutions[i].size() != model->jointVariableCount() ||
+            !WrapToJointLimits(model, &solutions[i]))
+        {
+            continue;
+        }
+        if (dst != i) {
+            solutions[dst] = std::move(solutions[i]);
+        }
+        ++dst;
+    }
+    solutions.resize(dst);
+    return (int)(dst - prev_count);
+}
+
+// Sweep the free variable outward from its value in the seed state until the
+// analytic solver finds at least one solution branch.
+static
+bool ComputeAnalyticIKSearch(
+    KDLRobotModel* model,
+    const Eigen::Affine3d& pose,
+    const RobotState& start,
+    std::vector<RobotState>& solutions)
+{
+    auto free_index = model->m_analytic_ik->freeVariableIndex();
+    if (free_index < 0) {
+        return ComputeAnalyticIK(model, pose, 0.0, solutions) > 0;
+    }
+
+    auto initial_guess = start[free_index];
+    if (model->vprops[free_index].continuous) {
+        initial_guess = smpl::angles::normalize_angle(initial_guess);
+    }
+
+    auto num_positive_increments =
+            (int)((GetSolverMaxPosition(model, free_index) - initial_guess) /
+                    model->m_search_discretization);
+    auto num_negative_increments =
+            (int)((initial_guess - GetSolverMinPosition(model, free_index)) /
+                    model->m_search_discretization);
+
+    auto start_time = smpl::clock::now();
+    auto count = 0;
+    do {
+        auto free_value = initial_guess + model->m_search_discretization * count;
+        if (ComputeAnalyticIK(model, pose, free_value, solutions) > 0) {
+            return true;
+        }
+        if (to_seconds(smpl::clock::now() - start_time) >= model->m_timeout) {
+            ROS_DEBUG("IK Timed out in %f seconds", model->m_timeout);
+            return false;
+        }
+    } while (getCount(count, num_positive_increments, -num_negative_increments));
+
+    ROS_DEBUG("No IK solution was found");
+    return false;
+}
+
+static
+auto SelectNearestSolution(
+    KDLRobotModel* model,
+    const RobotState& start,
+    const std::vector<RobotState>& solutions)
+    -> const RobotState*
+{
+    const RobotState* best = NULL;
+    auto best_dist = std::numeric_limits<double>::infinity();
+    for (auto& solution : solutions) {
+        auto dist = 0.0;
+        for (auto i = 0; i < model->jointVariableCount(); ++i) {
+            if (model->vprops[i].continuous) {
+                dist += smpl::angles::shortest_angle_dist(solution[i], start[i]);
+            } else {
+                dist += std::fabs(solution[i] - start[i]);
+            }
+        }
+        if (dist < best_dist) {
+            best_dist = dist;
+            best = &solution;
+        }
+    }
+    return best;
+}
+
+bool KDLRobotModel::setAnalyticIKSolver(std::unique_ptr<AnalyticIKSolver> solver)
+{
+    if (solver && solver->variableCount() != (int)jointVariableCount()) {
+        ROS_ERROR("Analytic IK solver computes %d variables (expected %zu)", solver->variableCount(), jointVariableCount());
+        return false;
+    }
+    m_analytic_ik = std::move(solver);
+    return true;
+}
+
+auto KDLRobotModel::analyticIKSolver() const -> AnalyticIKSolver*
+{
+    return m_analytic_ik.get();
+}
+
+const int KDLRobotModel::redundantVariableCount() const
+{
+    if (m_analytic_ik && m_analytic_ik->freeVariableIndex() >= 0) {
+        return 1;
+    }
+    return 0;
+}
+
+const int KDLRobotModel::redundantVariableIndex(int vidx) const
+{
+    if (m_analytic_ik) {
+        return m_analytic_ik->freeVariableIndex();
+    }
+    return 0;
+}
+
 bool KDLRobotModel::computeIKSearch(
     const Eigen::Affine3d& pose,
     const RobotState& start,
@@ -289,6 +475,15 @@ bool KDLRobotModel::computeIK(
         return false;
     }
 
+    if (m_analytic_ik) {
+        m_ik_solutions.clear();
+        if (!ComputeAnalyticIKSearch(this, pose, start, m_ik_solutions)) {
+            return false;
+        }
+        solution = *SelectNearestSolution(this, start, m_ik_solutions);
+        return true;
+    }
+
     return computeIKSearch(pose, start, solution);
 }
 
@@ -298,6 +493,13 @@ bool KDLRobotModel::computeIK(
     std::vector<RobotState>& solutions,
     ik_option::IkOption option)
 {
+    if (m_analytic_ik) {
+        if (option != ik_option::UNRESTRICTED) {
+            return false;
+        }
+        return ComputeAnalyticIKSearch(this, pose, start, solutions);
+    }
+
     // NOTE: only returns one solution
     RobotState solution;
     if (computeIK(pose, start, solution)) {
@@ -311,6 +513,17 @@ bool KDLRobotModel::computeFastIK(
     const RobotState& start,
     RobotState& solution)
 {
+    if (m_analytic_ik) {
+        auto free_index = m_analytic_ik->freeVariableIndex();
+        auto free_value = free_index >= 0 ? start[free_index] : 0.0;
+        m_ik_solutions.clear();
+        if (ComputeAnalyticIK(this, pose, free_value, m_ik_solutions) == 0) {
+            return false;
+        }
+        solution = *SelectNearestSolution(this, start, m_ik_solutions);
+        return true;
+    }
+
     // transform into kinematics frame and convert to kdl
     auto* T_map_kinematics = GetLinkTransform(&this->robot_state, m_kinematics_link);
     KDL::Frame frame_des;
@@ -346,6 +559,11 @@ void KDLRobotModel::printRobotModelInformation()
 auto KDLRobotModel::getExtension(size_t class_code) -> Extension*
 {
     if (class_code == GetClassCode<InverseKinematicsInterface>()) return this;
+    if (class_code == GetClassCode<RedundantManipulatorInterface>()) {
+        // only an analytic solver provides the fast ik required by the
+        // redundant manipulator interface
+        return m_analytic_ik ? this : NULL;
+    }
     return URDFRobotModel::getExtension(class_code);
 }
 
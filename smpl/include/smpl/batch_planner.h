@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2015, Benjamin Cohen, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_BATCH_PLANNER_H
+#define SMPL_BATCH_PLANNER_H
+
+// standard includes
+#include <functional>
+#include <memory>
+#include <vector>
+
+// system includes
+#include <sbpl/planners/planner.h>
+
+// project includes
+#include <smpl/types.h>
+#include <smpl/graph/goal_constraint.h>
+#include <smpl/graph/robot_planning_space.h>
+#include <smpl/heuristic/robot_heuristic.h>
+
+namespace smpl {
+
+/// \brief A single start/goal query of a planning batch
+struct PlanningQuery
+{
+    RobotState start;
+    GoalConstraint goal;
+
+    /// Time allowed to plan for this query, in seconds
+    double allowed_time = 1.0;
+};
+
+struct PlanningQueryResult
+{
+    bool solved = false;
+    std::vector<RobotState> path;
+
+    int cost = 0;
+    int expansions = 0;
+    double solution_eps = 0.0;
+
+    /// Time spent planning for this query, in seconds
+    double planning_time = 0.0;
+
+    /// Index of the worker that serviced this query
+    int worker = -1;
+};
+
+struct BatchPlanningStats
+{
+    int num_workers = 0;
+    int num_queries = 0;
+    int num_solved = 0;
+
+    /// Wall-clock time to service the batch, in seconds
+    double elapsed_time = 0.0;
+
+    /// Sum of the planning times of all queries, in seconds
+    double total_planning_time = 0.0;
+};
+
+/// \brief The planning components owned by a single batch planning worker
+///
+/// Every worker carries per-query state (the graph's state table, the
+/// heuristic's search, the search's open list, etc.) and so needs its own
+/// graph, heuristics, and search. Each worker also needs its own RobotModel
+/// and CollisionChecker when those are not safe to use concurrently.
+/// Components that remain immutable while the batch is serviced, e.g. the
+/// OccupancyGrid and the BfsWalls computed from it, should be shared between
+/// workers.
+struct BatchPlannerWorker
+{
+    /// Arbitrary state the components below refer to, e.g. a copy of the
+    /// robot model or collision checker. Released after the components below.
+    std::shared_ptr<void> context;
+
+    std::unique_ptr<RobotPlanningSpace> space;
+
+    /// Heuristics that must be notified of the start and goal of each query.
+    /// These are expected to already be inserted into the graph.
+    std::vector<std::unique_ptr<RobotHeuristic>> heuristics;
+
+    std::unique_ptr<SBPLPlanner> search;
+
+    /// Called before each query to discard the graph states created by
+    /// previous queries, e.g. ManipLattice::clearStates. The search's memory is
+    /// freed along with them. Optional, but without it the result of a query
+    /// may depend on which queries the worker that serviced it had solved
+    /// before, and so vary between runs.
+    std::function<void()> clear_states;
+};
+
+/// Construct the components for the worker with the given index. Called once
+/// per worker, sequentially, from the thread calling BatchPlanner::init().
+using BatchPlannerWorkerFactory =
+        std::function<bool(int worker, BatchPlannerWorker& components)>;
+
+/// \brief Solve many start/goal queries concurrently against a single world
+///
+/// The batch planner owns a fixed set of workers, each with an independent
+/// set of planning components, and services each batch using one thread per
+/// worker. Queries are handed out dynamically, so that workers finishing easy
+/// queries early pick up the remaining work. Workers persist across calls to
+/// solve(), so the cost of constructing the planning components is only paid
+/// once.
+///
+/// The world must not be modified while a batch is being solved.
+class BatchPlanner
+{
+public:
+
+    bool init(int num_workers, const BatchPlannerWorkerFactory& factory);
+
+    int numWorkers() const { return (int)m_workers.size(); }
+
+    /// Solve all queries in the batch. The result at index i corresponds to
+    /// the query at index i. Returns false if the planner has not been
+    /// initialized; failure to solve individual queries is reported in their
+    /// results.
+    bool solve(
+        const std::vector<PlanningQuery>& queries,
+        std::vector<PlanningQueryResult>& results,
+        BatchPlanningStats* stats = nullptr);
+
+private:
+
+    std::vector<BatchPlannerWorker> m_workers;
+};
+
+} // namespace smpl
+
+#endif
@@ -34,13 +34,81 @@
 #define SMPL_BFS3D_H
 
 #include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <queue>
 #include <thread>
 #include <tuple>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 namespace smpl {
 
+/// A bit-packed grid of wall cells for BFS_3D, surrounded by a one-cell border
+/// of walls. A wall grid may be shared by several searches over the same
+/// cells; it must not be modified while any of them is running.
+class BfsWallGrid
+{
+public:
+
+    BfsWallGrid(int width, int height, int length);
+
+    int width() const { return m_dim_x - 2; }
+    int height() const { return m_dim_y - 2; }
+    int length() const { return m_dim_z - 2; }
+
+    bool inBounds(int x, int y, int z) const;
+
+    void setWall(int x, int y, int z) { setWall(getNode(x, y, z)); }
+    void unsetWall(int x, int y, int z) { unsetWall(getNode(x, y, z)); }
+    bool isWall(int x, int y, int z) const { return isWall(getNode(x, y, z)); }
+
+    /// \name Padded Cell Index Accessors
+    ///@{
+    int getNode(int x, int y, int z) const;
+    void setWall(int node);
+    void unsetWall(int node);
+    bool isWall(int node) const;
+    ///@}
+
+    int countWalls() const;
+
+private:
+
+    int m_dim_x, m_dim_y, m_dim_z;
+    int m_dim_xy, m_dim_xyz;
+
+    std::vector<std::uint64_t> m_bits;
+};
+
+/// A 26-connected breadth-first search over a 3D grid of free and wall cells.
+///
+/// The search is run on a background thread and expands one frontier (all cells
+/// at the same distance) at a time. Large frontiers are split across a pool of
+/// worker threads; the cells of a frontier are claimed with an atomic
+/// compare-and-swap so each cell enters the queue exactly once. Distances are
+/// published as soon as a cell is discovered, so getDistance() may be called
+/// while the search is still running and will only block until the queried
+/// cell has been reached.
+///
+/// Alternatively, the search may be run lazily, with no background thread. In
+/// that mode, run() only seeds the queue, and each distance lookup continues
+/// the search from where the previous lookup left off, until the queried cell
+/// has been discovered. Since every edge has unit cost, a cell's distance is
+/// final as soon as it is discovered, so lazy lookups return the same values
+/// as a complete search while only expanding the region between the start
+/// cells and the cells actually queried. Lazy lookups modify the search state
+/// and must not be made concurrently.
+///
+/// Walls are stored in a BfsWallGrid alongside the distance grid so that a new
+/// search can be seeded without re-reading the previous distance values and so
+/// that expansion through cluttered regions touches fewer cache lines. The wall
+/// grid may be shared with other searches; setWall() modifies it for all of
+/// them, and each picks the change up on its next run(). A search may also be
+/// moved to a replacement wall grid with setWallGrid().
 class BFS_3D
 {
 public:
@@ -49,10 +117,33 @@ public:
     static const int UNDISCOVERED = 0xFFFFFFFF;
 
     BFS_3D(int length, int width, int height);
+    BFS_3D(const std::shared_ptr<BfsWallGrid>& walls);
     ~BFS_3D();
 
+    auto walls() const -> const std::shared_ptr<BfsWallGrid>& { return m_walls; }
+
+    /// \brief Search over another wall grid with the same dimensions.
+    ///
+    /// Any running search is cancelled first. Returns false, leaving the
+    /// current walls in place, if the dimensions of the wall grids differ.
+    bool setWallGrid(const std::shared_ptr<BfsWallGrid>& walls);
+
     void getDimensions(int* length, int* width, int* height);
 
+    /// \brief Set the number of threads used to expand large frontiers.
+    ///
+    /// A value <= 0 selects the number of hardware threads. Has no effect on a
+    /// search that is already running.
+    void setNumThreads(int num_threads);
+    int numThreads() const { return m_num_threads; }
+
+    /// \brief Enable or disable lazy, on-demand expansion of the search.
+    ///
+    /// Changing the mode cancels any running search. The new mode takes effect
+    /// on the next call to run().
+    void setLazyEnabled(bool enabled);
+    bool lazyEnabled() const { return m_lazy; }
+
     void setWall(int x, int y, int z);
 
     // \brief Clear cells around a given cell until freespace is encountered.
@@ -64,6 +155,9 @@ public:
     //         otherwise
     bool escapeCell(int x, int y, int z);
 
+    /// \brief Run the BFS starting from a single cell
+    ///
+    /// A search still running from a previous call is cancelled first.
     void run(int x, int y, int z);
 
     /// \brief Run the BFS starting from a variable number of cells
@@ -72,6 +166,11 @@ public:
 
     void run_components(int gx, int gy, int gz);
 
+    /// \brief Cancel a running search and wait for it to exit.
+    ///
+    /// Cells not yet reached by the search are left undiscovered.
+    void cancel();
+
     bool inBounds(int x, int y, int z) const;
 
     /// \brief Return the distance, in cells, to the nearest occupied cell.
@@ -103,12 +202,38 @@ private:
     int m_dim_x, m_dim_y, m_dim_z;
     int m_dim_xy, m_dim_xyz;
 
-    int volatile* m_distance_grid;
+    std::atomic<int>* m_distance_grid;
+    std::shared_ptr<BfsWallGrid> m_walls;
 
     int* m_queue;
-    int m_queue_head, m_queue_tail;
 
-    volatile bool m_running;
+    // also advanced by distance lookups when the search is lazy
+    mutable int m_queue_head, m_queue_tail;
+
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_cancel;
+
+    int m_num_threads;
+    bool m_lazy;
+
+    // whether the only discovered cells in the distance grid are those in
+    // the queue, which lets a lazy search be reset in time proportional to the
+    // size of the previous search
+    bool m_lazy_clean;
+
+    // state of the frontier currently being expanded, shared with the workers
+    int m_frontier_end;
+    int m_frontier_cost;
+    std::atomic<int> m_frontier_next;
+    std::atomic<int> m_frontier_tail;
+
+    // worker pool synchronization
+    std::mutex m_pool_mutex;
+    std::condition_variable m_pool_start;
+    std::condition_variable m_pool_finish;
+    int m_pool_generation;
+    int m_pool_active;
+    bool m_pool_shutdown;
 
     int m_neighbor_offsets[26];
     std::vector<bool> m_closed;
@@ -122,22 +247,23 @@ private:
     int isUndiscovered(int node) const;
     int neighbor(int node, int neighbor) const;
 
-    void search(
-        int width,
-        int planeSize,
-        int volatile* distance_grid,
-        int* queue,
-        int& queue_head,
-        int& queue_tail);
+    void resetDistances();
+    void resetLazyDistances();
+    void startSearch();
+
+    void search();
+    void expandUntilDiscovered(int node) const;
+    void expandFrontier();
+    void workerLoop();
 
     void search(
         int width,
         int planeSize,
-        int volatile* distance_grid,
+        std::atomic<int>* distance_grid,
         int* queue,
         int& queue_head,
         int& queue_tail,
-        int volatile* frontier_grid,
+        std::atomic<int>* frontier_grid,
         int* frontier_queue,
         int& frontier_queue_head,
         int& frontier_queue_tail);
@@ -152,17 +278,45 @@ inline bool BFS_3D::inBounds(int x, int y, int z) const
             x >= m_dim_x - 2 || y >= m_dim_y - 2 || z >= m_dim_z - 2);
 }
 
+inline bool BfsWallGrid::inBounds(int x, int y, int z) const
+{
+    return !(x < 0 || y < 0 || z < 0 ||
+            x >= m_dim_x - 2 || y >= m_dim_y - 2 || z >= m_dim_z - 2);
+}
+
+inline int BfsWallGrid::getNode(int x, int y, int z) const
+{
+    if (!inBounds(x, y, z)) {
+        return -1;
+    }
+
+    return (z + 1) * m_dim_xy + (y + 1) * m_dim_x + (x + 1);
+}
+
+inline void BfsWallGrid::setWall(int node)
+{
+    m_bits[node >> 6] |= (std::uint64_t(1) << (node & 63));
+}
+
+inline void BfsWallGrid::unsetWall(int node)
+{
+    m_bits[node >> 6] &= ~(std::uint64_t(1) << (node & 63));
+}
+
+inline bool BfsWallGrid::isWall(int node) const
+{
+    return (m_bits[node >> 6] >> (node & 63)) & 1;
+}
+
 template <typename InputIt>
 void BFS_3D::run(InputIt cells_begin, InputIt cells_end)
 {
-    if (m_running) {
-        return;
-    }
+    cancel();
 
-    for (int i = 0; i < m_dim_xyz; i++) {
-        if (m_distance_grid[i] != WALL) {
-            m_distance_grid[i] = UNDISCOVERED;
-        }
+    if (m_lazy) {
+        resetLazyDistances();
+    } else {
+        resetDistances();
     }
 
     m_queue_head = 0;
@@ -171,26 +325,21 @@ void BFS_3D::run(InputIt cells_begin, InputIt cells_end)
     int xyz[3];
     int ind = 0;
     int start_count = 0;
-    for (auto it = cells_begin; it != cells_end;) {
+    for (auto it = cells_begin; it != cells_end; ++it) {
+        xyz[ind++] = *it;
         if (ind == 3) {
             auto origin = getNode(xyz[0], xyz[1], xyz[2]);
-            m_queue[start_count++] = origin;
-            m_distance_grid[origin] = 0;
+            if (m_distance_grid[origin] != 0) {
+                m_queue[start_count++] = origin;
+                m_distance_grid[origin] = 0;
+            }
             ind = 0;
-        } else {
-            xyz[ind++] = *it++;
         }
     }
 
     m_queue_tail = start_count;
 
-    // fire off background thread to compute bfs
-    m_search_thread = std::thread([&]()
-    {
-        this->search(m_dim_x, m_dim_xy, m_distance_grid, m_queue, m_queue_head, m_queue_tail);
-    });
-
-    m_running = true;
+    startSearch();
 }
 
 inline int BFS_3D::getNode(int x, int y, int z) const
@@ -219,17 +368,17 @@ inline bool BFS_3D::getCoord(int node, int& x, int& y, int& z) const
 
 inline void BFS_3D::setWall(int node)
 {
-    m_distance_grid[node] = WALL;
+    m_walls->setWall(node);
 }
 
 inline void BFS_3D::unsetWall(int node)
 {
-    m_distance_grid[node] = UNDISCOVERED;
+    m_walls->unsetWall(node);
 }
 
 inline bool BFS_3D::isWall(int node) const
 {
-    return m_distance_grid[node] == WALL;
+    return m_walls->isWall(node);
 }
 
 inline int BFS_3D::isUndiscovered(int node) const
@@ -44,6 +44,9 @@
 
 namespace smpl {
 
+/// Implementations are not required to be thread-safe; callers that check
+/// states concurrently, e.g. ParallelShortcutPath, must use a distinct
+/// instance per thread.
 class CollisionChecker : public virtual Extension
 {
 public:
@@ -111,6 +114,24 @@ public:
         const RobotState& finish) = 0;
 };
 
+class ObstacleCostExtension : public virtual Extension
+{
+public:
+
+    /// Return the sum, over the collision geometry of the robot, of a penalty
+    /// that is zero for geometry further than \p margin from the nearest
+    /// obstacle, grows quadratically as the geometry approaches the obstacle,
+    /// and linearly once the geometry penetrates it.
+    virtual double obstacleCost(const RobotState& state, double margin) = 0;
+
+    /// Return the obstacle cost of a state, as obstacleCost(), and store its
+    /// gradient with respect to each joint variable in \p grad.
+    virtual double obstacleCostGradient(
+        const RobotState& state,
+        double margin,
+        std::vector<double>& grad) = 0;
+};
+
 } // namespace smpl
 
 #endif
@@ -492,6 +492,47 @@ double DistanceMap<Derived>::getCellDistance(int x, int y, int z) const
     return getDistance(x, y, z);
 }
 
+template <typename Derived>
+double DistanceMap<Derived>::getInterpMetricDistance(
+    double x, double y, double z) const
+{
+    return interpDistance(x, y, z, nullptr);
+}
+
+template <typename Derived>
+double DistanceMap<Derived>::getInterpMetricDistance(
+    double x, double y, double z,
+    Vector3& grad) const
+{
+    return interpDistance(x, y, z, &grad);
+}
+
+template <typename Derived>
+void DistanceMap<Derived>::getInterpMetricDistances(
+    const std::vector<Vector3>& points,
+    std::vector<double>& dists) const
+{
+    dists.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Vector3& p = points[i];
+        dists[i] = interpDistance(p.x(), p.y(), p.z(), nullptr);
+    }
+}
+
+template <typename Derived>
+void DistanceMap<Derived>::getInterpMetricDistances(
+    const std::vector<Vector3>& points,
+    std::vector<double>& dists,
+    std::vector<Vector3>& grads) const
+{
+    dists.resize(points.size());
+    grads.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Vector3& p = points[i];
+        dists[i] = interpDistance(p.x(), p.y(), p.z(), &grads[i]);
+    }
+}
+
 /// Return the point in world coordinates marking the center of the cell at the
 /// given effective grid coordinates.
 template <typename Derived>
@@ -790,6 +831,32 @@ void DistanceMap<Derived>::propagateBorder()
     }
 }
 
+/// Interpolate the distances of the 8 cells surrounding a point. Lookups are
+/// clamped to the layer of border cells, which are always obstacles, so that
+/// no bounds checks are required per cell.
+template <typename Derived>
+double DistanceMap<Derived>::interpDistance(
+    double x, double y, double z,
+    Vector3* grad) const
+{
+    const int max_x = (int)m_cells.xsize() - 1;
+    const int max_y = (int)m_cells.ysize() - 1;
+    const int max_z = (int)m_cells.zsize() - 1;
+    auto cell_dist = [&](int gx, int gy, int gz) {
+        gx = std::min(std::max(gx + 1, 0), max_x);
+        gy = std::min(std::max(gy + 1, 0), max_y);
+        gz = std::min(std::max(gz + 1, 0), max_z);
+        return m_sqrt_table[m_cells(gx, gy, gz).dist];
+    };
+    return InterpolateDistance(
+            cell_dist,
+            (x - m_origin_x) * m_inv_res,
+            (y - m_origin_y) * m_inv_res,
+            (z - m_origin_z) * m_inv_res,
+            m_inv_res,
+            grad);
+}
+
 template <typename Derived>
 void DistanceMap<Derived>::resetCell(Cell& c) const
 {
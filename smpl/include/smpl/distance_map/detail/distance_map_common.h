@@ -34,6 +34,7 @@
 
 // standard includes
 #include <array>
+#include <cmath>
 #include <utility>
 
 // system includes
@@ -62,6 +63,65 @@ void CreateNeighborUpdateList(
     std::array<int, NEIGHBOR_LIST_SIZE>& indices,
     std::array<std::pair<int, int>, NUM_DIRECTIONS>& ranges);
 
+/// Trilinearly interpolate the distances of the 8 cells surrounding a point.
+///
+/// \param dist Function object returning the metric distance of the cell at
+///     given integer grid coordinates
+/// \param gx Continuous grid coordinates of the point, such that integer
+///     values lie at cell centers
+/// \param inv_res Inverse of the grid resolution
+/// \param grad If non-null, receives the gradient of the interpolated distance
+///     with respect to the metric position of the point
+template <class CellDistance>
+double InterpolateDistance(
+    const CellDistance& dist,
+    double gx, double gy, double gz,
+    double inv_res,
+    Eigen::Vector3d* grad)
+{
+    const double fx = std::floor(gx);
+    const double fy = std::floor(gy);
+    const double fz = std::floor(gz);
+    const int x = (int)fx;
+    const int y = (int)fy;
+    const int z = (int)fz;
+    const double tx = gx - fx;
+    const double ty = gy - fy;
+    const double tz = gz - fz;
+
+    const double d000 = dist(x,     y,     z    );
+    const double d001 = dist(x,     y,     z + 1);
+    const double d010 = dist(x,     y + 1, z    );
+    const double d011 = dist(x,     y + 1, z + 1);
+    const double d100 = dist(x + 1, y,     z    );
+    const double d101 = dist(x + 1, y,     z + 1);
+    const double d110 = dist(x + 1, y + 1, z    );
+    const double d111 = dist(x + 1, y + 1, z + 1);
+
+    // interpolate along z, then y, then x
+    const double d00 = d000 + tz * (d001 - d000);
+    const double d01 = d010 + tz * (d011 - d010);
+    const double d10 = d100 + tz * (d101 - d100);
+    const double d11 = d110 + tz * (d111 - d110);
+
+    const double d0 = d00 + ty * (d01 - d00);
+    const double d1 = d10 + ty * (d11 - d10);
+
+    if (grad) {
+        const double dz00 = d001 - d000;
+        const double dz01 = d011 - d010;
+        const double dz10 = d101 - d100;
+        const double dz11 = d111 - d110;
+        const double dz0 = dz00 + ty * (dz01 - dz00);
+        const double dz1 = dz10 + ty * (dz11 - dz10);
+        grad->x() = inv_res * (d1 - d0);
+        grad->y() = inv_res * ((d01 - d00) + tx * ((d11 - d10) - (d01 - d00)));
+        grad->z() = inv_res * (dz0 + tx * (dz1 - dz0));
+    }
+
+    return d0 + tx * (d1 - d0);
+}
+
 struct Eigen_Vector3i_compare
 {
     bool operator()(const Eigen::Vector3i& u, const Eigen::Vector3i& v) const
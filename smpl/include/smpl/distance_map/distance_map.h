@@ -92,6 +92,18 @@ public:
     double getMetricDistance(double x, double y, double z) const override;
     double getCellDistance(int x, int y, int z) const override;
 
+    double getInterpMetricDistance(double x, double y, double z) const override;
+    double getInterpMetricDistance(
+        double x, double y, double z,
+        Vector3& grad) const override;
+    void getInterpMetricDistances(
+        const std::vector<Vector3>& points,
+        std::vector<double>& dists) const override;
+    void getInterpMetricDistances(
+        const std::vector<Vector3>& points,
+        std::vector<double>& dists,
+        std::vector<Vector3>& grads) const override;
+
     void gridToWorld(
         int x, int y, int z,
         double& world_x, double& world_y, double& world_z) const override;
@@ -190,6 +202,8 @@ private:
     void propagateBorder();
 
     void resetCell(Cell& c) const;
+
+    double interpDistance(double x, double y, double z, Vector3* grad) const;
 };
 
 } // namespace smpl
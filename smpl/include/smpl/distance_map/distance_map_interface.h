@@ -56,6 +56,15 @@ namespace smpl {
 /// is valid for the cell center but may be an approximation of the distance
 /// from another point, even within the same cell, to its nearest obstacle cell.
 /// The function getMetricDistance() may provide more accurate distances.
+///
+/// The getInterpMetricDistance() family of functions returns the distance at
+/// an arbitrary point, trilinearly interpolated from the distances of the 8
+/// cells whose centers surround it, and optionally its gradient with respect
+/// to the position of the point. Cells outside the bounding volume are treated
+/// as obstacles. The default implementations are expressed in terms of
+/// getCellDistance(); implementations are encouraged to override them with
+/// direct access to their cell storage. The batched overloads amortize the
+/// cost of virtual dispatch over many points.
 class DistanceMapInterface
 {
 public:
@@ -116,6 +125,24 @@ public:
     { double d = getCellDistance(x, y, z); return d * d; }
     ///@}
 
+    /// \name Interpolated Distance Lookups
+    ///@{
+    virtual double getInterpMetricDistance(double x, double y, double z) const;
+
+    virtual double getInterpMetricDistance(
+        double x, double y, double z,
+        Vector3& grad) const;
+
+    virtual void getInterpMetricDistances(
+        const std::vector<Vector3>& points,
+        std::vector<double>& dists) const;
+
+    virtual void getInterpMetricDistances(
+        const std::vector<Vector3>& points,
+        std::vector<double>& dists,
+        std::vector<Vector3>& grads) const;
+    ///@}
+
     /// \name Conversions Between Cell and Metric Coordinates
     ///@{
     virtual void gridToWorld(
@@ -138,6 +165,10 @@ protected:
     double m_size_y;
     double m_size_z;
     double m_res;
+
+    double interpMetricDistance(
+        double x, double y, double z,
+        Vector3* grad) const;
 };
 
 } // namespace smpl
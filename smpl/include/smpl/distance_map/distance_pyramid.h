@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_DISTANCE_PYRAMID_H
+#define SMPL_DISTANCE_PYRAMID_H
+
+// standard includes
+#include <array>
+#include <vector>
+
+// project includes
+#include <smpl/distance_map/distance_map_interface.h>
+#include <smpl/grid/grid.h>
+#include <smpl/spatial.h>
+
+namespace smpl {
+
+/// A hierarchy of coarse, conservative distance grids built on top of a
+/// DistanceMapInterface. Level l stores, for each block of 2^(l+1) cells per
+/// side of the underlying distance map, a lower bound on the distance from any
+/// point within that block to its nearest obstacle. The coarse grids are small
+/// enough to remain cache-resident and allow cheap rejection of queries that
+/// are far from obstacles before touching the full resolution grid.
+class DistancePyramid
+{
+public:
+
+    static const int NUM_LEVELS = 3;
+
+    DistancePyramid(const DistanceMapInterface* dmap);
+
+    auto distanceMap() const -> const DistanceMapInterface* { return m_dmap; }
+
+    int numLevels() const { return NUM_LEVELS; }
+    double levelResolution(int level) const;
+
+    void update();
+    void update(int min_x, int min_y, int min_z, int max_x, int max_y, int max_z);
+    void update(const std::vector<Vector3>& points);
+
+    double getDistanceLowerBound(int level, double x, double y, double z) const;
+    double getDistanceLowerBound(double x, double y, double z, double min_dist) const;
+
+private:
+
+    const DistanceMapInterface* m_dmap;
+
+    // conservative error between a cell's distance and the distance of any
+    // point within that cell
+    double m_cell_error;
+
+    std::array<Grid3<float>, NUM_LEVELS> m_levels;
+
+    void updateLevel(
+        int level,
+        int min_x, int min_y, int min_z,
+        int max_x, int max_y, int max_z);
+};
+
+/// Return a lower bound on the distance from the point (x, y, z) to its
+/// nearest obstacle, using the grid at the given level. Points outside the
+/// bounds of the underlying distance map have a distance of 0.
+inline
+double DistancePyramid::getDistanceLowerBound(
+    int level, double x, double y, double z) const
+{
+    int gx, gy, gz;
+    m_dmap->worldToGrid(x, y, z, gx, gy, gz);
+    if (!m_dmap->isCellValid(gx, gy, gz)) {
+        return 0.0;
+    }
+    const int shift = level + 1;
+    return m_levels[level](gx >> shift, gy >> shift, gz >> shift);
+}
+
+/// Search the pyramid, from coarsest to finest level, for a lower bound on the
+/// distance from (x, y, z) to its nearest obstacle that is at least
+/// \p min_dist. Returns the tightest lower bound found, which is smaller than
+/// \p min_dist if no level was able to prove the query clear.
+inline
+double DistancePyramid::getDistanceLowerBound(
+    double x, double y, double z, double min_dist) const
+{
+    int gx, gy, gz;
+    m_dmap->worldToGrid(x, y, z, gx, gy, gz);
+    if (!m_dmap->isCellValid(gx, gy, gz)) {
+        return 0.0;
+    }
+    double d = 0.0;
+    for (int l = NUM_LEVELS - 1; l >= 0; --l) {
+        const int shift = l + 1;
+        d = m_levels[l](gx >> shift, gy >> shift, gz >> shift);
+        if (d >= min_dist) {
+            break;
+        }
+    }
+    return d;
+}
+
+} // namespace smpl
+
+#endif
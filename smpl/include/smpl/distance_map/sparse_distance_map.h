@@ -115,6 +115,18 @@ public:
     double getMetricSquaredDistance(double x, double y, double z) const override;
     double getCellSquaredDistance(int x, int y, int z) const override;
 
+    double getInterpMetricDistance(double x, double y, double z) const override;
+    double getInterpMetricDistance(
+        double x, double y, double z,
+        Vector3& grad) const override;
+    void getInterpMetricDistances(
+        const std::vector<Vector3>& points,
+        std::vector<double>& dists) const override;
+    void getInterpMetricDistances(
+        const std::vector<Vector3>& points,
+        std::vector<double>& dists,
+        std::vector<Vector3>& grads) const override;
+
     void gridToWorld(
         int x, int y, int z,
         double& world_x, double& world_y, double& world_z) const override;
@@ -220,6 +232,8 @@ public:
 
     double getTrueMetricSquaredDistance(double x, double y, double z) const;
     double getInterpMetricSquaredDistance(double x, double y, double z) const;
+
+    double interpDistance(double x, double y, double z, Vector3* grad) const;
 };
 
 } // namespace smpl
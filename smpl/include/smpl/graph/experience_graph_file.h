@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_EXPERIENCE_GRAPH_FILE_H
+#define SMPL_EXPERIENCE_GRAPH_FILE_H
+
+// standard includes
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// project includes
+#include <smpl/graph/experience_graph.h>
+
+namespace smpl {
+
+/// A read-only, memory-mapped view of a binary experience graph file.
+///
+/// The file begins with a header holding the number of joint variables and
+/// the per-variable resolutions used to discretize the stored states, followed
+/// by a sequence of self-contained segments, each added by a single call to
+/// AppendExperienceGraphFile(). A segment stores, for each node, its state,
+/// its discrete coordinate, and the id of its connected component within the
+/// segment, and, for each edge, its endpoints and its range of waypoints.
+/// Node ids referenced by a segment are local to the segment.
+///
+/// Each segment carries its size and a checksum of its contents, so a segment
+/// that was only partially written, by an interrupted append, is detected and
+/// ignored along with anything after it. All values are stored in host byte
+/// order.
+class ExperienceGraphFile
+{
+public:
+
+    struct Edge
+    {
+        std::uint32_t source;
+        std::uint32_t target;
+        std::uint32_t waypoint_offset;
+        std::uint32_t waypoint_count;
+    };
+
+    /// Pointers into the mapped file. Arrays of states and coordinates are
+    /// stored row-major with one row per node or waypoint.
+    struct Segment
+    {
+        std::uint32_t node_count;
+        std::uint32_t edge_count;
+        std::uint32_t waypoint_count;
+        std::uint32_t component_count;
+        const double* states;
+        const std::int32_t* coords;
+        const std::uint32_t* components;
+        const Edge* edges;
+        const double* waypoints;
+    };
+
+    ExperienceGraphFile() = default;
+    ~ExperienceGraphFile();
+
+    ExperienceGraphFile(const ExperienceGraphFile&) = delete;
+    ExperienceGraphFile& operator=(const ExperienceGraphFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+
+    int variableCount() const { return m_variable_count; }
+    auto resolutions() const -> const std::vector<double>& { return m_resolutions; }
+
+    auto segments() const -> const std::vector<Segment>& { return m_segments; }
+
+    auto nodeCount() const -> std::size_t { return m_node_count; }
+    auto edgeCount() const -> std::size_t { return m_edge_count; }
+
+private:
+
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+
+    int m_variable_count = 0;
+    std::vector<double> m_resolutions;
+    std::vector<Segment> m_segments;
+    std::size_t m_node_count = 0;
+    std::size_t m_edge_count = 0;
+};
+
+bool IsExperienceGraphFile(const std::string& path);
+
+bool CreateExperienceGraphFile(
+    const std::string& path,
+    const std::vector<double>& resolutions);
+
+bool AppendExperienceGraphFile(
+    const std::string& path,
+    const ExperienceGraph& egraph,
+    const std::vector<std::vector<int>>& coords);
+
+} // namespace smpl
+
+#endif
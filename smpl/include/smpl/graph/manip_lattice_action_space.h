@@ -36,6 +36,7 @@
 // standard includes
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -50,6 +51,8 @@
 #include <smpl/graph/motion_primitive.h>
 #include <smpl/planning_params.h>
 #include <smpl/robot_model.h>
+#include <smpl/spatial.h>
+#include <smpl/types.h>
 
 namespace smpl {
 
@@ -88,6 +91,14 @@ public:
     void useLongAndShortPrims(bool enable);
     void ampThresh(MotionPrimitive::Type type, double thresh);
 
+    bool useJacobianTables() const;
+    double jacobianRegionSize() const;
+    double snapJointDeltaThresh() const;
+
+    void useJacobianTables(bool enable);
+    void jacobianRegionSize(double size);
+    void snapJointDeltaThresh(double thresh);
+
     /// \name Required Public Functions from ActionSpace
     ///@{
     bool apply(const RobotState& parent, std::vector<Action>& actions) override;
@@ -106,6 +117,33 @@ protected:
     bool m_use_multiple_ik_solutions        = false;
     bool m_use_long_and_short_dist_mprims   = false;
 
+    // Linearization of the end effector pose about the center of a region of
+    // joint space, with the predicted end effector displacement of each motion
+    // primitive from within the region. The rows of the jacobian are the
+    // linear and then the angular velocities of the end effector.
+    struct JacobianRegion
+    {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        RobotState center;
+        Affine3 pose;
+        Eigen::Matrix<double, 6, Eigen::Dynamic> jacobian;
+        Eigen::Matrix<double, 3, Eigen::Dynamic> displacements;
+    };
+
+    bool m_use_jacobian_tables              = false;
+    double m_jacobian_region_size           = 0.1;
+    double m_snap_joint_delta_thresh        = std::numeric_limits<double>::infinity();
+
+    hash_map<
+            RobotCoord,
+            JacobianRegion,
+            VectorHash<int>,
+            std::equal_to<RobotCoord>,
+            Eigen::aligned_allocator<std::pair<const RobotCoord, JacobianRegion>>>
+    m_jacobian_regions;
+    std::vector<std::pair<double, int>> m_mprim_order;
+
     bool applyMotionPrimitive(
         const RobotState& state,
         const MotionPrimitive& mp,
@@ -132,6 +170,18 @@ protected:
 
     auto getStartGoalDistances(const RobotState& state)
         -> std::pair<double, double>;
+
+    auto getStartGoalDistances(const Vector3& pos) -> std::pair<double, double>;
+
+    bool applyLinearized(const RobotState& parent, std::vector<Action>& actions);
+
+    auto getJacobianRegion(const RobotState& state) -> const JacobianRegion&;
+
+    bool snapPredictedFeasible(
+        const JacobianRegion& region,
+        const RobotState& state,
+        const Affine3& pose,
+        MotionPrimitive::Type type) const;
 };
 
 } // namespace smpl
@@ -80,25 +80,12 @@ public:
     Extension* getExtension(size_t class_code) override;
     ///@}
 
+    bool saveExperienceGraph(const std::string& filepath);
+
     bool prevSolFromRecall();
 
 private:
 
-    struct RobotCoordHash
-    {
-        typedef std::vector<int> argument_type;
-        typedef std::size_t result_type;
-
-        result_type operator()(const argument_type& s) const;
-    };
-
-    typedef hash_map<
-            RobotCoord,
-            std::vector<ExperienceGraph::node_id>,
-            RobotCoordHash>
-    CoordToExperienceGraphNodeMap;
-
-    CoordToExperienceGraphNodeMap m_coord_to_nodes;
     hash_map<int, ExperienceGraph::node_id> m_state_to_node;
 
     ExperienceGraph m_egraph;
@@ -111,6 +98,13 @@ private:
         ExperienceGraph::node_id s,
         std::vector<ExperienceGraph::node_id>& path);
 
+    auto insertExperienceGraphNode(
+        const RobotState& state,
+        const RobotCoord& coord)
+        -> ExperienceGraph::node_id;
+
+    bool loadExperienceGraphFile(const std::string& path);
+
     bool parseExperienceGraphFile(
         const std::string& filepath,
         std::vector<RobotState>& egraph_states) const;
@@ -32,6 +32,10 @@
 #ifndef SMPL_WORKSPACE_LATTICE_BASE_H
 #define SMPL_WORKSPACE_LATTICE_BASE_H
 
+// standard includes
+#include <cstdint>
+#include <list>
+
 // project includes
 #include <smpl/graph/robot_planning_space.h>
 #include <smpl/graph/workspace_lattice_types.h>
@@ -71,6 +75,29 @@ public:
         int Y_count;
 
         std::vector<double> free_angle_res;
+
+        // maximum number of cached inverse kinematics results; 0 disables the
+        // cache
+        int ik_cache_size = 1 << 16;
+
+        // resolution at which seed states are bucketed when looking up cached
+        // inverse kinematics results
+        double ik_cache_seed_res = 0.2;
+
+        // maximum position (meters) and orientation (radians) error allowed
+        // between a requested pose and a cached result before the result is
+        // discarded in favor of a new inverse kinematics query
+        double ik_cache_position_tolerance = 1e-3;
+        double ik_cache_orientation_tolerance = 1e-3;
+    };
+
+    struct IKCacheStats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+
+        double hitRate() const;
     };
 
     virtual bool init(
@@ -96,6 +123,16 @@ public:
     bool stateWorkspaceToRobot(
         const WorkspaceState& state, const RobotState& seed, RobotState& ostate) const;
 
+    /// \brief Return hit/miss statistics for the inverse kinematics cache.
+    auto ikCacheStats() const -> const IKCacheStats& { return m_ik_cache_stats; }
+
+    /// \brief Drop all cached inverse kinematics results and reset the cache
+    ///     statistics.
+    ///
+    /// Must be called whenever the kinematics of the robot model change, e.g.
+    /// when the robot's base moves.
+    void clearIKCache();
+
     // TODO: variants of workspace -> robot that don't restrict redundant angles
     // TODO: variants of workspace -> robot that take in a full seed state
 
@@ -108,6 +145,44 @@ public:
     void poseCoordToWorkspace(const int* gp, double* wp) const;
     void favWorkspaceToCoord(const double* wa, int* ga) const;
     void favCoordToWorkspace(const int* ga, double* wa) const;
+
+private:
+
+    // Bounded LRU cache of inverse kinematics results (including failures),
+    // keyed by the workspace coordinate of the target pose and redundant
+    // angles, followed by the bucketed seed state. Since many continuous
+    // states share a key, a cached solution is only returned if its forward
+    // kinematics reach the requested pose, and a cached failure only if it was
+    // recorded for the requested state, within the cache tolerances.
+    // Otherwise, the entry is replaced by the result of a new query.
+    struct IKCacheEntry
+    {
+        std::vector<int> key;
+        WorkspaceState state;
+        RobotState solution;
+        bool valid;
+    };
+
+    using IKCacheList = std::list<IKCacheEntry>;
+
+    size_t m_ik_cache_capacity = 0;
+    double m_ik_cache_seed_res = 0.2;
+    double m_ik_cache_pos_tol = 1e-3;
+    double m_ik_cache_rot_tol = 1e-3;
+    mutable IKCacheList m_ik_cache_lru;
+    mutable hash_map<std::vector<int>, IKCacheList::iterator, VectorHash<int>> m_ik_cache;
+    mutable IKCacheStats m_ik_cache_stats;
+
+    bool computeCachedIK(
+        const WorkspaceState& state,
+        const RobotState& seed,
+        RobotState& ostate) const;
+
+    bool cachedIKMatches(
+        const IKCacheEntry& entry,
+        const WorkspaceState& state,
+        const Affine3& pose,
+        const RobotState& seed) const;
 };
 
 } // namespace smpl
@@ -39,6 +39,7 @@
 #include <smpl/occupancy_grid.h>
 #include <smpl/bfs3d/bfs3d.h>
 #include <smpl/debug/marker.h>
+#include <smpl/heuristic/bfs_walls.h>
 #include <smpl/heuristic/robot_heuristic.h>
 
 namespace smpl {
@@ -56,6 +57,12 @@ public:
     int costPerCell() const { return m_cost_per_cell; }
     void setCostPerCell(int cost);
 
+    /// Whether the underlying searches are expanded on demand by heuristic
+    /// lookups rather than flooding the grid in the background. Takes effect
+    /// on the next goal update.
+    bool lazySearchEnabled() const { return m_lazy_search; }
+    void setLazySearchEnabled(bool enabled);
+
     auto grid() const -> const OccupancyGrid* { return m_grid; }
 
     auto getWallsVisualization() const -> visual::Marker;
@@ -88,11 +95,13 @@ private:
 
     const OccupancyGrid* m_grid = nullptr;
 
+    std::shared_ptr<BfsWalls> m_walls;
     std::unique_ptr<BFS_3D> m_bfs;
     PointProjectionExtension* m_pp = nullptr;
 
     double m_inflation_radius = 0.0;
     int m_cost_per_cell = 1;
+    bool m_lazy_search = false;
 
     struct CellCoord
     {
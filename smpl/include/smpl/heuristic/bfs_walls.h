@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_BFS_WALLS_H
+#define SMPL_BFS_WALLS_H
+
+// standard includes
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// project includes
+#include <smpl/bfs3d/bfs3d.h>
+
+namespace smpl {
+
+class OccupancyGrid;
+
+/// The cells of an OccupancyGrid within an inflation radius of an obstacle,
+/// as walls for BFS_3D.
+///
+/// Instances are shared by every heuristic built over the same grid with the
+/// same inflation radius; see Get(). The walls are refreshed by sync(), which
+/// only rescans the region of the grid modified since the previous refresh,
+/// or the entire grid if that region is no longer known.
+///
+/// The wall grid is copied on write: if any search still refers to the current
+/// wall grid, sync() applies changes to a copy and publishes the copy as the
+/// new wall grid, so searches never observe walls changing beneath them.
+class BfsWalls
+{
+public:
+
+    static auto Get(const OccupancyGrid* grid, double inflation_radius)
+        -> std::shared_ptr<BfsWalls>;
+
+    auto grid() const -> const OccupancyGrid* { return m_grid; }
+    auto gridId() const -> std::uint64_t { return m_grid_id; }
+    double inflationRadius() const { return m_inflation_radius; }
+
+    /// Return the current wall grid. The wall grid is replaced, rather than
+    /// updated, if it is in use or the dimensions of the occupancy grid change.
+    auto wallGrid() const -> std::shared_ptr<BfsWallGrid>;
+
+    void sync();
+
+private:
+
+    const OccupancyGrid* m_grid;
+    std::uint64_t m_grid_id;
+    double m_inflation_radius;
+
+    std::shared_ptr<BfsWallGrid> m_walls;
+    std::uint64_t m_version;
+    bool m_synced;
+
+    mutable std::mutex m_mutex;
+
+    BfsWalls(const OccupancyGrid* grid, double inflation_radius);
+
+    int updateWalls(
+        int min_x, int min_y, int min_z,
+        int max_x, int max_y, int max_z);
+};
+
+} // namespace smpl
+
+#endif
@@ -32,11 +32,16 @@
 #ifndef SMPL_GENERIC_EGRAPH_HEURISTIC_H
 #define SMPL_GENERIC_EGRAPH_HEURISTIC_H
 
+// standard includes
+#include <functional>
+#include <utility>
+
 // project includes
 #include <smpl/graph/experience_graph_extension.h>
 #include <smpl/heap/intrusive_heap.h>
 #include <smpl/heuristic/robot_heuristic.h>
 #include <smpl/heuristic/egraph_heuristic.h>
+#include <smpl/vp_tree/vp_tree.h>
 
 namespace smpl {
 
@@ -51,6 +56,11 @@ public:
     double weightEGraph() const { return m_eg_eps; }
     void setWeightEGraph(double w);
 
+    using StateDistanceFunction =
+            std::function<double(const RobotState&, const RobotState&)>;
+
+    void setNodeMetric(const StateDistanceFunction& dist, double cost_scale);
+
     /// \name ExperienceGraphHeuristicExtension Interface
     ///@{
     void getEquivalentStates(int state_id, std::vector<int>& ids) override;
@@ -89,10 +99,24 @@ private:
     RobotHeuristic* m_orig_h = nullptr;
 
     ExperienceGraphExtension* m_eg = nullptr;
+    ExtractRobotStateExtension* m_ers = nullptr;
 
     double m_eg_eps = 1.0;
 
+    // metric index over the states of the experience graph nodes, indexed by
+    // node id, used to avoid visiting every node on each heuristic lookup
+    StateDistanceFunction m_node_dist;
+    double m_node_cost_scale = 0.0;
+    VPTree<RobotState, StateDistanceFunction> m_node_index;
+    bool m_node_index_valid = false;
+
+    // goal-independent data, recomputed when the experience graph changes
+    bool m_preprocessed = false;
+    std::size_t m_eg_hash = 0;
+    int m_comp_count = 0;
     std::vector<int> m_component_ids;
+
+    std::vector<int> m_goal_h;
     std::vector<std::vector<ExperienceGraph::node_id>> m_shortcut_nodes;
 
     struct HeuristicNode : public heap_element
@@ -113,6 +137,11 @@ private:
 
     std::vector<HeuristicNode> m_h_nodes;
     intrusive_heap<HeuristicNode, NodeCompare> m_open;
+    std::vector<std::pair<ExperienceGraph::node_id, int>> m_relaxed;
+
+    void updatePreprocessing(const ExperienceGraph& eg);
+    void expandIndexed(const ExperienceGraph& eg, HeuristicNode* s);
+    void updateNodeOffsets();
 };
 
 } // namespace smpl
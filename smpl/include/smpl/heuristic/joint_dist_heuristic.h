@@ -41,8 +41,13 @@ class JointDistHeuristic : public RobotHeuristic
 {
 public:
 
+    /// The factor by which joint-space distances are scaled to integer costs
+    static constexpr double FIXED_POINT_RATIO = 1000.0;
+
     bool init(RobotPlanningSpace* space);
 
+    double computeJointDistance(const RobotState& s, const RobotState& t) const;
+
     /// \name Required Public Functions from RobotHeuristic
     ///@{
     double getMetricGoalDistance(double x, double y, double z) override;
@@ -63,11 +68,7 @@ public:
 
 private:
 
-    static constexpr double FIXED_POINT_RATIO = 1000.0;
-
     ExtractRobotStateExtension* m_ers = nullptr;
-
-    double computeJointDistance(const RobotState &s, const RobotState &t) const;
 };
 
 } // namespace smpl
@@ -38,6 +38,7 @@
 // project includes
 #include <smpl/occupancy_grid.h>
 #include <smpl/debug/marker.h>
+#include <smpl/heuristic/bfs_walls.h>
 #include <smpl/heuristic/robot_heuristic.h>
 #include <smpl/bfs3d/bfs3d.h>
 
@@ -58,6 +59,12 @@ public:
     int costPerCell() const { return m_cost_per_cell; }
     void setCostPerCell(int cost);
 
+    /// Whether the underlying searches are expanded on demand by heuristic
+    /// lookups rather than flooding the grid in the background. Takes effect
+    /// on the next goal update.
+    bool lazySearchEnabled() const { return m_lazy_search; }
+    void setLazySearchEnabled(bool enabled);
+
     auto grid() const -> const OccupancyGrid* { return m_grid; }
 
     auto getWallsVisualization() const -> visual::Marker;
@@ -94,6 +101,7 @@ private:
     ExtractRobotStateExtension* m_ers = nullptr;
     ForwardKinematicsInterface* m_fk_iface = nullptr;
 
+    std::shared_ptr<BfsWalls> m_walls;
     std::unique_ptr<BFS_3D> m_bfs;
     std::unique_ptr<BFS_3D> m_ee_bfs;
 
@@ -101,6 +109,7 @@ private:
 
     double m_inflation_radius = 0.0;
     int m_cost_per_cell = 1;
+    bool m_lazy_search = false;
 
     int getGoalHeuristic(int state_id, bool use_ee) const;
 
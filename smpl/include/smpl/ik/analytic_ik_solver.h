@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_ANALYTIC_IK_SOLVER_H
+#define SMPL_ANALYTIC_IK_SOLVER_H
+
+// standard includes
+#include <memory>
+#include <string>
+#include <vector>
+
+// project includes
+#include <smpl/spatial.h>
+#include <smpl/types.h>
+
+namespace smpl {
+
+/// \brief Interface to closed-form inverse kinematics solvers
+///
+/// An analytic solver enumerates every solution branch for a pose in a single
+/// call, rather than converging to the one branch nearest a seed. Solvers for
+/// redundant (7R) arms expose a single free joint variable that parameterizes
+/// the self-motion manifold; the caller fixes its value and the solver returns
+/// all branches of the remaining joints.
+///
+/// Poses are expressed as the transform of the tip link in the frame of the
+/// base link of the kinematic chain. Solutions are not checked against joint
+/// limits; that is the responsibility of the caller, which knows the limits
+/// of the robot model.
+class AnalyticIKSolver
+{
+public:
+
+    virtual ~AnalyticIKSolver();
+
+    /// \brief Return the number of joint variables in a solution.
+    virtual int variableCount() const = 0;
+
+    /// \brief Return the index of the free joint variable, or -1 if the
+    ///     solver is fully determined by the pose.
+    virtual int freeVariableIndex() const { return -1; }
+
+    /// \brief Compute all inverse kinematics solution branches for a pose.
+    ///
+    /// Solutions are appended to \p solutions. The value of the free variable,
+    /// if any, is fixed to \p free_value and ignored otherwise.
+    ///
+    /// \return The number of solutions appended
+    virtual int computeIKBatch(
+        const Affine3& pose,
+        double free_value,
+        std::vector<RobotState>& solutions) = 0;
+};
+
+/// \brief Wrap a revolute joint value by a multiple of 2pi into [min, max]
+///
+/// \return false if no equivalent value lies within the limits
+bool WrapAngleToLimits(double& angle, double min, double max);
+
+/// \brief Construct an analytic IK solver by name, e.g. from a robot model
+///     parameter
+///
+/// The only solver available is "opw", configured by a string in the format
+/// accepted by ParseOPWParameters().
+///
+/// \return NULL if the name is unknown or the parameters are malformed
+auto MakeAnalyticIKSolver(const std::string& name, const std::string& params)
+    -> std::unique_ptr<AnalyticIKSolver>;
+
+} // namespace smpl
+
+#endif
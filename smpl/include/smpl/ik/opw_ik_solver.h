@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_OPW_IK_SOLVER_H
+#define SMPL_OPW_IK_SOLVER_H
+
+// project includes
+#include <smpl/ik/analytic_ik_solver.h>
+
+namespace smpl {
+
+/// \brief Geometric parameters of a 6R arm with an ortho-parallel basis and a
+///     spherical wrist
+///
+/// This is the seven-parameter model of Brandstoetter et al., which covers most
+/// industrial arms (KUKA, ABB, Fanuc, Staubli, ...). With all joint angles
+/// zero, the arm points straight up the z axis of the base frame:
+///
+///   T = Rz(q1) * Trans(a1, b, c1) * Ry(q2) * Trans(0, 0, c2) * Ry(q3) *
+///       Trans(a2, 0, c3) * Rz(q4) * Ry(q5) * Rz(q6) * Trans(0, 0, c4)
+///
+/// Joint values of the robot model are related to the angles of the model
+/// above by q_model = (q + offset) * sign_correction.
+struct OPWParameters
+{
+    double a1 = 0.0;
+    double a2 = 0.0;
+    double b = 0.0;
+    double c1 = 0.0;
+    double c2 = 0.0;
+    double c3 = 0.0;
+    double c4 = 0.0;
+
+    double offsets[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    int sign_corrections[6] = { 1, 1, 1, 1, 1, 1 };
+};
+
+/// \brief Parse OPW parameters from a whitespace-separated list
+///
+/// The list holds the geometric parameters a1, a2, b, c1, c2, c3, and c4,
+/// optionally followed by the six joint offsets and then the six sign
+/// corrections. Omitted offsets are zero and omitted sign corrections are 1.
+bool ParseOPWParameters(const std::string& s, OPWParameters& params);
+
+/// \brief Closed-form inverse kinematics for 6R arms with an ortho-parallel
+///     basis and a spherical wrist
+///
+/// The wrist center decouples position from orientation, yielding up to eight
+/// solutions: two shoulder, two elbow, and two wrist configurations.
+/// Unreachable branches are omitted from the output.
+class OPWIKSolver : public AnalyticIKSolver
+{
+public:
+
+    OPWIKSolver() = default;
+    OPWIKSolver(const OPWParameters& params);
+
+    auto params() const -> const OPWParameters& { return m_params; }
+    void setParams(const OPWParameters& params) { m_params = params; }
+
+    /// \brief Compute the pose of the flange for a set of joint values.
+    auto computeFK(const RobotState& state) const -> Affine3;
+
+    /// \name AnalyticIKSolver Interface
+    ///@{
+    int variableCount() const override { return 6; }
+
+    int computeIKBatch(
+        const Affine3& pose,
+        double free_value,
+        std::vector<RobotState>& solutions) override;
+    ///@}
+
+private:
+
+    OPWParameters m_params;
+};
+
+} // namespace smpl
+
+#endif
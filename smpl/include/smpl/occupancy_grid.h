@@ -35,6 +35,8 @@
 
 // standard includes
 #include <algorithm>
+#include <cstdint>
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -45,6 +47,7 @@
 #include <smpl/forward.h>
 #include <smpl/debug/marker.h>
 #include <smpl/distance_map/distance_map_interface.h>
+#include <smpl/distance_map/distance_pyramid.h>
 #include <smpl/spatial.h>
 
 namespace smpl {
@@ -74,6 +77,13 @@ public:
     auto getDistanceField() const -> const std::shared_ptr<DistanceMapInterface>&
     { return m_grid; }
 
+    void setDistancePyramidEnabled(bool enabled);
+
+    /// Return the coarse distance pyramid kept in sync with the distance field,
+    /// or nullptr if it has not been enabled.
+    auto getDistancePyramid() const -> const DistancePyramid*
+    { return m_pyramid.get(); }
+
     /// \name Modifiers
     ///@{
     void addPointsToField(const std::vector<Vector3>& points);
@@ -86,6 +96,23 @@ public:
     void reset();
     ///@}
 
+    /// \name Change Tracking
+    ///@{
+
+    /// Return an identifier unique to this occupancy grid among all grids
+    /// constructed by this process. Copies receive a new identifier.
+    auto id() const -> std::uint64_t { return m_id; }
+
+    /// Return a counter that is incremented by every modification of the
+    /// distance field made through this occupancy grid.
+    auto version() const -> std::uint64_t { return m_version; }
+
+    bool getModifiedRegion(
+        std::uint64_t since_version,
+        int& min_x, int& min_y, int& min_z,
+        int& max_x, int& max_y, int& max_z) const;
+    ///@}
+
     /// \name Properties
     ///@{
     double originX() const { return m_grid->originX(); }
@@ -100,6 +127,10 @@ public:
 
     double resolution() const { return m_grid->resolution(); }
 
+    /// Return whether cells count the obstacles added to them, so that removing
+    /// an obstacle leaves cells still occupied by other obstacles intact.
+    bool refCounted() const { return m_ref_counted; }
+
     const std::string& getReferenceFrame() const;
     void setReferenceFrame(const std::string& frame);
     ///@}
@@ -130,6 +161,11 @@ public:
     double getDistanceFromPoint(double x, double y, double z) const;
     double getSquaredDist(double x, double y, double z) const;
 
+    double getInterpDistanceFromPoint(double x, double y, double z) const;
+    double getInterpDistanceFromPoint(
+        double x, double y, double z,
+        Vector3& grad) const;
+
     double getDistanceToBorder(int x, int y, int z) const;
 
     double getDistanceToBorder(double x, double y, double z) const;
@@ -159,6 +195,7 @@ public:
 private:
 
     std::shared_ptr<DistanceMapInterface> m_grid;
+    std::unique_ptr<DistancePyramid> m_pyramid;
     std::string reference_frame_;
 
     bool m_ref_counted;
@@ -166,8 +203,26 @@ private:
     int m_y_stride;
     std::vector<int> m_counts;
 
+    // bounding boxes of the cells whose distances may have changed, for each
+    // of the most recent versions
+    struct ModifiedRegion
+    {
+        std::uint64_t version;
+        int min_x, min_y, min_z;
+        int max_x, max_y, max_z;
+    };
+
+    std::uint64_t m_id = NextId();
+    std::uint64_t m_version = 0;
+    std::deque<ModifiedRegion> m_modified;
+
+    static auto NextId() -> std::uint64_t;
+
     void initRefCounts();
 
+    void recordModification(const std::vector<Vector3>& points);
+    void recordReset();
+
     int coordToIndex(int x, int y, int z) const;
 
     int getCellCount() const;
@@ -230,6 +285,25 @@ double OccupancyGrid::getSquaredDist(double x, double y, double z) const
     return m_grid->getMetricSquaredDistance(x, y, z);
 }
 
+/// Get the distance, in meters, to the nearest occupied cell, trilinearly
+/// interpolated from the surrounding cells.
+inline
+double OccupancyGrid::getInterpDistanceFromPoint(
+    double x, double y, double z) const
+{
+    return m_grid->getInterpMetricDistance(x, y, z);
+}
+
+/// Get the interpolated distance, in meters, to the nearest occupied cell and
+/// its gradient with respect to the query point.
+inline
+double OccupancyGrid::getInterpDistanceFromPoint(
+    double x, double y, double z,
+    Vector3& grad) const
+{
+    return m_grid->getInterpMetricDistance(x, y, z, grad);
+}
+
 /// Get the distance to the, in meters, to the border.
 inline
 double OccupancyGrid::getDistanceToBorder(int x, int y, int z) const
@@ -80,6 +80,12 @@ public:
     static const bool DefaultShortcutPath = false;
     static const bool DefaultInterpolatePath = false;
     static const ShortcutType DefaultShortcutType = ShortcutType::JOINT_SPACE;
+    static const int DefaultShortcutThreadCount = 1;
+    static constexpr double DefaultShortcutTimeLimit = 0.5;
+    static const bool DefaultTimeParameterizePath = false;
+    static constexpr double DefaultTimeParameterizationTimeLimit = 0.1;
+    static const bool DefaultOptimizePathClearance = false;
+    static constexpr double DefaultClearanceMargin = 0.05;
 
     // TODO: visualization parameters
 
@@ -95,11 +101,18 @@ public:
     bool shortcut_path;
     bool interpolate_path;
     ShortcutType shortcut_type;
+    int shortcut_thread_count; ///< > 1 shortcuts joint-space paths in parallel
+    double shortcut_time_limit; ///< in seconds, for parallel shortcutting
+    bool time_parameterize_path;
+    double time_parameterization_time_limit; ///< in seconds
+    bool optimize_path_clearance;
+    double clearance_margin; ///< in meters
     ///@}
 
     /// \name Logging
     ///@{
     std::string plan_output_dir;
+    std::string trace_output_dir; ///< directory to record search traces to
     ///@}
 
     void addParam(const std::string& name, bool val);
@@ -122,6 +135,20 @@ public:
 
     bool hasParam(const std::string& name) const;
 
+    /// \name Serialization
+    ///@{
+
+    /// Encode the heuristic and post-processing fields and the named
+    /// parameters as text, one "<type> <name> <value>" line each, e.g. to
+    /// record them in a search trace. Fields are named with a leading '@' to
+    /// keep them distinct from named parameters. Logging fields are omitted.
+    auto serialize() const -> std::string;
+
+    /// Restore the fields and named parameters encoded by serialize(),
+    /// replacing all named parameters. Return false if the text is malformed.
+    bool deserialize(const std::string& data);
+    ///@}
+
 private:
 
     std::unordered_map<std::string, Parameter> params;
@@ -51,6 +51,74 @@ void ShortcutPath(
     std::vector<RobotState>& pout,
     ShortcutType type);
 
+/// \brief Shortcut a joint-space path by evaluating randomized shortcut
+///     candidates in parallel
+///
+/// The path is first shortcut greedily, as by ShortcutPath with
+/// ShortcutType::JOINT_SPACE, checking several extensions of each shortcut
+/// concurrently, so the result is never costlier than the serial shortcut's.
+/// Randomized rounds then sample batches of waypoint pairs (i, j) whose direct
+/// motion would be cheaper than the path between them, check the candidates
+/// concurrently, and splice in the valid, non-overlapping candidates with the
+/// largest cost reductions. Rounds continue until the wall-clock budget is
+/// exhausted or several consecutive rounds fail to improve the path.
+///
+/// \param checkers Collision checkers, one per worker thread. Collision
+///     checkers are not required to be thread-safe, so each should be a
+///     distinct instance over the same world.
+/// \param time_budget Maximum time to spend on the randomized rounds, in
+///     seconds
+void ParallelShortcutPath(
+    RobotModel* rm,
+    const std::vector<CollisionChecker*>& checkers,
+    const std::vector<RobotState>& pin,
+    std::vector<RobotState>& pout,
+    double time_budget);
+
+struct PathClearanceParams
+{
+    /// Distance from obstacles beyond which collision geometry is not
+    /// penalized, in meters
+    double margin = 0.05;
+
+    double obstacle_weight = 1.0;
+    double smoothness_weight = 0.1;
+
+    /// Maximum joint-space distance between waypoints of the optimized path
+    double max_waypoint_step = 0.05;
+
+    /// Initial and maximum joint-space distance that any waypoint may be moved
+    /// by a single iteration
+    double max_update_step = 0.05;
+
+    int max_iterations = 100;
+
+    /// Maximum time to spend optimizing, in seconds
+    double time_limit = 0.5;
+};
+
+/// \brief Push the waypoints of a joint-space path away from obstacles
+///
+/// The path is resampled at a fixed resolution and optimized, in the manner of
+/// CHOMP, to minimize the obstacle cost provided by the collision checker's
+/// ObstacleCostExtension plus the sum of squared distances between consecutive
+/// waypoints. The endpoints of the path are fixed. Gradient steps are
+/// preconditioned by the inverse of the finite-difference smoothness metric,
+/// so that each update is smooth along the path, and are accepted only if they
+/// decrease the objective.
+///
+/// The optimized path is verified with CollisionChecker::isStateToStateValid
+/// and is only returned if every segment is valid.
+///
+/// \return true if \p path was replaced by the optimized path; false if the
+///     collision checker does not provide an ObstacleCostExtension or the
+///     optimized path is invalid, in which case \p path is unchanged
+bool OptimizePathClearance(
+    RobotModel* rm,
+    CollisionChecker* cc,
+    std::vector<RobotState>& path,
+    const PathClearanceParams& params = PathClearanceParams());
+
 bool InterpolatePath(
     CollisionChecker& cc,
     std::vector<RobotState>& path);
@@ -65,6 +133,27 @@ bool ExtractPositionPath(
     const std::vector<RobotState>& pv_path,
     std::vector<RobotState>& path);
 
+/// \brief Compute time-optimal timestamps for a joint-space path
+///
+/// The path is time-parameterized in the manner of TOPP-RA, subject to the
+/// velocity and acceleration limits of the robot model, starting and ending
+/// at rest. Joints with non-positive limits are treated as unconstrained. The
+/// path is treated as a curve through its waypoints, with path derivatives
+/// approximated by finite differences, so that the robot slows down at sharp
+/// corners.
+///
+/// \param times The time from the start of the path at which each waypoint
+///     is reached
+/// \param time_limit Maximum time to spend computing the parameterization,
+///     in seconds
+/// \return false if the parameterization could not be computed within the
+///     time limit or the path is not constrained by any velocity limit
+bool ComputeTimeOptimalParameterization(
+    RobotModel* rm,
+    const std::vector<RobotState>& path,
+    std::vector<double>& times,
+    double time_limit);
+
 bool ComputePositionPathCosts(
     RobotModel* rm,
     const std::vector<RobotState>& path,
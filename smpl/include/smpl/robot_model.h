@@ -100,6 +100,15 @@ public:
     ///
     /// \return true if forward kinematics were computed; false otherwise
     virtual Affine3 computeFK(const RobotState& state) = 0;
+
+    /// \brief Compute forward kinematics of the planning link for a batch of
+    ///     states.
+    ///
+    /// The default implementation calls computeFK for each state.
+    virtual void computeFKBatch(
+        const RobotState* states,
+        int count,
+        Affine3* poses);
 };
 
 namespace ik_option {
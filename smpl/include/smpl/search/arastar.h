@@ -43,6 +43,7 @@
 
 // project includes
 #include <smpl/heap/intrusive_heap.h>
+#include <smpl/search/search_trace.h>
 #include <smpl/time.h>
 
 namespace smpl {
@@ -134,6 +135,12 @@ public:
     void setBoundExpansions(bool bound) { m_time_params.bounded = bound; }
     bool boundExpansions() const { return m_time_params.bounded; }
 
+    /// \brief Record the events of subsequent searches to a trace.
+    ///
+    /// The trace must outlive calls to replan(). Pass NULL to stop tracing.
+    void setTrace(SearchTraceWriter* trace) { m_trace = trace; }
+    auto trace() const -> SearchTraceWriter* { return m_trace; }
+
     int replan(
         const TimeParameters &params,
         std::vector<int>* solution,
@@ -226,6 +233,8 @@ protected:
 
     double m_satisfied_eps;
 
+    SearchTraceWriter* m_trace;
+
     void convertTimeParamsToReplanParams(
         const TimeParameters& t,
         ReplanParams& r) const;
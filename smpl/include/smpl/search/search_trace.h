@@ -0,0 +1,191 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_SEARCH_TRACE_H
+#define SMPL_SEARCH_TRACE_H
+
+// standard includes
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// project includes
+#include <smpl/time.h>
+
+namespace smpl {
+
+/// \brief The kinds of records stored in a search trace
+enum class SearchTraceRecordType : std::uint8_t
+{
+    /// A named, opaque payload, such as a serialized planning request or scene
+    Blob = 1,
+    SearchBegin,
+    Iteration,
+    Expansion,
+    SearchEnd,
+};
+
+/// \brief A single record read back from a search trace
+///
+/// Only the fields relevant to the record's type are valid.
+struct SearchTraceRecord
+{
+    SearchTraceRecordType type;
+
+    /// \name Blob
+    ///@{
+    std::string name;
+    std::string data;
+    ///@}
+
+    /// \name SearchBegin
+    ///@{
+    int start_state_id;
+    int goal_state_id;
+    ///@}
+
+    /// \name Iteration
+    ///@{
+    int iteration;
+    double eps;
+    ///@}
+
+    /// \name Expansion
+    ///@{
+    int state_id;
+    unsigned int g;
+    unsigned int h;
+    unsigned int f;
+    std::vector<int> succs;
+    std::vector<int> costs;
+    ///@}
+
+    /// Time since the beginning of the search, in nanoseconds. Valid for
+    /// Iteration, Expansion, and SearchEnd records.
+    std::int64_t time;
+
+    /// \name SearchEnd
+    ///@{
+    bool solved;
+    int cost;
+    int expansions;
+    ///@}
+};
+
+/// \brief Records search events to a compact binary log
+///
+/// A trace holds any number of searches, each bracketed by SearchBegin and
+/// SearchEnd records, and any number of blobs describing the planning problem.
+/// Integers are stored as variable-length quantities and successor ids are
+/// stored relative to the expanded state, so a typical expansion occupies a
+/// few bytes per successor.
+///
+/// State ids are recorded as assigned by the planning space, which may reuse
+/// its states across queries. A trace only guarantees the ids of a search up
+/// to a one-to-one renaming; two traces of the same search agree in the g, h,
+/// and f values of each expansion and the costs of its successors.
+class SearchTraceWriter
+{
+public:
+
+    ~SearchTraceWriter();
+
+    bool open(const std::string& filename);
+    bool isOpen() const { return m_ofs.is_open(); }
+    void close();
+
+    void writeBlob(const std::string& name, const void* data, std::size_t size);
+
+    void beginSearch(int start_state_id, int goal_state_id);
+    void beginIteration(int iteration, double eps);
+
+    void expansion(
+        int state_id,
+        unsigned int g,
+        unsigned int h,
+        unsigned int f,
+        const std::vector<int>& succs,
+        const std::vector<int>& costs);
+
+    void endSearch(bool solved, int cost, int expansions);
+
+private:
+
+    std::ofstream m_ofs;
+    std::string m_buffer;
+    clock::time_point m_search_start;
+    std::int64_t m_last_time = 0;
+
+    void writeTime();
+    void flush(bool force);
+};
+
+/// \brief Reads back the records of a trace written by SearchTraceWriter
+class SearchTraceReader
+{
+public:
+
+    bool open(const std::string& filename);
+
+    /// Read the next record. Return false at the end of the trace or if the
+    /// trace is malformed; error() distinguishes the two.
+    bool read(SearchTraceRecord& record);
+
+    /// Return whether the last read failed because the trace is truncated
+    /// or malformed, rather than because the trace ended cleanly.
+    bool error() const { return m_error; }
+
+private:
+
+    std::ifstream m_ifs;
+    std::int64_t m_size = 0;
+    std::int64_t m_time = 0;
+    bool m_error = false;
+
+    bool readRecord(int type, SearchTraceRecord& record);
+};
+
+/// \brief Encode a set of named properties, e.g. describing the geometry of
+///     the occupancy grid, as a blob of "name value" lines
+///
+/// Names may not contain whitespace; values may contain anything but newlines.
+auto EncodeTraceProperties(const std::map<std::string, std::string>& props)
+    -> std::string;
+
+bool DecodeTraceProperties(
+    const std::string& data,
+    std::map<std::string, std::string>& props);
+
+} // namespace smpl
+
+#endif
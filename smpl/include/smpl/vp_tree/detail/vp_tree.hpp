@@ -0,0 +1,293 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_VP_TREE_HPP
+#define SMPL_VP_TREE_HPP
+
+#include "../vp_tree.h"
+
+// standard includes
+#include <algorithm>
+#include <utility>
+
+namespace smpl {
+
+template <class T, class Distance>
+VPTree<T, Distance>::VPTree(const Distance& dist) :
+    m_dist(dist),
+    m_items(),
+    m_nodes(),
+    m_offsets(),
+    m_item_nodes(),
+    m_parents()
+{
+}
+
+/// Build the tree over the items in [first, last), replacing any previous
+/// contents. All offsets are reset to 0.
+template <class T, class Distance>
+template <class InputIt>
+void VPTree<T, Distance>::build(InputIt first, InputIt last)
+{
+    m_items.assign(first, last);
+    m_nodes.resize(m_items.size());
+    m_offsets.assign(m_items.size(), 0.0);
+
+    std::vector<std::pair<double, int>> items(m_items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        items[i] = std::make_pair(0.0, (int)i);
+    }
+    buildSubtree(items, 0, (int)items.size());
+
+    m_item_nodes.resize(m_items.size());
+    m_parents.assign(m_nodes.size(), -1);
+    for (int n = 0; n < (int)m_nodes.size(); ++n) {
+        Node& node = m_nodes[n];
+        node.min_offset = 0.0;
+        m_item_nodes[node.item] = n;
+        if (n + 1 < node.split) {
+            m_parents[n + 1] = n;
+        }
+        if (node.split < node.end) {
+            m_parents[node.split] = n;
+        }
+    }
+}
+
+template <class T, class Distance>
+void VPTree<T, Distance>::clear()
+{
+    m_items.clear();
+    m_nodes.clear();
+    m_offsets.clear();
+    m_item_nodes.clear();
+    m_parents.clear();
+}
+
+/// Call `visit(i, d)` for each item i whose distance d to \p q is at most
+/// \p radius, in no particular order.
+template <class T, class Distance>
+template <class Visitor>
+void VPTree<T, Distance>::radiusSearch(
+    const T& q,
+    double radius,
+    Visitor&& visit) const
+{
+    if (!m_nodes.empty()) {
+        radiusSearch(0, q, radius, visit);
+    }
+}
+
+/// Set the per-item offsets used by boundedSearch(), indexed by item.
+template <class T, class Distance>
+void VPTree<T, Distance>::setOffsets(const std::vector<double>& offsets)
+{
+    m_offsets = offsets;
+    m_offsets.resize(m_items.size(), 0.0);
+    if (!m_nodes.empty()) {
+        updateMinOffset(0);
+    }
+}
+
+/// Set the offset of a single item, updating the subtree bounds of its
+/// ancestors in time proportional to the depth of the tree.
+template <class T, class Distance>
+void VPTree<T, Distance>::setOffset(size_type i, double offset)
+{
+    m_offsets[i] = offset;
+    for (int n = m_item_nodes[i]; n != -1; n = m_parents[n]) {
+        Node& node = m_nodes[n];
+        double min_offset = m_offsets[node.item];
+        if (n + 1 < node.split) {
+            min_offset = std::min(min_offset, m_nodes[n + 1].min_offset);
+        }
+        if (node.split < node.end) {
+            min_offset = std::min(min_offset, m_nodes[node.split].min_offset);
+        }
+        if (min_offset == node.min_offset) {
+            break;
+        }
+        node.min_offset = min_offset;
+    }
+}
+
+/// Search for items i for which `offset(i) + slope * d(q, i) < bound`.
+///
+/// \p visit is called as `visit(i, d)` for each such item, with d the distance
+/// from \p q to item i, and returns the (possibly reduced) bound for the rest
+/// of the search. Subtrees are visited nearest-first so that the bound shrinks
+/// quickly. Returns the final bound.
+template <class T, class Distance>
+template <class Visitor>
+double VPTree<T, Distance>::boundedSearch(
+    const T& q,
+    double slope,
+    double bound,
+    Visitor&& visit) const
+{
+    if (!m_nodes.empty()) {
+        boundedSearch(0, q, slope, 0.0, bound, visit);
+    }
+    return bound;
+}
+
+// Build the subtree over items [begin, end), storing its nodes in preorder
+// starting at begin. The first member of each pair is scratch space for
+// distances to the vantage item.
+template <class T, class Distance>
+int VPTree<T, Distance>::buildSubtree(
+    std::vector<std::pair<double, int>>& items,
+    int begin,
+    int end)
+{
+    if (begin >= end) {
+        return end;
+    }
+
+    // choose a vantage item at random and move it to the front
+    int v = begin + std::rand() % (end - begin);
+    std::swap(items[begin], items[v]);
+
+    Node& node = m_nodes[begin];
+    node.item = items[begin].second;
+    node.end = end;
+
+    const T& vantage = m_items[node.item];
+    for (int i = begin + 1; i < end; ++i) {
+        items[i].first = m_dist(vantage, m_items[items[i].second]);
+    }
+
+    // partition the remaining items about the median distance
+    int mid = begin + 1 + (end - begin - 1) / 2;
+    if (begin + 1 < end) {
+        std::nth_element(
+                items.begin() + begin + 1,
+                items.begin() + mid,
+                items.begin() + end);
+        node.radius = items[mid].first;
+    } else {
+        node.radius = 0.0;
+    }
+
+    // the inside subtree holds [begin + 1, mid], so the median item is on
+    // the inside and every outside item is at least as far as the median
+    int split = std::min(mid + 1, end);
+    node.split = split;
+    buildSubtree(items, begin + 1, split);
+    buildSubtree(items, split, end);
+    return end;
+}
+
+template <class T, class Distance>
+double VPTree<T, Distance>::updateMinOffset(int n)
+{
+    Node& node = m_nodes[n];
+    double min_offset = m_offsets[node.item];
+    if (n + 1 < node.split) {
+        min_offset = std::min(min_offset, updateMinOffset(n + 1));
+    }
+    if (node.split < node.end) {
+        min_offset = std::min(min_offset, updateMinOffset(node.split));
+    }
+    node.min_offset = min_offset;
+    return min_offset;
+}
+
+template <class T, class Distance>
+template <class Visitor>
+void VPTree<T, Distance>::radiusSearch(
+    int n,
+    const T& q,
+    double radius,
+    Visitor& visit) const
+{
+    const Node& node = m_nodes[n];
+    const double d = m_dist(q, m_items[node.item]);
+    if (d <= radius) {
+        visit(node.item, d);
+    }
+
+    // inside items lie within node.radius of the vantage item, outside items
+    // lie at least node.radius from it
+    if (n + 1 < node.split && d - radius <= node.radius) {
+        radiusSearch(n + 1, q, radius, visit);
+    }
+    if (node.split < node.end && d + radius >= node.radius) {
+        radiusSearch(node.split, q, radius, visit);
+    }
+}
+
+// \p lower is a lower bound on the distance from q to every item in the
+// subtree rooted at n.
+template <class T, class Distance>
+template <class Visitor>
+void VPTree<T, Distance>::boundedSearch(
+    int n,
+    const T& q,
+    double slope,
+    double lower,
+    double& bound,
+    Visitor& visit) const
+{
+    const Node& node = m_nodes[n];
+    if (node.min_offset + slope * lower >= bound) {
+        return;
+    }
+
+    const double d = m_dist(q, m_items[node.item]);
+    if (m_offsets[node.item] + slope * d < bound) {
+        bound = visit(node.item, d);
+    }
+
+    const bool has_inside = n + 1 < node.split;
+    const bool has_outside = node.split < node.end;
+    const double inside_lower = std::max(lower, d - node.radius);
+    const double outside_lower = std::max(lower, node.radius - d);
+    if (d <= node.radius) {
+        if (has_inside) {
+            boundedSearch(n + 1, q, slope, inside_lower, bound, visit);
+        }
+        if (has_outside) {
+            boundedSearch(node.split, q, slope, outside_lower, bound, visit);
+        }
+    } else {
+        if (has_outside) {
+            boundedSearch(node.split, q, slope, outside_lower, bound, visit);
+        }
+        if (has_inside) {
+            boundedSearch(n + 1, q, slope, inside_lower, bound, visit);
+        }
+    }
+}
+
+} // namespace smpl
+
+#endif
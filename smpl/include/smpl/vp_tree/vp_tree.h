@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#ifndef SMPL_VP_TREE_H
+#define SMPL_VP_TREE_H
+
+// standard includes
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+namespace smpl {
+
+/// A vantage-point tree over a fixed set of items in a metric space.
+///
+/// Each node of the tree selects a vantage item and partitions the remaining
+/// items of its subtree into those within the median distance to the vantage
+/// item and those beyond it. Queries use the triangle inequality to prune
+/// subtrees that cannot contain an item of interest, so \p Distance must be a
+/// metric: symmetric, non-negative, and satisfying the triangle inequality.
+///
+/// Items are referred to by their index in the sequence passed to build().
+///
+/// Besides radius queries, the tree supports branch-and-bound searches for
+/// the item minimizing a cost bounded below by `offset(i) + slope * d(q, i)`,
+/// where the per-item offsets are set separately from the tree structure, via
+/// setOffsets() or setOffset(), so they may change without rebuilding the tree.
+template <class T, class Distance>
+class VPTree
+{
+public:
+
+    using value_type    = T;
+    using size_type     = std::size_t;
+
+    explicit VPTree(const Distance& dist = Distance());
+
+    template <class InputIt>
+    void build(InputIt first, InputIt last);
+
+    void clear();
+
+    auto size() const -> size_type { return m_items.size(); }
+    bool empty() const { return m_items.empty(); }
+
+    auto item(size_type i) const -> const T& { return m_items[i]; }
+    auto distance() const -> const Distance& { return m_dist; }
+
+    template <class Visitor>
+    void radiusSearch(const T& q, double radius, Visitor&& visit) const;
+
+    void setOffsets(const std::vector<double>& offsets);
+    void setOffset(size_type i, double offset);
+    auto offset(size_type i) const -> double { return m_offsets[i]; }
+
+    template <class Visitor>
+    double boundedSearch(
+        const T& q,
+        double slope,
+        double bound,
+        Visitor&& visit) const;
+
+private:
+
+    // Nodes are stored in preorder. The subtree rooted at node i occupies
+    // [i, end), its inside subtree [i + 1, split), and its outside subtree
+    // [split, end).
+    struct Node
+    {
+        int item;
+        int split;
+        int end;
+        double radius;
+        double min_offset;
+    };
+
+    Distance m_dist;
+    std::vector<T> m_items;
+    std::vector<Node> m_nodes;
+    std::vector<double> m_offsets;
+
+    // node storing each item and the parent of each node, used to propagate
+    // single offset updates toward the root
+    std::vector<int> m_item_nodes;
+    std::vector<int> m_parents;
+
+    int buildSubtree(
+        std::vector<std::pair<double, int>>& items,
+        int begin,
+        int end);
+
+    double updateMinOffset(int n);
+
+    template <class Visitor>
+    void radiusSearch(
+        int n,
+        const T& q,
+        double radius,
+        Visitor& visit) const;
+
+    template <class Visitor>
+    void boundedSearch(
+        int n,
+        const T& q,
+        double slope,
+        double lower,
+        double& bound,
+        Visitor& visit) const;
+};
+
+} // namespace smpl
+
+#include "detail/vp_tree.hpp"
+
+#endif
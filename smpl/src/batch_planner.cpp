@@ -0,0 +1,213 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2015, Benjamin Cohen, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/batch_planner.h>
+
+// standard includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// project includes
+#include <smpl/time.h>
+#include <smpl/console/console.h>
+
+namespace smpl {
+
+static const char* LOG = "batch";
+
+// Solve a single query using a worker's planning components. Mirrors the
+// start/goal/plan sequence of PlannerInterface.
+static
+void SolveQuery(
+    BatchPlannerWorker& worker,
+    const PlanningQuery& query,
+    PlanningQueryResult& result)
+{
+    auto then = clock::now();
+
+    auto finish = [&]()
+    {
+        result.planning_time = to_seconds(clock::now() - then);
+    };
+
+    // discard the graph states of previous queries, along with the search
+    // states that refer to them
+    if (worker.clear_states) {
+        worker.clear_states();
+        worker.search->force_planning_from_scratch_and_free_memory();
+    }
+
+    if (!worker.space->setGoal(query.goal)) {
+        SMPL_WARN_NAMED(LOG, "Failed to set goal");
+        return finish();
+    }
+
+    for (auto& h : worker.heuristics) {
+        h->updateGoal(query.goal);
+    }
+
+    auto goal_id = worker.space->getGoalStateID();
+    if (goal_id == -1 || worker.search->set_goal(goal_id) == 0) {
+        SMPL_WARN_NAMED(LOG, "Failed to set planner goal state");
+        return finish();
+    }
+
+    if (!worker.space->setStart(query.start)) {
+        SMPL_WARN_NAMED(LOG, "Failed to set start state");
+        return finish();
+    }
+
+    auto start_id = worker.space->getStartStateID();
+    if (start_id == -1) {
+        SMPL_WARN_NAMED(LOG, "No start state has been set");
+        return finish();
+    }
+
+    for (auto& h : worker.heuristics) {
+        h->updateStart(query.start);
+    }
+
+    if (worker.search->set_start(start_id) == 0) {
+        SMPL_WARN_NAMED(LOG, "Failed to set planner start state");
+        return finish();
+    }
+
+    worker.search->force_planning_from_scratch();
+
+    std::vector<int> solution_state_ids;
+    auto solved = worker.search->replan(
+            query.allowed_time, &solution_state_ids, &result.cost);
+
+    result.expansions = worker.search->get_n_expands();
+    result.solution_eps = worker.search->get_solution_eps();
+
+    if (solved && !solution_state_ids.empty()) {
+        result.solved = worker.space->extractPath(
+                solution_state_ids, result.path);
+        if (!result.solved) {
+            SMPL_WARN_NAMED(LOG, "Failed to convert state id path to joint variable path");
+        }
+    }
+
+    finish();
+}
+
+bool BatchPlanner::init(
+    int num_workers,
+    const BatchPlannerWorkerFactory& factory)
+{
+    if (num_workers < 1) {
+        SMPL_ERROR_NAMED(LOG, "Batch planner requires at least one worker");
+        return false;
+    }
+
+    std::vector<BatchPlannerWorker> workers(num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+        if (!factory(i, workers[i])) {
+            SMPL_ERROR_NAMED(LOG, "Failed to construct batch planning worker %d", i);
+            return false;
+        }
+        if (!workers[i].space || !workers[i].search) {
+            SMPL_ERROR_NAMED(LOG, "Batch planning worker %d is missing a graph or search", i);
+            return false;
+        }
+    }
+
+    m_workers = std::move(workers);
+    return true;
+}
+
+bool BatchPlanner::solve(
+    const std::vector<PlanningQuery>& queries,
+    std::vector<PlanningQueryResult>& results,
+    BatchPlanningStats* stats)
+{
+    if (m_workers.empty()) {
+        SMPL_ERROR_NAMED(LOG, "Batch planner is not initialized");
+        return false;
+    }
+
+    auto then = clock::now();
+
+    results.assign(queries.size(), PlanningQueryResult());
+
+    // queries are claimed one at a time, since their difficulty, and so their
+    // planning time, varies widely
+    std::atomic<size_t> next_query(0);
+    auto work = [&](int wi)
+    {
+        auto& worker = m_workers[wi];
+        for (auto qi = next_query++; qi < queries.size(); qi = next_query++) {
+            results[qi].worker = wi;
+            SolveQuery(worker, queries[qi], results[qi]);
+        }
+    };
+
+    auto num_threads = std::min(m_workers.size(), queries.size());
+    if (num_threads > 0) {
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads - 1);
+        for (size_t i = 1; i < num_threads; ++i) {
+            threads.emplace_back(work, (int)i);
+        }
+        work(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    auto elapsed = to_seconds(clock::now() - then);
+
+    auto num_solved = 0;
+    auto total_planning_time = 0.0;
+    for (auto& result : results) {
+        if (result.solved) {
+            ++num_solved;
+        }
+        total_planning_time += result.planning_time;
+    }
+
+    SMPL_INFO_NAMED(LOG, "Solved %d/%zu queries in %0.3f seconds using %zu workers (%0.3f seconds of planning)", num_solved, queries.size(), elapsed, num_threads, total_planning_time);
+
+    if (stats != nullptr) {
+        stats->num_workers = (int)num_threads;
+        stats->num_queries = (int)queries.size();
+        stats->num_solved = num_solved;
+        stats->elapsed_time = elapsed;
+        stats->total_planning_time = total_planning_time;
+    }
+
+    return true;
+}
+
+} // namespace smpl
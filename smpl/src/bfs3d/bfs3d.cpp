@@ -32,24 +32,112 @@
 
 #include <smpl/bfs3d/bfs3d.h>
 
+// standard includes
+#include <algorithm>
+
 #include <smpl/console/console.h>
 
 namespace smpl {
 
+// number of frontier cells claimed by a thread at a time
+static const int FRONTIER_BLOCK_SIZE = 128;
+
+// frontiers smaller than this are expanded by the search thread alone, since
+// waking the worker pool would cost more than the expansion itself
+static const int MIN_PARALLEL_FRONTIER_SIZE = 4096;
+
+BfsWallGrid::BfsWallGrid(int width, int height, int length) :
+    m_dim_x(),
+    m_dim_y(),
+    m_dim_z(),
+    m_dim_xy(),
+    m_dim_xyz(),
+    m_bits()
+{
+    if (width <= 0 || height <= 0 || length <= 0) {
+        return;
+    }
+
+    m_dim_x = width + 2;
+    m_dim_y = height + 2;
+    m_dim_z = length + 2;
+
+    m_dim_xy = m_dim_x * m_dim_y;
+    m_dim_xyz = m_dim_xy * m_dim_z;
+
+    m_bits.assign((m_dim_xyz + 63) / 64, 0);
+
+    // surround the grid with walls
+    for (int z = 0; z < m_dim_z; ++z) {
+    for (int y = 0; y < m_dim_y; ++y) {
+    for (int x = 0; x < m_dim_x; ++x) {
+        if (x == 0 || x == m_dim_x - 1 ||
+            y == 0 || y == m_dim_y - 1 ||
+            z == 0 || z == m_dim_z - 1)
+        {
+            setWall(z * m_dim_xy + y * m_dim_x + x);
+        }
+    }
+    }
+    }
+}
+
+int BfsWallGrid::countWalls() const
+{
+    int count = 0;
+    for (int z = 0; z < length(); ++z) {
+    for (int y = 0; y < height(); ++y) {
+    for (int x = 0; x < width(); ++x) {
+        if (isWall(x, y, z)) {
+            ++count;
+        }
+    }
+    }
+    }
+    return count;
+}
+
 BFS_3D::BFS_3D(int width, int height, int length) :
+    BFS_3D(std::make_shared<BfsWallGrid>(width, height, length))
+{
+}
+
+/// Construct a search over the cells of an existing, possibly shared, wall
+/// grid.
+BFS_3D::BFS_3D(const std::shared_ptr<BfsWallGrid>& walls) :
     m_search_thread(),
     m_dim_x(),
     m_dim_y(),
     m_dim_z(),
     m_distance_grid(nullptr),
+    m_walls(walls),
     m_queue(nullptr),
     m_queue_head(),
     m_queue_tail(),
     m_running(false),
+    m_cancel(false),
+    m_num_threads(1),
+    m_lazy(false),
+    m_lazy_clean(false),
+    m_frontier_end(0),
+    m_frontier_cost(0),
+    m_frontier_next(0),
+    m_frontier_tail(0),
+    m_pool_mutex(),
+    m_pool_start(),
+    m_pool_finish(),
+    m_pool_generation(0),
+    m_pool_active(0),
+    m_pool_shutdown(false),
     m_neighbor_offsets(),
     m_closed(),
     m_distances()
 {
+    setNumThreads(0);
+
+    const int width = walls->width();
+    const int height = walls->height();
+    const int length = walls->length();
     if (width <= 0 || height <= 0 || length <= 0) {
         return;
     }
@@ -88,32 +176,17 @@ BFS_3D::BFS_3D(int width, int height, int length) :
     m_neighbor_offsets[24] = m_dim_x+1-m_dim_xy;
     m_neighbor_offsets[25] = m_dim_x-1-m_dim_xy;
 
-    m_distance_grid = new int[m_dim_xyz];
+    m_distance_grid = new std::atomic<int>[m_dim_xyz];
     m_queue = new int[width * height * length];
 
-    for (int node = 0; node < m_dim_xyz; node++) {
-        int x = node % m_dim_x;
-        int y = node / m_dim_x % m_dim_y;
-        int z = node / m_dim_xy;
-        if (x == 0 || x == m_dim_x - 1 ||
-            y == 0 || y == m_dim_y - 1 ||
-            z == 0 || z == m_dim_z - 1)
-        {
-            m_distance_grid[node] = WALL;
-        }
-        else {
-            m_distance_grid[node] = UNDISCOVERED;
-        }
-    }
+    resetDistances();
 
     m_running = false;
 }
 
 BFS_3D::~BFS_3D()
 {
-    if (m_search_thread.joinable()) {
-        m_search_thread.join();
-    }
+    cancel();
 
     if (m_distance_grid) {
         delete[] m_distance_grid;
@@ -123,6 +196,20 @@ BFS_3D::~BFS_3D()
     }
 }
 
+bool BFS_3D::setWallGrid(const std::shared_ptr<BfsWallGrid>& walls)
+{
+    if (walls->width() != m_walls->width() ||
+        walls->height() != m_walls->height() ||
+        walls->length() != m_walls->length())
+    {
+        return false;
+    }
+
+    cancel();
+    m_walls = walls;
+    return true;
+}
+
 void BFS_3D::getDimensions(int* width, int* height, int* length)
 {
     *width = m_dim_x - 2;
@@ -130,6 +217,23 @@ void BFS_3D::getDimensions(int* width, int* height, int* length)
     *length = m_dim_z - 2;
 }
 
+void BFS_3D::setLazyEnabled(bool enabled)
+{
+    if (enabled != m_lazy) {
+        cancel();
+        m_lazy = enabled;
+        m_lazy_clean = false;
+    }
+}
+
+void BFS_3D::setNumThreads(int num_threads)
+{
+    if (num_threads <= 0) {
+        num_threads = (int)std::thread::hardware_concurrency();
+    }
+    m_num_threads = std::max(1, num_threads);
+}
+
 void BFS_3D::setWall(int x, int y, int z)
 {
     if (m_running) {
@@ -138,32 +242,36 @@ void BFS_3D::setWall(int x, int y, int z)
     }
 
     int node = getNode(x, y, z);
-    m_distance_grid[node] = WALL;
+    setWall(node);
 }
 
 bool BFS_3D::isWall(int x, int y, int z) const
 {
     int node = getNode(x, y, z);
-    return m_distance_grid[node] == WALL;
+    return isWall(node);
 }
 
 bool BFS_3D::isUndiscovered(int x, int y, int z) const
 {
     int node = getNode(x, y, z);
+    if (m_lazy) {
+        if (isWall(node)) {
+            return false;
+        }
+        expandUntilDiscovered(node);
+    }
     while (m_running && m_distance_grid[node] < 0);
     return m_distance_grid[node] == UNDISCOVERED;
 }
 
 void BFS_3D::run(int x, int y, int z)
 {
-    if (m_running) {
-        return;
-    }
+    cancel();
 
-    for (int i = 0; i < m_dim_xyz; i++) {
-        if (m_distance_grid[i] != WALL) {
-            m_distance_grid[i] = UNDISCOVERED;
-        }
+    if (m_lazy) {
+        resetLazyDistances();
+    } else {
+        resetDistances();
     }
 
     // get index of start coordinate
@@ -177,22 +285,71 @@ void BFS_3D::run(int x, int y, int z)
     // initialize starting distance
     m_distance_grid[origin] = 0;
 
-    // fire off background thread to compute bfs
-    m_search_thread = std::thread([&]()
-    {
-        this->search(m_dim_x, m_dim_xy, m_distance_grid, m_queue, m_queue_head, m_queue_tail);
-    });
-
-    m_running = true;
+    startSearch();
 }
 
-void BFS_3D::run_components(int gx, int gy, int gz)
+// Reinitialize the distance grid from the wall grid.
+void BFS_3D::resetDistances()
 {
     for (int i = 0; i < m_dim_xyz; i++) {
-        if (m_distance_grid[i] != WALL) {
-            m_distance_grid[i] = UNDISCOVERED;
+        m_distance_grid[i].store(
+                isWall(i) ? WALL : UNDISCOVERED, std::memory_order_relaxed);
+    }
+    m_lazy_clean = false;
+}
+
+// Reinitialize the distance grid for a lazy search. Lazy searches only consult
+// the wall grid, so walls are not marked in the distance grid, and only the
+// cells discovered by the previous lazy search need to be cleared.
+void BFS_3D::resetLazyDistances()
+{
+    if (m_lazy_clean) {
+        for (int i = 0; i < m_queue_tail; ++i) {
+            m_distance_grid[m_queue[i]].store(
+                    UNDISCOVERED, std::memory_order_relaxed);
+        }
+    } else {
+        for (int i = 0; i < m_dim_xyz; ++i) {
+            m_distance_grid[i].store(UNDISCOVERED, std::memory_order_relaxed);
         }
     }
+    m_queue_head = 0;
+    m_queue_tail = 0;
+    m_lazy_clean = true;
+}
+
+void BFS_3D::cancel()
+{
+    if (m_search_thread.joinable()) {
+        m_cancel = true;
+        m_search_thread.join();
+        m_cancel = false;
+    }
+    m_running = false;
+}
+
+// Fire off the background thread to compute the bfs from the seeded queue. The
+// running flag is raised before the thread starts so that a search that
+// finishes immediately cannot be reported as still running. A lazy search is
+// left seeded for expansion by distance lookups.
+void BFS_3D::startSearch()
+{
+    if (m_lazy) {
+        return;
+    }
+
+    m_running = true;
+    m_search_thread = std::thread([this]()
+    {
+        this->search();
+    });
+}
+
+void BFS_3D::run_components(int gx, int gy, int gz)
+{
+    cancel();
+
+    resetDistances();
 
     // invert walls and free cells in an auxiliary bfs
     int length, width, height;
@@ -209,22 +366,18 @@ void BFS_3D::run_components(int gx, int gy, int gz)
     }
 
     // initialize the distance grid of the wall bfs
-    for (int i = 0; i < m_dim_xyz; ++i) {
-        if (wall_bfs.m_distance_grid[i] != WALL) {
-            wall_bfs.m_distance_grid[i] = UNDISCOVERED;
-        }
-    }
+    wall_bfs.resetDistances();
 
     // initialize the distance grid queue
     wall_bfs.m_queue_head = 0;
     wall_bfs.m_queue_tail = 1;
 
-    int volatile* curr_distance_grid = m_distance_grid;
+    std::atomic<int>* curr_distance_grid = m_distance_grid;
     int* curr_queue = m_queue;
     int* curr_queue_head = &m_queue_head;
     int* curr_queue_tail = &m_queue_tail;
 
-    int volatile* next_distance_grid = wall_bfs.m_distance_grid;
+    std::atomic<int>* next_distance_grid = wall_bfs.m_distance_grid;
     int* next_queue = wall_bfs.m_queue;
     int* next_queue_head = &wall_bfs.m_queue_head;
     int* next_queue_tail = &wall_bfs.m_queue_tail;
@@ -269,7 +422,7 @@ void BFS_3D::run_components(int gx, int gy, int gz)
     // combine distance fields
     for (int i = 0; i < m_dim_xyz; ++i) {
         if (wall_bfs.m_distance_grid[i] != WALL) {
-            m_distance_grid[i] = wall_bfs.m_distance_grid[i];
+            m_distance_grid[i] = wall_bfs.m_distance_grid[i].load();
         }
     }
 }
@@ -359,6 +512,12 @@ void BFS_3D::visit_free_cells(int node, const Visitor& visitor)
 int BFS_3D::getDistance(int x, int y, int z) const
 {
     int node = getNode(x, y, z);
+    if (m_lazy) {
+        if (isWall(node)) {
+            return WALL;
+        }
+        expandUntilDiscovered(node);
+    }
     while (m_running && m_distance_grid[node] < 0);
     return m_distance_grid[node];
 }
@@ -451,15 +610,12 @@ if (inBounds(xn, yn, zn)) {\
     return -1;
 }
 
+// Count the walls in the wall grid, which may have been modified through
+// another search since this search last ran, along with the border cells.
 int BFS_3D::countWalls() const
 {
-    int count = 0;
-    for (int i = 0; i < m_dim_xyz; ++i) {
-        if (m_distance_grid[i] == WALL) {
-            ++count;
-        }
-    }
-    return count;
+    auto inner = (m_dim_x - 2) * (m_dim_y - 2) * (m_dim_z - 2);
+    return m_walls->countWalls() + (m_dim_xyz - inner);
 }
 
 int BFS_3D::countUndiscovered() const
@@ -484,55 +640,161 @@ int BFS_3D::countDiscovered() const
     return count;
 }
 
-#define EXPAND_NEIGHBOR(offset)                            \
-    if (distance_grid[currentNode + offset] < 0) {         \
-        queue[queue_tail++] = currentNode + offset;        \
-        distance_grid[currentNode + offset] = currentCost; \
+// Expand the queue one frontier at a time. Cells of the current frontier
+// occupy [m_queue_head, m_queue_tail) and the next frontier is appended
+// directly after them, so the queue has the same layout as a serial BFS.
+void BFS_3D::search()
+{
+    // the search thread participates in every expansion
+    std::vector<std::thread> workers;
+    {
+        std::unique_lock<std::mutex> lock(m_pool_mutex);
+        m_pool_generation = 0;
+        m_pool_active = 0;
+        m_pool_shutdown = false;
     }
 
-void BFS_3D::search(
-    int width,
-    int planeSize,
-    int volatile* distance_grid,
-    int* queue,
-    int& queue_head,
-    int& queue_tail)
-{
-    while (queue_head < queue_tail) {
-        int currentNode = queue[queue_head++];
-        int currentCost = distance_grid[currentNode] + 1;
+    int cost = 1;
+    while (m_queue_head < m_queue_tail && !m_cancel) {
+        m_frontier_end = m_queue_tail;
+        m_frontier_cost = cost;
+        m_frontier_next = m_queue_head;
+        m_frontier_tail = m_queue_tail;
+
+        int frontier_size = m_queue_tail - m_queue_head;
+        if (m_num_threads > 1 && frontier_size >= MIN_PARALLEL_FRONTIER_SIZE) {
+            // spin up the pool lazily, on the first frontier large enough to
+            // benefit from it
+            while ((int)workers.size() < m_num_threads - 1) {
+                workers.emplace_back([this]() { this->workerLoop(); });
+            }
 
-        EXPAND_NEIGHBOR(-width);
-        EXPAND_NEIGHBOR(1);
-        EXPAND_NEIGHBOR(width);
-        EXPAND_NEIGHBOR(-1);
-        EXPAND_NEIGHBOR(-width-1);
-        EXPAND_NEIGHBOR(-width+1);
-        EXPAND_NEIGHBOR(width+1);
-        EXPAND_NEIGHBOR(width-1);
-        EXPAND_NEIGHBOR(planeSize);
-        EXPAND_NEIGHBOR(-width+planeSize);
-        EXPAND_NEIGHBOR(1+planeSize);
-        EXPAND_NEIGHBOR(width+planeSize);
-        EXPAND_NEIGHBOR(-1+planeSize);
-        EXPAND_NEIGHBOR(-width-1+planeSize);
-        EXPAND_NEIGHBOR(-width+1+planeSize);
-        EXPAND_NEIGHBOR(width+1+planeSize);
-        EXPAND_NEIGHBOR(width-1+planeSize);
-        EXPAND_NEIGHBOR(-planeSize);
-        EXPAND_NEIGHBOR(-width-planeSize);
-        EXPAND_NEIGHBOR(1-planeSize);
-        EXPAND_NEIGHBOR(width-planeSize);
-        EXPAND_NEIGHBOR(-1-planeSize);
-        EXPAND_NEIGHBOR(-width-1-planeSize);
-        EXPAND_NEIGHBOR(-width+1-planeSize);
-        EXPAND_NEIGHBOR(width+1-planeSize);
-        EXPAND_NEIGHBOR(width-1-planeSize);
+            {
+                std::unique_lock<std::mutex> lock(m_pool_mutex);
+                m_pool_active = (int)workers.size();
+                ++m_pool_generation;
+            }
+            m_pool_start.notify_all();
+
+            expandFrontier();
+
+            std::unique_lock<std::mutex> lock(m_pool_mutex);
+            m_pool_finish.wait(lock, [&]() { return m_pool_active == 0; });
+        } else {
+            expandFrontier();
+        }
+
+        m_queue_head = m_frontier_end;
+        m_queue_tail = m_frontier_tail;
+        ++cost;
     }
+
+    if (!workers.empty()) {
+        {
+            std::unique_lock<std::mutex> lock(m_pool_mutex);
+            m_pool_shutdown = true;
+        }
+        m_pool_start.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
     m_running = false;
 }
 
-#undef EXPAND_NEIGHBOR
+// Continue a lazy search, in the calling thread, until the given cell has been
+// discovered or every cell reachable from the start cells has been discovered.
+// Cells are expanded in the same first-in, first-out order as a complete
+// search, so later lookups pick up exactly where this one stops.
+void BFS_3D::expandUntilDiscovered(int node) const
+{
+    while (m_distance_grid[node].load(std::memory_order_relaxed) < 0 &&
+        m_queue_head < m_queue_tail)
+    {
+        int n = m_queue[m_queue_head++];
+        int cost = m_distance_grid[n].load(std::memory_order_relaxed) + 1;
+        for (int i = 0; i < 26; ++i) {
+            int nn = n + m_neighbor_offsets[i];
+            if (!isWall(nn) &&
+                m_distance_grid[nn].load(std::memory_order_relaxed) < 0)
+            {
+                m_distance_grid[nn].store(cost, std::memory_order_relaxed);
+                m_queue[m_queue_tail++] = nn;
+            }
+        }
+    }
+}
+
+// Claim blocks of the current frontier until it is exhausted. Discovered cells
+// are collected locally and appended to the next frontier with a single atomic
+// reservation per block.
+void BFS_3D::expandFrontier()
+{
+    int discovered[FRONTIER_BLOCK_SIZE * 26];
+
+    const int cost = m_frontier_cost;
+    const int end = m_frontier_end;
+    while (true) {
+        int begin = m_frontier_next.fetch_add(FRONTIER_BLOCK_SIZE);
+        if (begin >= end) {
+            break;
+        }
+        int block_end = std::min(begin + FRONTIER_BLOCK_SIZE, end);
+
+        int count = 0;
+        for (int i = begin; i < block_end; ++i) {
+            int node = m_queue[i];
+            for (int n = 0; n < 26; ++n) {
+                int nn = node + m_neighbor_offsets[n];
+                if (isWall(nn)) {
+                    continue;
+                }
+                int d = m_distance_grid[nn].load(std::memory_order_relaxed);
+                if (d < 0 &&
+                    m_distance_grid[nn].compare_exchange_strong(
+                            d, cost, std::memory_order_relaxed))
+                {
+                    discovered[count++] = nn;
+                }
+            }
+        }
+
+        if (count > 0) {
+            int pos = m_frontier_tail.fetch_add(count);
+            std::copy(discovered, discovered + count, m_queue + pos);
+        }
+    }
+}
+
+void BFS_3D::workerLoop()
+{
+    int generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_pool_mutex);
+            m_pool_start.wait(lock, [&]()
+            {
+                return m_pool_shutdown || m_pool_generation != generation;
+            });
+            if (m_pool_shutdown) {
+                return;
+            }
+            generation = m_pool_generation;
+        }
+
+        expandFrontier();
+
+        bool last;
+        {
+            std::unique_lock<std::mutex> lock(m_pool_mutex);
+            last = (--m_pool_active == 0);
+        }
+        if (last) {
+            m_pool_finish.notify_one();
+        }
+    }
+}
 
 #define EXPAND_NEIGHBOR_FRONTIER(offset) \
 {\
@@ -551,11 +813,11 @@ void BFS_3D::search(
 void BFS_3D::search(
     int width,
     int planeSize,
-    int volatile* distance_grid,
+    std::atomic<int>* distance_grid,
     int* queue,
     int& queue_head,
     int& queue_tail,
-    int volatile* frontier_grid,
+    std::atomic<int>* frontier_grid,
     int* frontier_queue,
     int& frontier_queue_head,
     int& frontier_queue_tail)
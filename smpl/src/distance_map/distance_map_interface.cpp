@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+
+/// \author Andrew Dornbush
+
+#include <smpl/distance_map/distance_map_interface.h>
+
+// project includes
+#include <smpl/distance_map/detail/distance_map_common.h>
+
+namespace smpl {
+
+/// Return the trilinearly interpolated distance at a point.
+double DistanceMapInterface::getInterpMetricDistance(
+    double x, double y, double z) const
+{
+    return interpMetricDistance(x, y, z, nullptr);
+}
+
+/// Return the trilinearly interpolated distance at a point and its gradient.
+double DistanceMapInterface::getInterpMetricDistance(
+    double x, double y, double z,
+    Vector3& grad) const
+{
+    return interpMetricDistance(x, y, z, &grad);
+}
+
+/// Return the trilinearly interpolated distances at a set of points.
+void DistanceMapInterface::getInterpMetricDistances(
+    const std::vector<Vector3>& points,
+    std::vector<double>& dists) const
+{
+    dists.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Vector3& p = points[i];
+        dists[i] = interpMetricDistance(p.x(), p.y(), p.z(), nullptr);
+    }
+}
+
+/// Return the trilinearly interpolated distances, and their gradients, at a
+/// set of points.
+void DistanceMapInterface::getInterpMetricDistances(
+    const std::vector<Vector3>& points,
+    std::vector<double>& dists,
+    std::vector<Vector3>& grads) const
+{
+    dists.resize(points.size());
+    grads.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Vector3& p = points[i];
+        dists[i] = interpMetricDistance(p.x(), p.y(), p.z(), &grads[i]);
+    }
+}
+
+double DistanceMapInterface::interpMetricDistance(
+    double x, double y, double z,
+    Vector3* grad) const
+{
+    // world position of the center of cell (0, 0, 0)
+    double cx, cy, cz;
+    gridToWorld(0, 0, 0, cx, cy, cz);
+
+    const double inv_res = 1.0 / m_res;
+    auto cell_dist = [&](int gx, int gy, int gz) {
+        return isCellValid(gx, gy, gz) ? getCellDistance(gx, gy, gz) : 0.0;
+    };
+    return InterpolateDistance(
+            cell_dist,
+            (x - cx) * inv_res, (y - cy) * inv_res, (z - cz) * inv_res,
+            inv_res,
+            grad);
+}
+
+} // namespace smpl
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+
+/// \author Andrew Dornbush
+
+#include <smpl/distance_map/distance_pyramid.h>
+
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace smpl {
+
+/// \class DistancePyramid
+///
+/// The pyramid does not observe changes to its distance map. The owner of the
+/// distance map is responsible for calling one of the update() overloads after
+/// modifying it. OccupancyGrid does this automatically when a pyramid is
+/// enabled via OccupancyGrid::setDistancePyramidEnabled().
+///
+/// Each coarse cell stores the minimum cell distance of the underlying cells it
+/// covers, reduced by the largest difference between a cell's distance and the
+/// metric distance reported for any point within that cell (sqrt(3) * res),
+/// so that the stored value is a valid lower bound for any distance map
+/// implementation.
+
+/// Construct the pyramid and compute all levels from the current contents of
+/// the distance map. The distance map must outlive the pyramid.
+DistancePyramid::DistancePyramid(const DistanceMapInterface* dmap) :
+    m_dmap(dmap),
+    m_cell_error(std::sqrt(3.0) * dmap->resolution()),
+    m_levels()
+{
+    for (int l = 0; l < NUM_LEVELS; ++l) {
+        const int shift = l + 1;
+        const int block = 1 << shift;
+        m_levels[l].resize(
+                (m_dmap->numCellsX() + block - 1) >> shift,
+                (m_dmap->numCellsY() + block - 1) >> shift,
+                (m_dmap->numCellsZ() + block - 1) >> shift,
+                0.0f);
+    }
+    update();
+}
+
+/// Return the size, in meters, of a cell at the given level.
+double DistancePyramid::levelResolution(int level) const
+{
+    return m_dmap->resolution() * (1 << (level + 1));
+}
+
+/// Recompute all levels of the pyramid.
+void DistancePyramid::update()
+{
+    update(
+            0, 0, 0,
+            m_dmap->numCellsX() - 1,
+            m_dmap->numCellsY() - 1,
+            m_dmap->numCellsZ() - 1);
+}
+
+/// Recompute the coarse cells covering the inclusive range of distance map
+/// cells [min, max].
+void DistancePyramid::update(
+    int min_x, int min_y, int min_z,
+    int max_x, int max_y, int max_z)
+{
+    min_x = std::max(min_x, 0);
+    min_y = std::max(min_y, 0);
+    min_z = std::max(min_z, 0);
+    max_x = std::min(max_x, m_dmap->numCellsX() - 1);
+    max_y = std::min(max_y, m_dmap->numCellsY() - 1);
+    max_z = std::min(max_z, m_dmap->numCellsZ() - 1);
+    if (min_x > max_x || min_y > max_y || min_z > max_z) {
+        return;
+    }
+
+    for (int l = 0; l < NUM_LEVELS; ++l) {
+        const int shift = l + 1;
+        updateLevel(
+                l,
+                min_x >> shift, min_y >> shift, min_z >> shift,
+                max_x >> shift, max_y >> shift, max_z >> shift);
+    }
+}
+
+/// Recompute the coarse cells whose distances may have been affected by the
+/// insertion or removal of the given obstacle points. Changes to the distance
+/// map propagate no further than the map's maximum distance from each point.
+void DistancePyramid::update(const std::vector<Vector3>& points)
+{
+    if (points.empty()) {
+        return;
+    }
+
+    int min_x = std::numeric_limits<int>::max();
+    int min_y = std::numeric_limits<int>::max();
+    int min_z = std::numeric_limits<int>::max();
+    int max_x = std::numeric_limits<int>::lowest();
+    int max_y = std::numeric_limits<int>::lowest();
+    int max_z = std::numeric_limits<int>::lowest();
+    for (const Vector3& p : points) {
+        int gx, gy, gz;
+        m_dmap->worldToGrid(p.x(), p.y(), p.z(), gx, gy, gz);
+        min_x = std::min(min_x, gx);
+        min_y = std::min(min_y, gy);
+        min_z = std::min(min_z, gz);
+        max_x = std::max(max_x, gx);
+        max_y = std::max(max_y, gy);
+        max_z = std::max(max_z, gz);
+    }
+
+    const int inflation = (int)std::ceil(
+            m_dmap->getUninitializedDistance() / m_dmap->resolution()) + 1;
+    update(
+            min_x - inflation, min_y - inflation, min_z - inflation,
+            max_x + inflation, max_y + inflation, max_z + inflation);
+}
+
+/// Recompute the inclusive range of cells [min, max] at the given level, from
+/// the distance map for the finest level and from the next finer level
+/// otherwise.
+void DistancePyramid::updateLevel(
+    int level,
+    int min_x, int min_y, int min_z,
+    int max_x, int max_y, int max_z)
+{
+    Grid3<float>& grid = m_levels[level];
+
+    if (level == 0) {
+        const int ncx = m_dmap->numCellsX();
+        const int ncy = m_dmap->numCellsY();
+        const int ncz = m_dmap->numCellsZ();
+        for (int x = min_x; x <= max_x; ++x) {
+        for (int y = min_y; y <= max_y; ++y) {
+        for (int z = min_z; z <= max_z; ++z) {
+            double d = std::numeric_limits<double>::max();
+            for (int cx = 2 * x; cx < std::min(2 * x + 2, ncx); ++cx) {
+            for (int cy = 2 * y; cy < std::min(2 * y + 2, ncy); ++cy) {
+            for (int cz = 2 * z; cz < std::min(2 * z + 2, ncz); ++cz) {
+                d = std::min(d, m_dmap->getCellDistance(cx, cy, cz));
+            }
+            }
+            }
+            grid(x, y, z) = (float)std::max(0.0, d - m_cell_error);
+        }
+        }
+        }
+    } else {
+        const Grid3<float>& finer = m_levels[level - 1];
+        const int ncx = (int)finer.xsize();
+        const int ncy = (int)finer.ysize();
+        const int ncz = (int)finer.zsize();
+        for (int x = min_x; x <= max_x; ++x) {
+        for (int y = min_y; y <= max_y; ++y) {
+        for (int z = min_z; z <= max_z; ++z) {
+            float d = std::numeric_limits<float>::max();
+            for (int cx = 2 * x; cx < std::min(2 * x + 2, ncx); ++cx) {
+            for (int cy = 2 * y; cy < std::min(2 * y + 2, ncy); ++cy) {
+            for (int cz = 2 * z; cz < std::min(2 * z + 2, ncz); ++cz) {
+                d = std::min(d, finer(cx, cy, cz));
+            }
+            }
+            }
+            grid(x, y, z) = d;
+        }
+        }
+        }
+    }
+}
+
+} // namespace smpl
@@ -330,6 +330,43 @@ double SparseDistanceMap::getCellSquaredDistance(int x, int y, int z) const
     return getMetricSquaredDistance(wx, wy, wz);
 }
 
+double SparseDistanceMap::getInterpMetricDistance(
+    double x, double y, double z) const
+{
+    return interpDistance(x, y, z, nullptr);
+}
+
+double SparseDistanceMap::getInterpMetricDistance(
+    double x, double y, double z,
+    Vector3& grad) const
+{
+    return interpDistance(x, y, z, &grad);
+}
+
+void SparseDistanceMap::getInterpMetricDistances(
+    const std::vector<Vector3>& points,
+    std::vector<double>& dists) const
+{
+    dists.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Vector3& p = points[i];
+        dists[i] = interpDistance(p.x(), p.y(), p.z(), nullptr);
+    }
+}
+
+void SparseDistanceMap::getInterpMetricDistances(
+    const std::vector<Vector3>& points,
+    std::vector<double>& dists,
+    std::vector<Vector3>& grads) const
+{
+    dists.resize(points.size());
+    grads.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Vector3& p = points[i];
+        dists[i] = interpDistance(p.x(), p.y(), p.z(), &grads[i]);
+    }
+}
+
 /// Return the effective grid coordinates of the cell containing the given point
 /// specified in world coordinates.
 void SparseDistanceMap::gridToWorld(
@@ -822,4 +859,25 @@ double SparseDistanceMap::getInterpMetricSquaredDistance(
     return (sum - m_error) * (sum - m_error);
 }
 
+/// Trilinearly interpolate the distances of the 8 cells surrounding a point.
+/// Cells outside the bounding volume are treated as obstacles.
+double SparseDistanceMap::interpDistance(
+    double x, double y, double z,
+    Vector3* grad) const
+{
+    auto cell_dist = [&](int gx, int gy, int gz) {
+        if (!SparseDistanceMap::isCellValid(gx, gy, gz)) {
+            return 0.0;
+        }
+        return m_sqrt_table[m_cells.get(gx, gy, gz).dist];
+    };
+    return InterpolateDistance(
+            cell_dist,
+            (x - m_origin_x) * m_inv_res,
+            (y - m_origin_y) * m_inv_res,
+            (z - m_origin_z) * m_inv_res,
+            m_inv_res,
+            grad);
+}
+
 } // namespace smpl
@@ -407,6 +407,10 @@ bool AdaptiveWorkspaceLattice::setStart(const RobotState& state)
     }
 
     SMPL_DEBUG_NAMED(G_LOG, "set the start state");
+
+    // the robot model may have moved since the last query
+    clearIKCache();
+
     if (state.size() < robot()->jointVariableCount()) {
         SMPL_ERROR_NAMED(G_LOG, "start state contains insufficient coordinate positions");
         return false;
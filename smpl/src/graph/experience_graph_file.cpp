@@ -0,0 +1,595 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/graph/experience_graph_file.h>
+
+// standard includes
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+// system includes
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// project includes
+#include <smpl/console/console.h>
+
+namespace smpl {
+
+static const char* LOG = "graph.egraph_file";
+
+static const char FileMagic[8] = { 'S', 'M', 'P', 'L', 'E', 'G', 'R', 'F' };
+static const std::uint32_t FileVersion = 1;
+static const std::uint32_t SegmentMagic = 0x4d474553; // "SEGM"
+
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t variable_count;
+    // followed by variable_count resolutions
+};
+
+struct SegmentHeader
+{
+    std::uint32_t magic;
+    std::uint32_t node_count;
+    std::uint32_t edge_count;
+    std::uint32_t waypoint_count;
+    std::uint32_t component_count;
+    std::uint32_t reserved;
+    std::uint64_t payload_size;
+    std::uint64_t checksum;
+};
+
+static_assert(sizeof(FileHeader) == 16, "unexpected file header size");
+static_assert(sizeof(SegmentHeader) == 40, "unexpected segment header size");
+static_assert(
+        sizeof(ExperienceGraphFile::Edge) == 16,
+        "unexpected edge record size");
+
+// Sections of a segment's payload are padded to a multiple of 8 bytes so that
+// every section of a segment is suitably aligned for doubles.
+static auto Pad(std::uint64_t n) -> std::uint64_t
+{
+    return (n + 7) & ~std::uint64_t(7);
+}
+
+struct SegmentLayout
+{
+    std::uint64_t states;
+    std::uint64_t coords;
+    std::uint64_t components;
+    std::uint64_t edges;
+    std::uint64_t waypoints;
+    std::uint64_t size;
+};
+
+static auto MakeSegmentLayout(
+    std::uint64_t variable_count,
+    const SegmentHeader& header)
+    -> SegmentLayout
+{
+    SegmentLayout layout;
+    layout.states = 0;
+    layout.coords = layout.states +
+            Pad(header.node_count * variable_count * sizeof(double));
+    layout.components = layout.coords +
+            Pad(header.node_count * variable_count * sizeof(std::int32_t));
+    layout.edges = layout.components +
+            Pad(header.node_count * sizeof(std::uint32_t));
+    layout.waypoints = layout.edges +
+            Pad(header.edge_count * sizeof(ExperienceGraphFile::Edge));
+    layout.size = layout.waypoints +
+            Pad(header.waypoint_count * variable_count * sizeof(double));
+    return layout;
+}
+
+// 64-bit FNV-1a
+static auto Checksum(const char* data, std::size_t size) -> std::uint64_t
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static auto HeaderSize(std::uint64_t variable_count) -> std::uint64_t
+{
+    return sizeof(FileHeader) + variable_count * sizeof(double);
+}
+
+static bool ParseFileHeader(
+    const char* data,
+    std::size_t size,
+    std::uint32_t& variable_count)
+{
+    if (size < sizeof(FileHeader)) {
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0) {
+        return false;
+    }
+    if (header.version != FileVersion) {
+        SMPL_ERROR_NAMED(LOG, "Unsupported experience graph file version %u", header.version);
+        return false;
+    }
+    if (header.variable_count == 0 ||
+        size < HeaderSize(header.variable_count))
+    {
+        return false;
+    }
+
+    variable_count = header.variable_count;
+    return true;
+}
+
+// Parse the segment at the given offset, returning false if the segment is
+// truncated, corrupt, or refers to data outside itself. Checksum verification
+// is optional, so that appends need only verify the last segment.
+static bool ParseSegment(
+    const char* data,
+    std::size_t size,
+    std::size_t offset,
+    std::uint32_t variable_count,
+    bool verify,
+    ExperienceGraphFile::Segment& segment,
+    std::size_t& next)
+{
+    if (size - offset < sizeof(SegmentHeader)) {
+        return false;
+    }
+
+    SegmentHeader header;
+    std::memcpy(&header, data + offset, sizeof(header));
+    if (header.magic != SegmentMagic) {
+        return false;
+    }
+
+    auto layout = MakeSegmentLayout(variable_count, header);
+    auto* payload = data + offset + sizeof(SegmentHeader);
+    if (header.payload_size != layout.size ||
+        layout.size > size - offset - sizeof(SegmentHeader))
+    {
+        return false;
+    }
+
+    if (verify && Checksum(payload, layout.size) != header.checksum) {
+        return false;
+    }
+
+    segment.node_count = header.node_count;
+    segment.edge_count = header.edge_count;
+    segment.waypoint_count = header.waypoint_count;
+    segment.component_count = header.component_count;
+    segment.states = reinterpret_cast<const double*>(payload + layout.states);
+    segment.coords = reinterpret_cast<const std::int32_t*>(payload + layout.coords);
+    segment.components = reinterpret_cast<const std::uint32_t*>(payload + layout.components);
+    segment.edges = reinterpret_cast<const ExperienceGraphFile::Edge*>(payload + layout.edges);
+    segment.waypoints = reinterpret_cast<const double*>(payload + layout.waypoints);
+
+    for (std::uint32_t i = 0; i < segment.node_count; ++i) {
+        if (segment.components[i] >= segment.component_count) {
+            return false;
+        }
+    }
+    for (std::uint32_t i = 0; i < segment.edge_count; ++i) {
+        auto& edge = segment.edges[i];
+        if (edge.source >= segment.node_count ||
+            edge.target >= segment.node_count ||
+            (std::uint64_t)edge.waypoint_offset + edge.waypoint_count >
+                    segment.waypoint_count)
+        {
+            return false;
+        }
+    }
+
+    next = offset + sizeof(SegmentHeader) + layout.size;
+    return true;
+}
+
+ExperienceGraphFile::~ExperienceGraphFile()
+{
+    close();
+}
+
+/// Map the file at the given path and index its segments. Returns false if
+/// the file cannot be mapped or does not begin with a valid header. Trailing
+/// data that does not form a valid segment is ignored.
+bool ExperienceGraphFile::open(const std::string& path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        SMPL_ERROR_NAMED(LOG, "Failed to open experience graph file '%s'", path.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+        ::close(fd);
+        SMPL_ERROR_NAMED(LOG, "Experience graph file '%s' is empty", path.c_str());
+        return false;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        SMPL_ERROR_NAMED(LOG, "Failed to map experience graph file '%s'", path.c_str());
+        return false;
+    }
+
+    m_data = (const char*)data;
+    m_size = st.st_size;
+
+    std::uint32_t variable_count;
+    if (!ParseFileHeader(m_data, m_size, variable_count)) {
+        SMPL_ERROR_NAMED(LOG, "'%s' is not an experience graph file", path.c_str());
+        close();
+        return false;
+    }
+
+    m_variable_count = (int)variable_count;
+    m_resolutions.resize(variable_count);
+    std::memcpy(
+            m_resolutions.data(),
+            m_data + sizeof(FileHeader),
+            variable_count * sizeof(double));
+
+    auto offset = (std::size_t)HeaderSize(variable_count);
+    while (offset < m_size) {
+        Segment segment;
+        std::size_t next;
+        if (!ParseSegment(m_data, m_size, offset, variable_count, true, segment, next)) {
+            SMPL_WARN_NAMED(LOG, "Ignore %zu bytes of incomplete data at the end of experience graph file '%s'", m_size - offset, path.c_str());
+            break;
+        }
+        m_segments.push_back(segment);
+        m_node_count += segment.node_count;
+        m_edge_count += segment.edge_count;
+        offset = next;
+    }
+
+    SMPL_DEBUG_NAMED(LOG, "Mapped experience graph file with %zu segments, %zu nodes, and %zu edges", m_segments.size(), m_node_count, m_edge_count);
+    return true;
+}
+
+void ExperienceGraphFile::close()
+{
+    if (m_data) {
+        munmap((void*)m_data, m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_variable_count = 0;
+    m_resolutions.clear();
+    m_segments.clear();
+    m_node_count = 0;
+    m_edge_count = 0;
+}
+
+/// Return whether the given path names a regular file that begins with the
+/// experience graph file header.
+bool IsExperienceGraphFile(const std::string& path)
+{
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin.is_open()) {
+        return false;
+    }
+
+    char magic[sizeof(FileMagic)];
+    if (!fin.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return std::memcmp(magic, FileMagic, sizeof(FileMagic)) == 0;
+}
+
+static bool WriteAll(int fd, const char* data, std::size_t size, off_t offset)
+{
+    while (size > 0) {
+        auto written = pwrite(fd, data, size, offset);
+        if (written < 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+        offset += written;
+    }
+    return true;
+}
+
+/// Create an empty experience graph file, with no segments, for states whose
+/// coordinates are discretized at the given resolutions. Any existing file at
+/// the path is replaced atomically.
+bool CreateExperienceGraphFile(
+    const std::string& path,
+    const std::vector<double>& resolutions)
+{
+    if (resolutions.empty()) {
+        SMPL_ERROR_NAMED(LOG, "Experience graph file requires at least one variable");
+        return false;
+    }
+
+    std::vector<char> buf(HeaderSize(resolutions.size()));
+    FileHeader header;
+    std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.version = FileVersion;
+    header.variable_count = (std::uint32_t)resolutions.size();
+    std::memcpy(buf.data(), &header, sizeof(header));
+    std::memcpy(
+            buf.data() + sizeof(header),
+            resolutions.data(),
+            resolutions.size() * sizeof(double));
+
+    auto tmp_path = path + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        SMPL_ERROR_NAMED(LOG, "Failed to create experience graph file '%s'", tmp_path.c_str());
+        return false;
+    }
+
+    bool ok = WriteAll(fd, buf.data(), buf.size(), 0) && fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || rename(tmp_path.c_str(), path.c_str()) == -1) {
+        SMPL_ERROR_NAMED(LOG, "Failed to write experience graph file '%s'", path.c_str());
+        unlink(tmp_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+static void ComputeComponents(
+    const ExperienceGraph& egraph,
+    std::vector<std::uint32_t>& components,
+    std::uint32_t& component_count)
+{
+    const auto none = std::numeric_limits<std::uint32_t>::max();
+    components.assign(egraph.num_nodes(), none);
+    component_count = 0;
+    std::vector<ExperienceGraph::node_id> frontier;
+    auto nodes = egraph.nodes();
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        if (components[*nit] != none) {
+            continue;
+        }
+
+        frontier.push_back(*nit);
+        components[*nit] = component_count;
+        while (!frontier.empty()) {
+            auto n = frontier.back();
+            frontier.pop_back();
+            auto adj = egraph.adjacent_nodes(n);
+            for (auto ait = adj.first; ait != adj.second; ++ait) {
+                if (components[*ait] == none) {
+                    components[*ait] = component_count;
+                    frontier.push_back(*ait);
+                }
+            }
+        }
+
+        ++component_count;
+    }
+}
+
+// Serialize an experience graph into a segment, header included.
+static bool MakeSegment(
+    const ExperienceGraph& egraph,
+    const std::vector<std::vector<int>>& coords,
+    std::uint32_t variable_count,
+    std::vector<char>& buf)
+{
+    const auto max_count = (std::size_t)std::numeric_limits<std::uint32_t>::max();
+    if (coords.size() != egraph.num_nodes()) {
+        SMPL_ERROR_NAMED(LOG, "Expected one coordinate per experience graph node");
+        return false;
+    }
+
+    std::size_t waypoint_count = 0;
+    auto edges = egraph.edges();
+    for (auto eit = edges.first; eit != edges.second; ++eit) {
+        for (auto& waypoint : egraph.waypoints(*eit)) {
+            if (waypoint.size() != variable_count) {
+                SMPL_ERROR_NAMED(LOG, "Experience graph waypoint has %zu variables; expected %u", waypoint.size(), variable_count);
+                return false;
+            }
+        }
+        waypoint_count += egraph.waypoints(*eit).size();
+    }
+
+    auto nodes = egraph.nodes();
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        if (egraph.state(*nit).size() != variable_count ||
+            coords[*nit].size() != variable_count)
+        {
+            SMPL_ERROR_NAMED(LOG, "Experience graph node has %zu variables; expected %u", egraph.state(*nit).size(), variable_count);
+            return false;
+        }
+    }
+
+    if (egraph.num_nodes() > max_count ||
+        egraph.num_edges() > max_count ||
+        waypoint_count > max_count)
+    {
+        SMPL_ERROR_NAMED(LOG, "Experience graph is too large for a single segment");
+        return false;
+    }
+
+    std::vector<std::uint32_t> components;
+    SegmentHeader header;
+    header.magic = SegmentMagic;
+    header.node_count = (std::uint32_t)egraph.num_nodes();
+    header.edge_count = (std::uint32_t)egraph.num_edges();
+    header.waypoint_count = (std::uint32_t)waypoint_count;
+    ComputeComponents(egraph, components, header.component_count);
+    header.reserved = 0;
+
+    auto layout = MakeSegmentLayout(variable_count, header);
+    header.payload_size = layout.size;
+
+    buf.assign(sizeof(SegmentHeader) + layout.size, 0);
+    auto* payload = buf.data() + sizeof(SegmentHeader);
+
+    auto* states = reinterpret_cast<double*>(payload + layout.states);
+    auto* coord_data = reinterpret_cast<std::int32_t*>(payload + layout.coords);
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        auto& state = egraph.state(*nit);
+        auto& coord = coords[*nit];
+        for (std::uint32_t i = 0; i < variable_count; ++i) {
+            states[*nit * variable_count + i] = state[i];
+            coord_data[*nit * variable_count + i] = coord[i];
+        }
+    }
+
+    std::memcpy(
+            payload + layout.components,
+            components.data(),
+            components.size() * sizeof(std::uint32_t));
+
+    auto* edge_data = reinterpret_cast<ExperienceGraphFile::Edge*>(payload + layout.edges);
+    auto* waypoints = reinterpret_cast<double*>(payload + layout.waypoints);
+    std::uint32_t waypoint_offset = 0;
+    for (auto eit = edges.first; eit != edges.second; ++eit) {
+        auto& edge = edge_data[*eit];
+        auto& edge_waypoints = egraph.waypoints(*eit);
+        edge.source = (std::uint32_t)egraph.source(*eit);
+        edge.target = (std::uint32_t)egraph.target(*eit);
+        edge.waypoint_offset = waypoint_offset;
+        edge.waypoint_count = (std::uint32_t)edge_waypoints.size();
+        for (auto& waypoint : edge_waypoints) {
+            std::memcpy(
+                    waypoints + waypoint_offset * variable_count,
+                    waypoint.data(),
+                    variable_count * sizeof(double));
+            ++waypoint_offset;
+        }
+    }
+
+    header.checksum = Checksum(payload, layout.size);
+    std::memcpy(buf.data(), &header, sizeof(header));
+    return true;
+}
+
+// Read the number of variables stored in the file and find the size of its
+// valid prefix: the header and all intact segments. Earlier segments were
+// verified when they were appended, so only the checksum of the last segment
+// is verified here.
+static bool FindAppendOffset(
+    int fd,
+    std::uint32_t& variable_count,
+    std::size_t& end)
+{
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+        return false;
+    }
+
+    auto size = (std::size_t)st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    auto* data = (const char*)map;
+    bool ok = ParseFileHeader(data, size, variable_count);
+    if (ok) {
+        end = (std::size_t)HeaderSize(variable_count);
+        while (end < size) {
+            ExperienceGraphFile::Segment segment;
+            std::size_t next;
+            if (!ParseSegment(data, size, end, variable_count, false, segment, next) ||
+                (next == size &&
+                !ParseSegment(data, size, end, variable_count, true, segment, next)))
+            {
+                SMPL_WARN_NAMED(LOG, "Discard %zu bytes of incomplete data at the end of experience graph file", size - end);
+                break;
+            }
+            end = next;
+        }
+    }
+
+    munmap(map, size);
+    return ok;
+}
+
+/// Append an experience graph as a new segment at the end of an existing
+/// experience graph file, along with the discrete coordinates of its nodes,
+/// indexed by node id. The segment is written with a single write under an
+/// exclusive lock on the file, and is synced to disk before returning;
+/// incomplete data left at the end of the file by an interrupted append is
+/// discarded first.
+bool AppendExperienceGraphFile(
+    const std::string& path,
+    const ExperienceGraph& egraph,
+    const std::vector<std::vector<int>>& coords)
+{
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd == -1) {
+        SMPL_ERROR_NAMED(LOG, "Failed to open experience graph file '%s'", path.c_str());
+        return false;
+    }
+
+    if (flock(fd, LOCK_EX) == -1) {
+        SMPL_ERROR_NAMED(LOG, "Failed to lock experience graph file '%s'", path.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    std::vector<char> buf;
+    std::uint32_t variable_count;
+    std::size_t end;
+    bool ok =
+            FindAppendOffset(fd, variable_count, end) &&
+            MakeSegment(egraph, coords, variable_count, buf) &&
+            ftruncate(fd, end) == 0 &&
+            WriteAll(fd, buf.data(), buf.size(), end) &&
+            fsync(fd) == 0;
+
+    if (!ok) {
+        SMPL_ERROR_NAMED(LOG, "Failed to append to experience graph file '%s'", path.c_str());
+    }
+
+    flock(fd, LOCK_UN);
+    ::close(fd);
+    return ok;
+}
+
+} // namespace smpl
@@ -913,6 +913,12 @@ void ManipLattice::clearStates()
     m_state_to_id.clear();
     m_states.shrink_to_fit();
 
+    // state ids are reassigned from zero
+    for (auto* pinds : StateID2IndexMapping) {
+        delete[] pinds;
+    }
+    StateID2IndexMapping.clear();
+
     m_goal_state_id = reserveHashEntry();
 }
 
@@ -33,9 +33,14 @@
 #include <smpl/graph/manip_lattice_action_space.h>
 
 // standard includes
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <numeric>
 
+// system includes
+#include <Eigen/Dense>
+
 // project includes
 #include <smpl/angles.h>
 #include <smpl/console/console.h>
@@ -198,6 +203,7 @@ void ManipLatticeActionSpace::addMotionPrim(
 
     m.action.push_back(mprim);
     m_mprims.push_back(m);
+    m_jacobian_regions.clear();
 
     if (add_converse) {
         for (RobotState& state : m.action) {
@@ -215,6 +221,7 @@ void ManipLatticeActionSpace::addMotionPrim(
 void ManipLatticeActionSpace::clear()
 {
     m_mprims.clear();
+    m_jacobian_regions.clear();
 
     // add all amps to the motion primitive set
     MotionPrimitive mprim;
@@ -302,6 +309,53 @@ void ManipLatticeActionSpace::ampThresh(
     }
 }
 
+bool ManipLatticeActionSpace::useJacobianTables() const
+{
+    return m_use_jacobian_tables;
+}
+
+double ManipLatticeActionSpace::jacobianRegionSize() const
+{
+    return m_jacobian_region_size;
+}
+
+double ManipLatticeActionSpace::snapJointDeltaThresh() const
+{
+    return m_snap_joint_delta_thresh;
+}
+
+/// \brief Enable prediction of end effector motion from cached jacobians.
+///
+/// When enabled, the end effector pose of each expanded state is predicted
+/// from a linearization of forward kinematics about the center of the region
+/// of joint space containing it, computed once per region, rather than from
+/// forward kinematics of the state itself. The prediction is used to compute
+/// the start and goal distances that activate adaptive motions, to order
+/// motion primitives by the predicted distance of their end effector to the
+/// goal position, and to skip IK for snap motions whose predicted joint motion
+/// leaves the joint limits or exceeds the snap joint delta threshold.
+void ManipLatticeActionSpace::useJacobianTables(bool enable)
+{
+    m_use_jacobian_tables = enable;
+}
+
+/// \brief Set the width, in radians, of the joint space regions for which
+///     jacobians are cached.
+void ManipLatticeActionSpace::jacobianRegionSize(double size)
+{
+    if (size > 0.0 && size != m_jacobian_region_size) {
+        m_jacobian_region_size = size;
+        m_jacobian_regions.clear();
+    }
+}
+
+/// \brief Set the largest predicted change of any joint variable for which
+///     IK is attempted for snap motions, when jacobian tables are enabled.
+void ManipLatticeActionSpace::snapJointDeltaThresh(double thresh)
+{
+    m_snap_joint_delta_thresh = thresh;
+}
+
 auto ManipLatticeActionSpace::getStartGoalDistances(const RobotState& state)
     -> std::pair<double, double>
 {
@@ -310,17 +364,16 @@ auto ManipLatticeActionSpace::getStartGoalDistances(const RobotState& state)
     }
 
     auto pose = m_fk_iface->computeFK(state);
+    return getStartGoalDistances(Vector3(pose.translation()));
+}
 
+auto ManipLatticeActionSpace::getStartGoalDistances(const Vector3& pos)
+    -> std::pair<double, double>
+{
     if (planningSpace()->numHeuristics() > 0) {
         RobotHeuristic* h = planningSpace()->heuristic(0);
-        double start_dist = h->getMetricStartDistance(
-                pose.translation()[0],
-                pose.translation()[1],
-                pose.translation()[2]);
-        double goal_dist = h->getMetricGoalDistance(
-                pose.translation()[0],
-                pose.translation()[1],
-                pose.translation()[2]);
+        double start_dist = h->getMetricStartDistance(pos[0], pos[1], pos[2]);
+        double goal_dist = h->getMetricGoalDistance(pos[0], pos[1], pos[2]);
         return std::make_pair(start_dist, goal_dist);
     } else {
         return std::make_pair(0.0, 0.0);
@@ -331,6 +384,10 @@ bool ManipLatticeActionSpace::apply(
     const RobotState& parent,
     std::vector<Action>& actions)
 {
+    if (m_use_jacobian_tables && m_fk_iface) {
+        return applyLinearized(parent, actions);
+    }
+
     double goal_dist, start_dist;
     std::tie(start_dist, goal_dist) = getStartGoalDistances(parent);
 
@@ -345,6 +402,221 @@ bool ManipLatticeActionSpace::apply(
     return true;
 }
 
+static bool IsSnapMotion(MotionPrimitive::Type type)
+{
+    return type == MotionPrimitive::SNAP_TO_RPY ||
+            type == MotionPrimitive::SNAP_TO_XYZ ||
+            type == MotionPrimitive::SNAP_TO_XYZ_RPY;
+}
+
+// The difference between two joint states, taking the shortest way around for
+// continuous joints
+static void StateDiff(
+    RobotModel* robot,
+    const RobotState& to,
+    const RobotState& from,
+    Eigen::VectorXd& diff)
+{
+    diff.resize(to.size());
+    for (size_t i = 0; i < to.size(); ++i) {
+        if (robot->isContinuous(i)) {
+            diff[i] = shortest_angle_diff(to[i], from[i]);
+        } else {
+            diff[i] = to[i] - from[i];
+        }
+    }
+}
+
+// The rotation vector taking rotation a to rotation b, in the world frame
+static auto RotationDiff(const Matrix3& b, const Matrix3& a) -> Vector3
+{
+    AngleAxis aa(b * a.transpose());
+    return aa.angle() * aa.axis();
+}
+
+// Generate the actions of a state, as in apply(), using the end effector pose
+// predicted from the jacobian of its region in place of forward kinematics.
+bool ManipLatticeActionSpace::applyLinearized(
+    const RobotState& parent,
+    std::vector<Action>& actions)
+{
+    auto* robot = planningSpace()->robot();
+    auto& region = getJacobianRegion(parent);
+
+    Eigen::VectorXd dq;
+    StateDiff(robot, parent, region.center, dq);
+    Eigen::Matrix<double, 6, 1> twist = region.jacobian * dq;
+
+    Affine3 pose = region.pose;
+    pose.translation() += twist.head<3>();
+    if (!twist.tail<3>().isZero()) {
+        pose.linear() =
+                AngleAxis(twist.tail<3>().norm(), twist.tail<3>().normalized()) *
+                region.pose.rotation();
+    }
+
+    double goal_dist, start_dist;
+    std::tie(start_dist, goal_dist) = getStartGoalDistances(Vector3(pose.translation()));
+
+    // order motion primitives by the predicted distance of the end effector
+    // to the goal position after applying them, keeping adaptive motions first
+    auto& goal = planningSpace()->goal();
+    const bool has_goal_position =
+            goal.type == GoalType::XYZ_GOAL || goal.type == GoalType::XYZ_RPY_GOAL;
+    m_mprim_order.resize(m_mprims.size());
+    for (size_t i = 0; i < m_mprims.size(); ++i) {
+        double key = 0.0;
+        if (IsSnapMotion(m_mprims[i].type)) {
+            key = -std::numeric_limits<double>::infinity();
+        } else if (has_goal_position) {
+            Vector3 p = pose.translation() + region.displacements.col(i);
+            key = (p - goal.pose.translation()).squaredNorm();
+        }
+        m_mprim_order[i] = std::make_pair(key, (int)i);
+    }
+    std::stable_sort(
+            m_mprim_order.begin(), m_mprim_order.end(),
+            [](const std::pair<double, int>& a, const std::pair<double, int>& b)
+            {
+                return a.first < b.first;
+            });
+
+    for (auto& entry : m_mprim_order) {
+        auto& prim = m_mprims[entry.second];
+        if (IsSnapMotion(prim.type) &&
+            mprimActive(start_dist, goal_dist, prim.type) &&
+            !snapPredictedFeasible(region, parent, pose, prim.type))
+        {
+            SMPL_DEBUG_NAMED(G_EXPANSIONS_LOG, "Skip snap motion of type %d predicted to be infeasible", (int)prim.type);
+            continue;
+        }
+        (void)getAction(parent, goal_dist, start_dist, prim, actions);
+    }
+
+    if (actions.empty()) {
+        SMPL_WARN_ONCE("No motion primitives specified");
+    }
+
+    return true;
+}
+
+// Return the linearization for the region of joint space containing the given
+// state, computing it on first use. The jacobian is computed by forward
+// differences of forward kinematics at the center of the region.
+auto ManipLatticeActionSpace::getJacobianRegion(const RobotState& state)
+    -> const JacobianRegion&
+{
+    auto* robot = planningSpace()->robot();
+
+    RobotCoord coord(state.size());
+    for (size_t i = 0; i < state.size(); ++i) {
+        auto value = robot->isContinuous(i) ? normalize_angle_positive(state[i]) : state[i];
+        coord[i] = (int)std::floor(value / m_jacobian_region_size);
+    }
+
+    auto it = m_jacobian_regions.find(coord);
+    if (it != m_jacobian_regions.end()) {
+        return it->second;
+    }
+
+    // bound the cache; regions are cheap to recompute relative to the number
+    // of expansions within them
+    const size_t max_regions = 1 << 16;
+    if (m_jacobian_regions.size() >= max_regions) {
+        m_jacobian_regions.clear();
+    }
+
+    JacobianRegion region;
+    region.center.resize(state.size());
+    for (size_t i = 0; i < state.size(); ++i) {
+        region.center[i] = ((double)coord[i] + 0.5) * m_jacobian_region_size;
+    }
+    // evaluate the center and each perturbed state in a single batch
+    const double h = 1.0e-6;
+    std::vector<RobotState> q(state.size() + 1, region.center);
+    for (size_t i = 0; i < state.size(); ++i) {
+        q[i + 1][i] += h;
+    }
+    std::vector<Affine3, Eigen::aligned_allocator<Affine3>> poses(q.size());
+    m_fk_iface->computeFKBatch(q.data(), (int)q.size(), poses.data());
+
+    region.pose = poses[0];
+    region.jacobian.resize(6, state.size());
+    for (size_t i = 0; i < state.size(); ++i) {
+        auto& pose = poses[i + 1];
+        region.jacobian.block<3, 1>(0, i) =
+                (pose.translation() - region.pose.translation()) / h;
+        region.jacobian.block<3, 1>(3, i) =
+                RotationDiff(pose.rotation(), region.pose.rotation()) / h;
+    }
+
+    region.displacements.setZero(3, m_mprims.size());
+    for (size_t i = 0; i < m_mprims.size(); ++i) {
+        auto& prim = m_mprims[i];
+        if (prim.action.empty() || prim.action.back().size() != state.size()) {
+            continue;
+        }
+        auto& delta = prim.action.back();
+        region.displacements.col(i) = region.jacobian.topRows<3>() *
+                Eigen::Map<const Eigen::VectorXd>(delta.data(), delta.size());
+    }
+
+    return m_jacobian_regions.emplace(std::move(coord), std::move(region)).first->second;
+}
+
+// Predict whether IK for a snap motion from the given state can succeed, using
+// the damped least-squares joint motion that reduces the predicted error
+// between the end effector and the goal. Snap motions that leave the joint
+// limits or move some joint by more than the snap joint delta threshold are
+// predicted to fail. The prediction is only as accurate as the linearization,
+// so the joint limits are relaxed by the region size.
+bool ManipLatticeActionSpace::snapPredictedFeasible(
+    const JacobianRegion& region,
+    const RobotState& state,
+    const Affine3& pose,
+    MotionPrimitive::Type type) const
+{
+    auto& goal = planningSpace()->goal();
+    if (type == MotionPrimitive::SNAP_TO_XYZ_RPY &&
+        goal.type == GoalType::JOINT_STATE_GOAL)
+    {
+        // no IK is computed
+        return true;
+    }
+
+    Eigen::Matrix<double, 6, 1> err;
+    err.head<3>() = goal.pose.translation() - pose.translation();
+    err.tail<3>() = RotationDiff(goal.pose.rotation(), pose.rotation());
+    if (type == MotionPrimitive::SNAP_TO_XYZ) {
+        err.tail<3>().setZero(); // orientation is held fixed
+    } else if (type == MotionPrimitive::SNAP_TO_RPY) {
+        err.head<3>().setZero(); // position is held fixed
+    }
+
+    const double damping = 1.0e-3;
+    auto& J = region.jacobian;
+    Eigen::Matrix<double, 6, 6> JJt = J * J.transpose();
+    JJt.diagonal().array() += damping * damping;
+    Eigen::VectorXd dq = J.transpose() * JJt.ldlt().solve(err);
+
+    auto* robot = planningSpace()->robot();
+    for (size_t i = 0; i < state.size(); ++i) {
+        if (std::fabs(dq[i]) > m_snap_joint_delta_thresh) {
+            return false;
+        }
+        if (robot->hasPosLimit(i)) {
+            auto value = state[i] + dq[i];
+            if (value < robot->minPosLimit(i) - m_jacobian_region_size ||
+                value > robot->maxPosLimit(i) + m_jacobian_region_size)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 bool ManipLatticeActionSpace::getAction(
     const RobotState& parent,
     double goal_dist,
@@ -37,19 +37,12 @@
 #include <smpl/console/nonstd.h>
 #include <smpl/csv_parser.h>
 #include <smpl/debug/visualize.h>
+#include <smpl/graph/experience_graph_file.h>
 #include <smpl/graph/manip_lattice_action_space.h>
 #include <smpl/heap/intrusive_heap.h>
 
 namespace smpl {
 
-auto ManipLatticeEgraph::RobotCoordHash::operator()(const argument_type& s) const ->
-    result_type
-{
-    std::size_t seed = 0;
-    boost::hash_combine(seed, boost::hash_range(s.begin(), s.end()));
-    return seed;
-}
-
 bool ManipLatticeEgraph::extractPath(
     const std::vector<int>& idpath,
     std::vector<RobotState>& path)
@@ -228,11 +221,17 @@ bool ManipLatticeEgraph::extractPath(
     return true;
 }
 
+/// Load an experience graph from either a directory of CSV files, one per
+/// demonstration, or a binary experience graph file (see ExperienceGraphFile).
 bool ManipLatticeEgraph::loadExperienceGraph(const std::string& path)
 {
     SMPL_INFO("Load Experience Graph at %s", path.c_str());
 
     boost::filesystem::path p(path);
+    if (boost::filesystem::is_regular_file(p) && IsExperienceGraphFile(path)) {
+        return loadExperienceGraphFile(path);
+    }
+
     if (!boost::filesystem::is_directory(p)) {
         SMPL_ERROR("'%s' is not a directory", path.c_str());
         return false;
@@ -257,18 +256,7 @@ bool ManipLatticeEgraph::loadExperienceGraph(const std::string& path)
         RobotCoord pdp(robot()->jointVariableCount()); // previous robot coord
         stateToCoord(egraph_states.front(), pdp);
 
-        auto pid = m_egraph.insert_node(pp);
-        m_coord_to_nodes[pdp].push_back(pid);
-
-        int entry_id = reserveHashEntry();
-        auto* entry = getHashEntry(entry_id);
-        entry->coord = pdp;
-        entry->state = pp;
-
-        // map state id <-> experience graph state
-        m_egraph_state_ids.resize(pid + 1, -1);
-        m_egraph_state_ids[pid] = entry_id;
-        m_state_to_node[entry_id] = pid;
+        auto pid = insertExperienceGraphNode(pp, pdp);
 
         std::vector<RobotState> edge_data;
         for (size_t i = 1; i < egraph_states.size(); ++i) {
@@ -277,18 +265,7 @@ bool ManipLatticeEgraph::loadExperienceGraph(const std::string& path)
             stateToCoord(p, dp);
             if (dp != pdp) {
                 // found a new discrete state along the path
-
-                auto id = m_egraph.insert_node(p);
-                m_coord_to_nodes[dp].push_back(id);
-
-                int entry_id = reserveHashEntry();
-                auto* entry = getHashEntry(entry_id);
-                entry->coord = dp;
-                entry->state = p;
-
-                m_egraph_state_ids.resize(id + 1, -1);
-                m_egraph_state_ids[id] = entry_id;
-                m_state_to_node[entry_id] = id;
+                auto id = insertExperienceGraphNode(p, dp);
                 m_egraph.insert_edge(pid, id, edge_data);
 
                 pdp = dp;
@@ -305,18 +282,64 @@ bool ManipLatticeEgraph::loadExperienceGraph(const std::string& path)
     return true;
 }
 
+/// Write the loaded experience graph to a new binary experience graph file,
+/// replacing any existing file at the path. Together with
+/// loadExperienceGraph(), this converts a directory of CSV demonstrations to
+/// the binary format.
+bool ManipLatticeEgraph::saveExperienceGraph(const std::string& filepath)
+{
+    std::vector<RobotCoord> coords(m_egraph.num_nodes());
+    for (size_t n = 0; n < coords.size(); ++n) {
+        coords[n] = getHashEntry(m_egraph_state_ids[n])->coord;
+    }
+
+    return CreateExperienceGraphFile(filepath, resolutions()) &&
+            AppendExperienceGraphFile(filepath, m_egraph, coords);
+}
+
+/// Save a demonstration. If the path names a binary experience graph file, the
+/// demonstration is appended to it as a new segment; otherwise, the path is
+/// taken as a directory and the demonstration is written to a new CSV file
+/// inside it.
 bool ManipLatticeEgraph::saveExperience(const std::string& filepath, const Action& experience)
 {
+    if (experience.empty()) {
+        return false;
+    }
+
+    if (IsExperienceGraphFile(filepath)) {
+        ExperienceGraph egraph;
+        std::vector<RobotCoord> coords;
+
+        RobotCoord pdp(robot()->jointVariableCount());
+        stateToCoord(experience.front(), pdp);
+        auto pid = egraph.insert_node(experience.front());
+        coords.push_back(pdp);
+
+        std::vector<RobotState> edge_data;
+        for (size_t i = 1; i < experience.size(); ++i) {
+            RobotCoord dp(robot()->jointVariableCount());
+            stateToCoord(experience[i], dp);
+            if (dp != pdp) {
+                auto id = egraph.insert_node(experience[i]);
+                coords.push_back(dp);
+                egraph.insert_edge(pid, id, edge_data);
+                pdp = dp;
+                pid = id;
+                edge_data.clear();
+            } else {
+                edge_data.push_back(experience[i]);
+            }
+        }
+
+        return AppendExperienceGraphFile(filepath, egraph, coords);
+    }
+
     RobotCoord start(experience.front().size());
     RobotCoord end(experience.front().size());
     stateToCoord(experience.front(), start);
     stateToCoord(experience.back(), end);
 
-    int nFiles = std::count_if(
-        boost::filesystem::directory_iterator(filepath),
-        boost::filesystem::directory_iterator(),
-        static_cast<bool(*)(const boost::filesystem::path&)>(boost::filesystem::is_regular_file) );
-
     std::stringstream filename;
     filename << "/" << start << "_to_" << end << ".csv";
 
@@ -333,9 +356,11 @@ bool ManipLatticeEgraph::saveExperience(const std::string& filepath, const Actio
             out << '\n';
         }
         out.close();
+        return !out.fail();
     }
     else {
         SMPL_INFO("Experience (%s) already exists. Not overwriting the file!", filename.str().c_str());
+        return true;
     }
 }
 
@@ -511,6 +536,82 @@ bool ManipLatticeEgraph::findShortestExperienceGraphPath(
     return false;
 }
 
+// Insert a node into the experience graph, along with a state entry for it
+auto ManipLatticeEgraph::insertExperienceGraphNode(
+    const RobotState& state,
+    const RobotCoord& coord)
+    -> ExperienceGraph::node_id
+{
+    auto id = m_egraph.insert_node(state);
+
+    int entry_id = reserveHashEntry();
+    auto* entry = getHashEntry(entry_id);
+    entry->coord = coord;
+    entry->state = state;
+
+    // map state id <-> experience graph state
+    m_egraph_state_ids.resize(id + 1, -1);
+    m_egraph_state_ids[id] = entry_id;
+    m_state_to_node[entry_id] = id;
+    return id;
+}
+
+// Load the segments of a binary experience graph file. The stored coordinates
+// are used only if they were computed at the resolutions of this lattice.
+bool ManipLatticeEgraph::loadExperienceGraphFile(const std::string& path)
+{
+    ExperienceGraphFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+
+    const int var_count = robot()->jointVariableCount();
+    if (file.variableCount() != var_count) {
+        SMPL_ERROR("Experience graph file contains %d joint variables; expected %d", file.variableCount(), var_count);
+        return false;
+    }
+
+    const bool use_coords = file.resolutions() == resolutions();
+    if (!use_coords) {
+        SMPL_WARN("Experience graph file resolutions differ from lattice resolutions; recomputing coordinates");
+    }
+
+    m_egraph_state_ids.reserve(m_egraph.num_nodes() + file.nodeCount());
+    m_state_to_node.reserve(m_egraph.num_nodes() + file.nodeCount());
+
+    RobotState state(var_count);
+    RobotCoord coord(var_count);
+    std::vector<RobotState> waypoints;
+    for (auto& segment : file.segments()) {
+        auto base = m_egraph.num_nodes();
+        for (std::uint32_t n = 0; n < segment.node_count; ++n) {
+            auto* s = segment.states + (size_t)n * var_count;
+            state.assign(s, s + var_count);
+            if (use_coords) {
+                auto* c = segment.coords + (size_t)n * var_count;
+                coord.assign(c, c + var_count);
+            } else {
+                stateToCoord(state, coord);
+            }
+            insertExperienceGraphNode(state, coord);
+        }
+
+        for (std::uint32_t e = 0; e < segment.edge_count; ++e) {
+            auto& edge = segment.edges[e];
+            waypoints.resize(edge.waypoint_count);
+            for (std::uint32_t i = 0; i < edge.waypoint_count; ++i) {
+                auto* w = segment.waypoints +
+                        (size_t)(edge.waypoint_offset + i) * var_count;
+                waypoints[i].assign(w, w + var_count);
+            }
+            m_egraph.insert_edge(base + edge.source, base + edge.target, waypoints);
+        }
+    }
+
+    SMPL_INFO("Experience graph contains %zu nodes and %zu edges", m_egraph.num_nodes(), m_egraph.num_edges());
+    return true;
+}
+
 bool ManipLatticeEgraph::parseExperienceGraphFile(
     const std::string& filepath,
     std::vector<RobotState>& egraph_states) const
@@ -31,6 +31,11 @@
 
 #include <smpl/graph/workspace_lattice_base.h>
 
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
 // project includes
 #include <smpl/angles.h>
 #include <smpl/console/console.h>
@@ -139,6 +144,25 @@ bool WorkspaceLatticeBase::init(
         SMPL_DEBUG_NAMED(G_LOG, "  J%d: { res: %f, count: %d }", i, m_res[6 + i], m_val_count[6 + i]);
     }
 
+    if (_params.ik_cache_seed_res <= 0.0) {
+        SMPL_WARN("IK cache seed resolution must be positive");
+        return false;
+    }
+
+    if (_params.ik_cache_position_tolerance < 0.0 ||
+        _params.ik_cache_orientation_tolerance < 0.0)
+    {
+        SMPL_WARN("IK cache tolerances must be non-negative");
+        return false;
+    }
+
+    m_ik_cache_capacity = (size_t)std::max(0, _params.ik_cache_size);
+    m_ik_cache_seed_res = _params.ik_cache_seed_res;
+    m_ik_cache_pos_tol = _params.ik_cache_position_tolerance;
+    m_ik_cache_rot_tol = _params.ik_cache_orientation_tolerance;
+    clearIKCache();
+    SMPL_DEBUG_NAMED(G_LOG, "  IK cache: { size: %zu, seed res: %f, position tolerance: %f, orientation tolerance: %f }", m_ik_cache_capacity, m_ik_cache_seed_res, m_ik_cache_pos_tol, m_ik_cache_rot_tol);
+
     return true;
 }
 
@@ -183,13 +207,7 @@ bool WorkspaceLatticeBase::stateWorkspaceToRobot(
         seed[m_fangle_indices[fai]] = state[6 + fai];
     }
 
-    Affine3 pose =
-            Translation3(state[0], state[1], state[2]) *
-            AngleAxis(state[5], Vector3::UnitZ()) *
-            AngleAxis(state[4], Vector3::UnitY()) *
-            AngleAxis(state[3], Vector3::UnitX());
-
-    return m_rm_iface->computeFastIK(pose, seed, ostate);
+    return computeCachedIK(state, seed, ostate);
 }
 
 void WorkspaceLatticeBase::stateWorkspaceToCoord(
@@ -223,6 +241,38 @@ bool WorkspaceLatticeBase::stateWorkspaceToRobot(
     const WorkspaceState& state,
     const RobotState& seed,
     RobotState& ostate) const
+{
+    // TODO: unrestricted variant?
+    return computeCachedIK(state, seed, ostate);
+}
+
+double WorkspaceLatticeBase::IKCacheStats::hitRate() const
+{
+    auto lookups = hits + misses;
+    if (lookups == 0) {
+        return 0.0;
+    }
+    return (double)hits / (double)lookups;
+}
+
+void WorkspaceLatticeBase::clearIKCache()
+{
+    if (m_ik_cache_stats.hits + m_ik_cache_stats.misses > 0) {
+        SMPL_DEBUG_NAMED(G_LOG, "IK cache: %llu hits, %llu misses, %llu evictions (hit rate = %0.3f)",
+                (unsigned long long)m_ik_cache_stats.hits,
+                (unsigned long long)m_ik_cache_stats.misses,
+                (unsigned long long)m_ik_cache_stats.evictions,
+                m_ik_cache_stats.hitRate());
+    }
+    m_ik_cache.clear();
+    m_ik_cache_lru.clear();
+    m_ik_cache_stats = IKCacheStats();
+}
+
+bool WorkspaceLatticeBase::computeCachedIK(
+    const WorkspaceState& state,
+    const RobotState& seed,
+    RobotState& ostate) const
 {
     Affine3 pose =
             Translation3(state[0], state[1], state[2]) *
@@ -230,8 +280,105 @@ bool WorkspaceLatticeBase::stateWorkspaceToRobot(
             AngleAxis(state[4], Vector3::UnitY()) *
             AngleAxis(state[3], Vector3::UnitX());
 
-    // TODO: unrestricted variant?
-    return m_rm_iface->computeFastIK(pose, seed, ostate);
+    if (m_ik_cache_capacity == 0) {
+        return m_rm_iface->computeFastIK(pose, seed, ostate);
+    }
+
+    WorkspaceCoord coord;
+    stateWorkspaceToCoord(state, coord);
+
+    std::vector<int> key(coord.begin(), coord.end());
+    key.reserve(coord.size() + seed.size());
+    for (auto& v : seed) {
+        key.push_back((int)std::floor(v / m_ik_cache_seed_res));
+    }
+
+    auto it = m_ik_cache.find(key);
+    if (it != end(m_ik_cache)) {
+        // move to the front of the recency list
+        m_ik_cache_lru.splice(begin(m_ik_cache_lru), m_ik_cache_lru, it->second);
+        if (cachedIKMatches(*it->second, state, pose, seed)) {
+            ++m_ik_cache_stats.hits;
+            if (it->second->valid) {
+                ostate = it->second->solution;
+            }
+            return it->second->valid;
+        }
+    }
+
+    ++m_ik_cache_stats.misses;
+
+    auto valid = m_rm_iface->computeFastIK(pose, seed, ostate);
+
+    if (it != end(m_ik_cache)) {
+        // replace the mismatched entry, already at the front of the list
+    } else if (m_ik_cache.size() >= m_ik_cache_capacity) {
+        // recycle the least recently used entry
+        auto lit = std::prev(end(m_ik_cache_lru));
+        m_ik_cache.erase(lit->key);
+        m_ik_cache_lru.splice(begin(m_ik_cache_lru), m_ik_cache_lru, lit);
+        ++m_ik_cache_stats.evictions;
+    } else {
+        m_ik_cache_lru.emplace_front();
+    }
+
+    auto& entry = m_ik_cache_lru.front();
+    entry.state = state;
+    entry.valid = valid;
+    if (valid) {
+        entry.solution = ostate;
+    } else {
+        entry.solution.clear();
+    }
+    if (it == end(m_ik_cache)) {
+        entry.key = std::move(key);
+        m_ik_cache.emplace(entry.key, begin(m_ik_cache_lru));
+    }
+
+    return valid;
+}
+
+// Return whether a cached result answers an inverse kinematics query for a
+// given workspace state (and its pose) and seed. A cached solution must reach
+// the requested pose and retain the redundant angles of the seed, as
+// computeFastIK would; a cached failure must have been recorded for the same
+// workspace state.
+bool WorkspaceLatticeBase::cachedIKMatches(
+    const IKCacheEntry& entry,
+    const WorkspaceState& state,
+    const Affine3& pose,
+    const RobotState& seed) const
+{
+    if (!entry.valid) {
+        for (size_t i = 0; i < 3; ++i) {
+            if (std::fabs(entry.state[i] - state[i]) > m_ik_cache_pos_tol) {
+                return false;
+            }
+        }
+        for (size_t i = 3; i < state.size(); ++i) {
+            if (angles::shortest_angle_dist(entry.state[i], state[i]) > m_ik_cache_rot_tol) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    for (size_t fai = 0; fai < freeAngleCount(); ++fai) {
+        auto vidx = m_fangle_indices[fai];
+        auto diff = m_fangle_continuous[fai] ?
+                angles::shortest_angle_dist(entry.solution[vidx], seed[vidx]) :
+                std::fabs(entry.solution[vidx] - seed[vidx]);
+        if (diff > m_ik_cache_rot_tol) {
+            return false;
+        }
+    }
+
+    auto fk_pose = m_fk_iface->computeFK(entry.solution);
+    if ((fk_pose.translation() - pose.translation()).norm() > m_ik_cache_pos_tol) {
+        return false;
+    }
+    AngleAxis rot_diff(pose.rotation().transpose() * fk_pose.rotation());
+    return std::fabs(rot_diff.angle()) <= m_ik_cache_rot_tol;
 }
 
 void WorkspaceLatticeBase::posWorkspaceToCoord(const double* wp, int* gp) const
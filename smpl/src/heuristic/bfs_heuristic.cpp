@@ -79,8 +79,18 @@ void BfsHeuristic::setCostPerCell(int cost_per_cell)
     m_cost_per_cell = cost_per_cell;
 }
 
+void BfsHeuristic::setLazySearchEnabled(bool enabled)
+{
+    m_lazy_search = enabled;
+}
+
 void BfsHeuristic::updateGoal(const GoalConstraint& goal)
 {
+    // pick up any changes to the world or inflation radius since the last goal
+    syncGridAndBfs();
+
+    m_goal_cells.clear();
+
     switch (goal.type) {
     case GoalType::XYZ_GOAL:
     case GoalType::XYZ_RPY_GOAL:
@@ -384,28 +394,33 @@ auto BfsHeuristic::getValuesVisualization() -> visual::Marker
             "bfs_values");
 }
 
+// Bring the walls up to date with the grid and inflation radius. The walls are
+// shared with other heuristics over the same grid. The bfs is moved onto the
+// current wall grid, and only rebuilt if the dimensions of the grid changed;
+// otherwise its distances are reset by the next run.
 void BfsHeuristic::syncGridAndBfs()
 {
-    const int xc = grid()->numCellsX();
-    const int yc = grid()->numCellsY();
-    const int zc = grid()->numCellsZ();
-//    SMPL_DEBUG_NAMED(LOG, "Initializing BFS of size %d x %d x %d = %d", xc, yc, zc, xc * yc * zc);
-    m_bfs.reset(new BFS_3D(xc, yc, zc));
-    const int cell_count = xc * yc * zc;
-    int wall_count = 0;
-    for (int x = 0; x < xc; ++x) {
-    for (int y = 0; y < yc; ++y) {
-    for (int z = 0; z < zc; ++z) {
-        const double radius = m_inflation_radius;
-        if (grid()->getDistance(x, y, z) <= radius) {
-            m_bfs->setWall(x, y, z);
-            ++wall_count;
-        }
+    if (!m_walls ||
+        m_walls->grid() != grid() ||
+        m_walls->gridId() != grid()->id() ||
+        m_walls->inflationRadius() != m_inflation_radius)
+    {
+        m_walls = BfsWalls::Get(grid(), m_inflation_radius);
     }
+
+    // stop any search still running over the walls before they are modified
+    if (m_bfs) {
+        m_bfs->cancel();
     }
+
+    m_walls->sync();
+
+    auto walls = m_walls->wallGrid();
+    if (!m_bfs || !m_bfs->setWallGrid(walls)) {
+        m_bfs.reset(new BFS_3D(walls));
     }
 
-    SMPL_DEBUG_NAMED(LOG, "%d/%d (%0.3f%%) walls in the bfs heuristic", wall_count, cell_count, 100.0 * (double)wall_count / cell_count);
+    m_bfs->setLazyEnabled(m_lazy_search);
 }
 
 int BfsHeuristic::getBfsCostToGoal(const BFS_3D& bfs, int x, int y, int z) const
@@ -0,0 +1,176 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/heuristic/bfs_walls.h>
+
+// standard includes
+#include <algorithm>
+#include <vector>
+
+// project includes
+#include <smpl/console/console.h>
+#include <smpl/occupancy_grid.h>
+
+namespace smpl {
+
+static const char* LOG = "heuristic.bfs_walls";
+
+static std::mutex g_walls_mutex;
+static std::vector<std::weak_ptr<BfsWalls>> g_walls;
+
+/// Return the walls for the given grid and inflation radius, shared with any
+/// other user of the same grid and radius. Grids are identified by their id as
+/// well as their address, so a grid allocated where a destroyed grid once was
+/// never receives its walls. The returned walls may be out of date with
+/// respect to the grid; call sync() before use.
+auto BfsWalls::Get(const OccupancyGrid* grid, double inflation_radius)
+    -> std::shared_ptr<BfsWalls>
+{
+    std::unique_lock<std::mutex> lock(g_walls_mutex);
+
+    // drop entries for walls no longer in use
+    g_walls.erase(
+            std::remove_if(begin(g_walls), end(g_walls),
+                    [](const std::weak_ptr<BfsWalls>& w) { return w.expired(); }),
+            end(g_walls));
+
+    for (auto& w : g_walls) {
+        auto walls = w.lock();
+        if (walls &&
+            walls->m_grid == grid &&
+            walls->m_grid_id == grid->id() &&
+            walls->m_inflation_radius == inflation_radius)
+        {
+            return walls;
+        }
+    }
+
+    auto walls = std::shared_ptr<BfsWalls>(new BfsWalls(grid, inflation_radius));
+    g_walls.push_back(walls);
+    return walls;
+}
+
+BfsWalls::BfsWalls(const OccupancyGrid* grid, double inflation_radius) :
+    m_grid(grid),
+    m_grid_id(grid->id()),
+    m_inflation_radius(inflation_radius),
+    m_walls(),
+    m_version(0),
+    m_synced(false),
+    m_mutex()
+{
+}
+
+auto BfsWalls::wallGrid() const -> std::shared_ptr<BfsWallGrid>
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_walls;
+}
+
+/// Bring the walls up to date with the occupancy grid. The wall grid is only
+/// modified in place if nothing else refers to it; otherwise, the changes are
+/// made to a copy, which replaces it.
+void BfsWalls::sync()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    const int xc = m_grid->numCellsX();
+    const int yc = m_grid->numCellsY();
+    const int zc = m_grid->numCellsZ();
+    if (!m_walls ||
+        m_walls->width() != xc ||
+        m_walls->height() != yc ||
+        m_walls->length() != zc)
+    {
+        m_walls = std::make_shared<BfsWallGrid>(xc, yc, zc);
+        m_synced = false;
+    }
+
+    if (m_synced && m_version == m_grid->version()) {
+        return;
+    }
+
+    int min_x, min_y, min_z, max_x, max_y, max_z;
+    if (!m_synced ||
+        !m_grid->getModifiedRegion(
+                m_version, min_x, min_y, min_z, max_x, max_y, max_z))
+    {
+        min_x = min_y = min_z = 0;
+        max_x = xc - 1;
+        max_y = yc - 1;
+        max_z = zc - 1;
+    }
+
+    // copy on write
+    if (m_walls.use_count() > 1) {
+        m_walls = std::make_shared<BfsWallGrid>(*m_walls);
+    }
+
+    int updated = updateWalls(min_x, min_y, min_z, max_x, max_y, max_z);
+
+    SMPL_DEBUG_NAMED(LOG, "Updated %d/%d cells of the bfs walls for inflation radius %f", updated, xc * yc * zc, m_inflation_radius);
+
+    m_version = m_grid->version();
+    m_synced = true;
+}
+
+// Recompute the walls within the inclusive range of cells [min, max], clamped
+// to the bounds of the grid, and return the number of cells visited. The loops
+// are ordered to match the layout of the wall grid.
+int BfsWalls::updateWalls(
+    int min_x, int min_y, int min_z,
+    int max_x, int max_y, int max_z)
+{
+    min_x = std::max(min_x, 0);
+    min_y = std::max(min_y, 0);
+    min_z = std::max(min_z, 0);
+    max_x = std::min(max_x, m_walls->width() - 1);
+    max_y = std::min(max_y, m_walls->height() - 1);
+    max_z = std::min(max_z, m_walls->length() - 1);
+
+    int count = 0;
+    for (int z = min_z; z <= max_z; ++z) {
+    for (int y = min_y; y <= max_y; ++y) {
+    for (int x = min_x; x <= max_x; ++x) {
+        const int node = m_walls->getNode(x, y, z);
+        if (m_grid->getDistance(x, y, z) <= m_inflation_radius) {
+            m_walls->setWall(node);
+        } else {
+            m_walls->unsetWall(node);
+        }
+        ++count;
+    }
+    }
+    }
+    return count;
+}
+
+} // namespace smpl
@@ -29,9 +29,16 @@
 
 /// \author Andrew Dornbush
 
+#include <smpl/heuristic/generic_egraph_heuristic.h>
+
+// standard includes
+#include <limits>
+
+// system includes
+#include <boost/functional/hash.hpp>
+
 // project includes
 #include <smpl/console/console.h>
-#include <smpl/heuristic/generic_egraph_heuristic.h>
 
 namespace smpl {
 
@@ -54,6 +61,8 @@ bool GenericEgraphHeuristic::init(RobotPlanningSpace* space, RobotHeuristic* h)
         SMPL_WARN_NAMED(LOG, "GenericEgraphHeuristic recommends ExperienceGraphExtension");
     }
 
+    m_ers = space->getExtension<ExtractRobotStateExtension>();
+
     return true;
 }
 
@@ -63,13 +72,52 @@ void GenericEgraphHeuristic::setWeightEGraph(double w)
     SMPL_INFO_NAMED(LOG, "egraph_epsilon: %0.3f", m_eg_eps);
 }
 
+/// Index the experience graph nodes by their states under the given metric, to
+/// answer heuristic lookups without visiting every node.
+///
+/// The metric must be a lower bound on the underlying heuristic, so that for
+/// any two states a and b, `GetFromToHeuristic(a, b) >= cost_scale * dist(a,
+/// b) - 1`; the slack of one allows for truncation to integer costs. Under
+/// that condition, lookups return the same values with or without the index.
+/// The index requires the planning space to provide the
+/// ExtractRobotStateExtension and is rebuilt on the first goal update after
+/// the experience graph changes. It is also used to prune the shortcut edges
+/// relaxed while computing the heuristic distances of the experience graph
+/// nodes for each goal. An empty distance function disables the index.
+void GenericEgraphHeuristic::setNodeMetric(
+    const StateDistanceFunction& dist,
+    double cost_scale)
+{
+    m_node_dist = dist;
+    m_node_cost_scale = cost_scale;
+    m_node_index = VPTree<RobotState, StateDistanceFunction>(dist);
+    m_node_index_valid = false;
+    m_preprocessed = false;
+}
+
 void GenericEgraphHeuristic::getEquivalentStates(
     int state_id,
     std::vector<int>& ids)
 {
     ExperienceGraph* eg = m_eg->getExperienceGraph();
-    auto nodes = eg->nodes();
     const int equiv_thresh = 100;
+
+    if (m_node_index_valid) {
+        // nodes within the threshold satisfy cost_scale * dist - 1 <= thresh
+        const RobotState& state = m_ers->extractState(state_id);
+        const double radius = (double)(equiv_thresh + 1) / m_node_cost_scale;
+        m_node_index.radiusSearch(state, radius, [&](int n, double d)
+        {
+            int egraph_state_id = m_eg->getStateID(n);
+            int h = m_orig_h->GetFromToHeuristic(state_id, egraph_state_id);
+            if (h <= equiv_thresh) {
+                ids.push_back(egraph_state_id);
+            }
+        });
+        return;
+    }
+
+    auto nodes = eg->nodes();
     for (auto nit = nodes.first; nit != nodes.second; ++nit) {
         int egraph_state_id = m_eg->getStateID(*nit);
         int h = m_orig_h->GetFromToHeuristic(state_id, egraph_state_id);
@@ -131,53 +179,29 @@ void GenericEgraphHeuristic::updateGoal(const GoalConstraint& goal)
         return;
     }
 
-    //////////////////////////////////////////////////////////
-    // Compute Connected Components of the Experience Graph //
-    //////////////////////////////////////////////////////////
+    updatePreprocessing(*eg);
 
-    SMPL_DEBUG("\tComputing connected components");
-    int comp_count = 0;
-    m_component_ids.assign(eg->num_nodes(), -1);
     auto nodes = eg->nodes();
-    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
-        if (m_component_ids[*nit] != -1) {
-            continue;
-        }
 
-        std::vector<ExperienceGraph::node_id> frontier;
-        frontier.push_back(*nit);
-        while (!frontier.empty()) {
-            ExperienceGraph::node_id n = frontier.back();
-            frontier.pop_back();
-
-            m_component_ids[n] = comp_count;
-
-            auto adj = eg->adjacent_nodes(n);
-            for (auto ait = adj.first; ait != adj.second; ++ait) {
-                if (m_component_ids[*ait] == -1) {
-                    frontier.push_back(*ait);
-                }
-            }
-        }
-
-        ++comp_count;
+    // the goal heuristic of each node is the only input to the searches below
+    // that depends on the goal
+    m_goal_h.resize(eg->num_nodes());
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        m_goal_h[*nit] = m_orig_h->GetGoalHeuristic(m_eg->getStateID(*nit));
     }
 
-    SMPL_INFO_NAMED(LOG, "Experience graph contains %d connected components", comp_count);
-
     ////////////////////////////
     // Compute Shortcut Nodes //
     ////////////////////////////
 
     SMPL_DEBUG("\tComputing shortcuts");
-    m_shortcut_nodes.assign(comp_count, std::vector<ExperienceGraph::node_id>());
-    std::vector<int> shortcut_heuristics(comp_count);
+    m_shortcut_nodes.assign(m_comp_count, std::vector<ExperienceGraph::node_id>());
+    std::vector<int> shortcut_heuristics(m_comp_count);
     for (auto nit = nodes.first; nit != nodes.second; ++nit) {
         const ExperienceGraph::node_id n = *nit;
         const int comp_id = m_component_ids[n];
-        const int state_id = m_eg->getStateID(n);
 
-        int h = m_orig_h->GetGoalHeuristic(state_id);
+        int h = m_goal_h[n];
 
         if (m_shortcut_nodes[comp_id].empty()) {
             m_shortcut_nodes[comp_id].push_back(n);
@@ -215,11 +239,18 @@ void GenericEgraphHeuristic::updateGoal(const GoalConstraint& goal)
             for (auto nit = nodes.first; nit != nodes.second; ++nit) {
                 const ExperienceGraph::node_id nid = *nit;
                 HeuristicNode* n = &m_h_nodes[nid + 1];
-                const int state_id = m_eg->getStateID(nid);
-                const int h = m_orig_h->GetGoalHeuristic(state_id);
-                n->dist = (int)(m_eg_eps * h);
+                n->dist = (int)(m_eg_eps * m_goal_h[nid]);
                 m_open.push(n);
             }
+            if (m_node_index_valid) {
+                std::vector<double> offsets(eg->num_nodes());
+                for (size_t n = 0; n < offsets.size(); ++n) {
+                    offsets[n] = -(double)m_h_nodes[n + 1].dist;
+                }
+                m_node_index.setOffsets(offsets);
+            }
+        } else if (m_node_index_valid) {
+            expandIndexed(*eg, s);
         } else {
             // neighbors: inflated edges to all non-adjacent experience graph
             // states original cost edges to all adjacent experience graph
@@ -256,6 +287,8 @@ void GenericEgraphHeuristic::updateGoal(const GoalConstraint& goal)
             }
         }
     }
+
+    updateNodeOffsets();
 }
 
 int GenericEgraphHeuristic::GetGoalHeuristic(int state_id)
@@ -270,6 +303,29 @@ int GenericEgraphHeuristic::GetGoalHeuristic(int state_id)
     }
 
     int best_h = (int)(m_eg_eps * m_orig_h->GetGoalHeuristic(state_id));
+
+    if (m_node_index_valid) {
+        // the index prunes nodes using a lower bound on dist + eps * h, with
+        // the node offsets set in updateNodeIndex
+        const RobotState& state = m_ers->extractState(state_id);
+        m_node_index.boundedSearch(
+                state,
+                m_eg_eps * m_node_cost_scale,
+                (double)best_h,
+                [&](int n, double d)
+                {
+                    const int egraph_state_id = m_eg->getStateID(n);
+                    const int h = m_orig_h->GetFromToHeuristic(state_id, egraph_state_id);
+                    const int dist = m_h_nodes[n + 1].dist;
+                    const int new_h = dist + (int)(m_eg_eps * h);
+                    if (new_h < best_h) {
+                        best_h = new_h;
+                    }
+                    return (double)best_h;
+                });
+        return best_h;
+    }
+
     auto nodes = eg->nodes();
     for (auto nit = nodes.first; nit != nodes.second; ++nit) {
         const int egraph_state_id = m_eg->getStateID(*nit);
@@ -284,6 +340,172 @@ int GenericEgraphHeuristic::GetGoalHeuristic(int state_id)
     return best_h;
 }
 
+// Compute a fingerprint of the node states and adjacency of the experience
+// graph, to detect when the goal-independent data must be recomputed.
+static auto HashExperienceGraph(const ExperienceGraph& eg) -> std::size_t
+{
+    std::size_t seed = 0;
+    boost::hash_combine(seed, eg.num_nodes());
+    boost::hash_combine(seed, eg.num_edges());
+    auto nodes = eg.nodes();
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        const RobotState& state = eg.state(*nit);
+        boost::hash_range(seed, begin(state), end(state));
+        auto adj = eg.adjacent_nodes(*nit);
+        boost::hash_range(seed, adj.first, adj.second);
+    }
+    return seed;
+}
+
+// Compute the data that depends only on the experience graph, and not on the
+// goal: the connected components of the graph and the metric index over its
+// nodes. These are kept until the experience graph changes.
+void GenericEgraphHeuristic::updatePreprocessing(const ExperienceGraph& eg)
+{
+    const std::size_t hash = HashExperienceGraph(eg);
+    if (m_preprocessed && hash == m_eg_hash) {
+        return;
+    }
+
+    //////////////////////////////////////////////////////////
+    // Compute Connected Components of the Experience Graph //
+    //////////////////////////////////////////////////////////
+
+    SMPL_DEBUG("\tComputing connected components");
+    int comp_count = 0;
+    m_component_ids.assign(eg.num_nodes(), -1);
+    auto nodes = eg.nodes();
+    for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+        if (m_component_ids[*nit] != -1) {
+            continue;
+        }
+
+        std::vector<ExperienceGraph::node_id> frontier;
+        frontier.push_back(*nit);
+        while (!frontier.empty()) {
+            ExperienceGraph::node_id n = frontier.back();
+            frontier.pop_back();
+
+            m_component_ids[n] = comp_count;
+
+            auto adj = eg.adjacent_nodes(n);
+            for (auto ait = adj.first; ait != adj.second; ++ait) {
+                if (m_component_ids[*ait] == -1) {
+                    frontier.push_back(*ait);
+                }
+            }
+        }
+
+        ++comp_count;
+    }
+    m_comp_count = comp_count;
+
+    SMPL_INFO_NAMED(LOG, "Experience graph contains %d connected components", comp_count);
+
+    ////////////////////////////////////////
+    // Index Experience Graph Node States //
+    ////////////////////////////////////////
+
+    m_node_index_valid = false;
+    if (m_node_dist && m_ers && m_node_cost_scale > 0.0) {
+        std::vector<RobotState> states;
+        states.reserve(eg.num_nodes());
+        for (auto nit = nodes.first; nit != nodes.second; ++nit) {
+            states.push_back(eg.state(*nit));
+        }
+        m_node_index.build(begin(states), end(states));
+        m_node_index_valid = true;
+
+        SMPL_DEBUG_NAMED(LOG, "Indexed %zu experience graph nodes", states.size());
+    }
+
+    m_eg_hash = hash;
+    m_preprocessed = true;
+}
+
+// Relax the edges out of an experience graph node removed from the open list,
+// using the metric index to skip the shortcut edges that cannot improve the
+// distance of their target. During the search, the offset of each node in the
+// index is its negated tentative distance, or infinity once it is closed. With
+// h >= cost_scale * d - 1, the cost of a shortcut edge, (int)(eps * h), is
+// greater than eps * cost_scale * d - eps - 1, so the shortcut from s to n
+// can only improve the distance of n if
+// -dist(n) + eps * cost_scale * d < eps + 1 - dist(s).
+void GenericEgraphHeuristic::expandIndexed(
+    const ExperienceGraph& eg,
+    HeuristicNode* s)
+{
+    const ExperienceGraph::node_id sid = std::distance(m_h_nodes.data(), s) - 1;
+    const int s_state_id = m_eg->getStateID(sid);
+
+    m_node_index.setOffset(sid, std::numeric_limits<double>::infinity());
+
+    auto relax = [&](ExperienceGraph::node_id nid, int new_cost)
+    {
+        HeuristicNode* n = &m_h_nodes[nid + 1];
+        if (new_cost < n->dist) {
+            n->dist = new_cost;
+            if (m_open.contains(n)) {
+                m_open.decrease(n);
+            } else {
+                m_open.push(n);
+            }
+            m_node_index.setOffset(nid, -(double)new_cost);
+        }
+    };
+
+    // neighbors: original cost edges to all adjacent experience graph states
+    auto adj = eg.adjacent_nodes(sid);
+    for (auto ait = adj.first; ait != adj.second; ++ait) {
+        const int edge_cost = 10;
+        relax(*ait, s->dist + edge_cost);
+    }
+
+    // neighbors: inflated edges to all non-adjacent experience graph states;
+    // collect the improvements first, since relaxing them updates the offsets
+    // of the index
+    m_relaxed.clear();
+    m_node_index.boundedSearch(
+            eg.state(sid),
+            m_eg_eps * m_node_cost_scale,
+            m_eg_eps + 1.0 - (double)s->dist,
+            [&](int nid, double d)
+            {
+                const double bound = m_eg_eps + 1.0 - (double)s->dist;
+                if (eg.edge(sid, nid)) {
+                    return bound;
+                }
+                const int n_state_id = m_eg->getStateID(nid);
+                const int h = m_orig_h->GetFromToHeuristic(s_state_id, n_state_id);
+                const int new_cost = s->dist + (int)(m_eg_eps * h);
+                if (new_cost < m_h_nodes[nid + 1].dist) {
+                    m_relaxed.emplace_back(nid, new_cost);
+                }
+                return bound;
+            });
+
+    for (auto& r : m_relaxed) {
+        relax(r.first, r.second);
+    }
+}
+
+// Set each node's offset in the metric index to a lower bound on its
+// contribution to the goal heuristic, less the distance term. With
+// h >= cost_scale * d - 1, a node's contribution, dist + (int)(eps * h), is at
+// least dist - eps - 1 + eps * cost_scale * d.
+void GenericEgraphHeuristic::updateNodeOffsets()
+{
+    if (!m_node_index_valid) {
+        return;
+    }
+
+    std::vector<double> offsets(m_node_index.size());
+    for (size_t n = 0; n < offsets.size(); ++n) {
+        offsets[n] = (double)m_h_nodes[n + 1].dist - m_eg_eps - 1.0;
+    }
+    m_node_index.setOffsets(offsets);
+}
+
 int GenericEgraphHeuristic::GetStartHeuristic(int state_id)
 {
     return 0;
@@ -96,6 +96,11 @@ void MultiFrameBfsHeuristic::setCostPerCell(int cost)
     m_cost_per_cell = cost;
 }
 
+void MultiFrameBfsHeuristic::setLazySearchEnabled(bool enabled)
+{
+    m_lazy_search = enabled;
+}
+
 Extension* MultiFrameBfsHeuristic::getExtension(size_t class_code)
 {
     if (class_code == GetClassCode<RobotHeuristic>()) {
@@ -108,6 +113,9 @@ void MultiFrameBfsHeuristic::updateGoal(const GoalConstraint& goal)
 {
     SMPL_DEBUG_NAMED(LOG, "Update goal");
 
+    // pick up any changes to the world or inflation radius since the last goal
+    syncGridAndBfs();
+
     Affine3 offset_pose =
             goal.pose *
             Translation3(m_pos_offset[0], m_pos_offset[1], m_pos_offset[2]);
@@ -333,29 +341,40 @@ int MultiFrameBfsHeuristic::getGoalHeuristic(int state_id, bool use_ee) const
     return combine_costs(h_planning_frame, h_planning_link);
 }
 
+// Bring the walls up to date with the grid and inflation radius. Both searches
+// run over the same wall grid, which is also shared with other heuristics over
+// the same grid.
 void MultiFrameBfsHeuristic::syncGridAndBfs()
 {
-    const int xc = grid()->numCellsX();
-    const int yc = grid()->numCellsY();
-    const int zc = grid()->numCellsZ();
-    m_bfs.reset(new BFS_3D(xc, yc, zc));
-    m_ee_bfs.reset(new BFS_3D(xc, yc, zc));
-    const int cell_count = xc * yc * zc;
-    int wall_count = 0;
-    for (int z = 0; z < zc; ++z) {
-    for (int y = 0; y < yc; ++y) {
-    for (int x = 0; x < xc; ++x) {
-        const double radius = m_inflation_radius;
-        if (grid()->getDistance(x, y, z) <= radius) {
-            m_bfs->setWall(x, y, z);
-            m_ee_bfs->setWall(x, y, z);
-            ++wall_count;
-        }
+    if (!m_walls ||
+        m_walls->grid() != grid() ||
+        m_walls->gridId() != grid()->id() ||
+        m_walls->inflationRadius() != m_inflation_radius)
+    {
+        m_walls = BfsWalls::Get(grid(), m_inflation_radius);
+    }
+
+    // stop any searches still running over the walls before they are modified
+    if (m_bfs) {
+        m_bfs->cancel();
     }
+    if (m_ee_bfs) {
+        m_ee_bfs->cancel();
     }
+
+    m_walls->sync();
+
+    auto walls = m_walls->wallGrid();
+    if (!m_bfs ||
+        !m_bfs->setWallGrid(walls) ||
+        !m_ee_bfs->setWallGrid(walls))
+    {
+        m_bfs.reset(new BFS_3D(walls));
+        m_ee_bfs.reset(new BFS_3D(walls));
     }
 
-    SMPL_DEBUG_NAMED(LOG, "%d/%d (%0.3f%%) walls in the bfs heuristic", wall_count, cell_count, 100.0 * (double)wall_count / cell_count);
+    m_bfs->setLazyEnabled(m_lazy_search);
+    m_ee_bfs->setLazyEnabled(m_lazy_search);
 }
 
 int MultiFrameBfsHeuristic::getBfsCostToGoal(
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/ik/analytic_ik_solver.h>
+
+// standard includes
+#include <cmath>
+
+// project includes
+#include <smpl/console/console.h>
+#include <smpl/ik/opw_ik_solver.h>
+
+namespace smpl {
+
+AnalyticIKSolver::~AnalyticIKSolver() { }
+
+bool WrapAngleToLimits(double& angle, double min, double max)
+{
+    if (!std::isfinite(angle)) {
+        return false;
+    }
+    angle = min + std::fmod(std::fmod(angle - min, 2.0 * M_PI) + 2.0 * M_PI, 2.0 * M_PI);
+    return angle <= max;
+}
+
+auto MakeAnalyticIKSolver(const std::string& name, const std::string& params)
+    -> std::unique_ptr<AnalyticIKSolver>
+{
+    if (name == "opw") {
+        OPWParameters opw_params;
+        if (!ParseOPWParameters(params, opw_params)) {
+            SMPL_ERROR("Malformed OPW IK solver parameters '%s'", params.c_str());
+            return NULL;
+        }
+        return std::unique_ptr<AnalyticIKSolver>(new OPWIKSolver(opw_params));
+    }
+
+    SMPL_ERROR("Unrecognized analytic IK solver '%s'", name.c_str());
+    return NULL;
+}
+
+} // namespace smpl
@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/ik/opw_ik_solver.h>
+
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace smpl {
+
+bool ParseOPWParameters(const std::string& s, OPWParameters& params)
+{
+    OPWParameters p;
+    std::istringstream ss(s);
+    if (!(ss >> p.a1 >> p.a2 >> p.b >> p.c1 >> p.c2 >> p.c3 >> p.c4)) {
+        return false;
+    }
+
+    if (ss >> p.offsets[0]) {
+        for (int i = 1; i < 6; ++i) {
+            if (!(ss >> p.offsets[i])) {
+                return false;
+            }
+        }
+        if (ss >> p.sign_corrections[0]) {
+            for (int i = 1; i < 6; ++i) {
+                if (!(ss >> p.sign_corrections[i])) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    // reject trailing garbage and sign corrections other than +/-1
+    ss >> std::ws;
+    if (!ss.eof()) {
+        return false;
+    }
+    for (int i = 0; i < 6; ++i) {
+        if (p.sign_corrections[i] != 1 && p.sign_corrections[i] != -1) {
+            return false;
+        }
+    }
+
+    params = p;
+    return true;
+}
+
+OPWIKSolver::OPWIKSolver(const OPWParameters& params) : m_params(params)
+{
+}
+
+auto OPWIKSolver::computeFK(const RobotState& state) const -> Affine3
+{
+    auto& p = m_params;
+
+    double q[6];
+    for (int i = 0; i < 6; ++i) {
+        q[i] = state[i] * p.sign_corrections[i] - p.offsets[i];
+    }
+
+    return Affine3(
+            AngleAxis(q[0], Vector3::UnitZ()) *
+            Translation3(p.a1, p.b, p.c1) *
+            AngleAxis(q[1], Vector3::UnitY()) *
+            Translation3(0.0, 0.0, p.c2) *
+            AngleAxis(q[2], Vector3::UnitY()) *
+            Translation3(p.a2, 0.0, p.c3) *
+            AngleAxis(q[3], Vector3::UnitZ()) *
+            AngleAxis(q[4], Vector3::UnitY()) *
+            AngleAxis(q[5], Vector3::UnitZ()) *
+            Translation3(0.0, 0.0, p.c4));
+}
+
+int OPWIKSolver::computeIKBatch(
+    const Affine3& pose,
+    double free_value,
+    std::vector<RobotState>& solutions)
+{
+    auto& p = m_params;
+    auto& R = pose.linear();
+
+    // wrist center
+    Vector3 c = pose.translation() - p.c4 * R.col(2);
+
+    // position of the wrist center relative to the shoulder, measured in the
+    // plane of links 2 and 3, for the front (i) and back (ii) shoulder
+    auto nx1 = std::sqrt(c.x() * c.x() + c.y() * c.y() - p.b * p.b) - p.a1;
+
+    auto tmp1 = std::atan2(c.y(), c.x());
+    auto tmp2 = std::atan2(p.b, nx1 + p.a1);
+    double theta1[2] = { tmp1 - tmp2, tmp1 + tmp2 - M_PI };
+
+    auto tmp3 = c.z() - p.c1;
+    auto s1_2 = nx1 * nx1 + tmp3 * tmp3;
+    auto tmp4 = nx1 + 2.0 * p.a1;
+    auto s2_2 = tmp4 * tmp4 + tmp3 * tmp3;
+    auto kappa_2 = p.a2 * p.a2 + p.c3 * p.c3;
+    auto c2_2 = p.c2 * p.c2;
+    auto s1 = std::sqrt(s1_2);
+    auto s2 = std::sqrt(s2_2);
+    auto psi3 = std::atan2(p.a2, p.c3);
+
+    // acos of the law of cosines for each shoulder; NaN marks an elbow that
+    // cannot reach the wrist center
+    auto t2f = std::acos((s1_2 + c2_2 - kappa_2) / (2.0 * s1 * p.c2));
+    auto t2b = std::acos((s2_2 + c2_2 - kappa_2) / (2.0 * s2 * p.c2));
+    auto t3f = std::acos((s1_2 - c2_2 - kappa_2) / (2.0 * p.c2 * std::sqrt(kappa_2)));
+    auto t3b = std::acos((s2_2 - c2_2 - kappa_2) / (2.0 * p.c2 * std::sqrt(kappa_2)));
+
+    auto af = std::atan2(nx1, tmp3);
+    auto ab = std::atan2(tmp4, tmp3);
+
+    // shoulder/elbow branches: (theta1, theta2, theta3)
+    double arm[4][3] = {
+        { theta1[0], -t2f + af,  t3f - psi3 },
+        { theta1[0],  t2f + af, -t3f - psi3 },
+        { theta1[1], -t2b - ab,  t3b - psi3 },
+        { theta1[1],  t2b - ab, -t3b - psi3 },
+    };
+
+    auto count = 0;
+    for (int i = 0; i < 4; ++i) {
+        auto q1 = arm[i][0];
+        auto q2 = arm[i][1];
+        auto q3 = arm[i][2];
+        if (std::isnan(q1) || std::isnan(q2) || std::isnan(q3)) {
+            continue;
+        }
+
+        auto sin1 = std::sin(q1);
+        auto cos1 = std::cos(q1);
+        auto s23 = std::sin(q2 + q3);
+        auto c23 = std::cos(q2 + q3);
+
+        // orientation of the wrist relative to the forearm, as zyz euler
+        // angles; the two wrist branches differ by the sign of theta5
+        auto m = R(0, 2) * s23 * cos1 + R(1, 2) * s23 * sin1 + R(2, 2) * c23;
+        auto q5 = std::atan2(std::sqrt(std::max(0.0, 1.0 - m * m)), m);
+
+        auto q4 = std::atan2(
+                R(1, 2) * cos1 - R(0, 2) * sin1,
+                R(0, 2) * c23 * cos1 + R(1, 2) * c23 * sin1 - R(2, 2) * s23);
+
+        auto q6 = std::atan2(
+                R(0, 1) * s23 * cos1 + R(1, 1) * s23 * sin1 + R(2, 1) * c23,
+                -R(0, 0) * s23 * cos1 - R(1, 0) * s23 * sin1 - R(2, 0) * c23);
+
+        double wrist[2][3] = {
+            { q4,  q5, q6 },
+            { q4 + M_PI, -q5, q6 - M_PI },
+        };
+
+        for (int j = 0; j < 2; ++j) {
+            double q[6] = { q1, q2, q3, wrist[j][0], wrist[j][1], wrist[j][2] };
+            RobotState solution(6);
+            for (int k = 0; k < 6; ++k) {
+                solution[k] = (q[k] + p.offsets[k]) * p.sign_corrections[k];
+            }
+            solutions.push_back(std::move(solution));
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+} // namespace smpl
@@ -33,6 +33,9 @@
 #include <smpl/occupancy_grid.h>
 
 // standard includes
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <memory>
 
 // project includes
@@ -67,6 +70,25 @@ namespace smpl {
 /// An arbitrary distance map implementation may be used with this class. If
 /// none is specified, by calling the verbose constructor, an instance of
 /// smpl::EuclidDistanceMap is constructed.
+///
+/// Optionally, the occupancy grid may maintain a smpl::DistancePyramid of
+/// coarse lower-bound distances over the distance map, which is updated
+/// alongside the distance map by all modifiers. As with reference counting,
+/// the caller must not directly modify a distance map with an enabled pyramid.
+///
+/// Every modification increments the grid's version and records a bounding
+/// box of the cells whose distances may have changed, so that structures
+/// derived from the distance field may be refreshed incrementally. See
+/// version() and getModifiedRegion().
+
+// number of modifications for which a modified region is retained
+static const size_t MAX_MODIFIED_REGIONS = 32;
+
+auto OccupancyGrid::NextId() -> std::uint64_t
+{
+    static std::atomic<std::uint64_t> next_id(1);
+    return next_id++;
+}
 
 OccupancyGrid::OccupancyGrid()
 {
@@ -135,27 +157,46 @@ OccupancyGrid::OccupancyGrid(
 /// contents of \p o.
 OccupancyGrid::OccupancyGrid(const OccupancyGrid& o) :
     m_grid(o.m_grid->clone()),
+    m_pyramid(),
     reference_frame_(o.reference_frame_),
     m_ref_counted(o.m_ref_counted),
     m_x_stride(o.m_x_stride),
     m_y_stride(o.m_y_stride),
-    m_counts(o.m_counts)
+    m_counts(o.m_counts),
+    m_version(o.m_version),
+    m_modified(o.m_modified)
 {
+    setDistancePyramidEnabled((bool)o.m_pyramid);
 }
 
 OccupancyGrid& OccupancyGrid::operator=(const OccupancyGrid& rhs)
 {
     if (this != &rhs) {
         m_grid.reset(rhs.m_grid->clone());
+        m_pyramid.reset();
         reference_frame_ = rhs.reference_frame_;
         m_ref_counted = rhs.m_ref_counted;
         m_x_stride = rhs.m_x_stride;
         m_y_stride = rhs.m_y_stride;
         m_counts = rhs.m_counts;
+        setDistancePyramidEnabled((bool)rhs.m_pyramid);
+        recordReset();
     }
     return *this;
 }
 
+/// Enable or disable maintenance of a coarse distance pyramid over the
+/// distance field. Enabling the pyramid computes all of its levels from the
+/// current contents of the distance field.
+void OccupancyGrid::setDistancePyramidEnabled(bool enabled)
+{
+    if (enabled && !m_pyramid) {
+        m_pyramid.reset(new DistancePyramid(m_grid.get()));
+    } else if (!enabled) {
+        m_pyramid.reset();
+    }
+}
+
 /// Reset the grid, removing all obstacles setting distances to their
 /// uninitialized values.
 void OccupancyGrid::reset()
@@ -164,6 +205,45 @@ void OccupancyGrid::reset()
     if (m_ref_counted) {
         m_counts.assign(getCellCount(), 0);
     }
+    if (m_pyramid) {
+        m_pyramid->update();
+    }
+    recordReset();
+}
+
+/// Return the bounding box of the cells whose distances may have changed since
+/// the grid was at the given version.
+///
+/// The box is inclusive and may extend past the bounds of the grid. It is
+/// empty (min > max) if the grid has not changed. Returns false if the grid
+/// has been reset or assigned, or if too many modifications have been made to
+/// recover the region, since that version, in which case the entire grid
+/// should be considered modified.
+bool OccupancyGrid::getModifiedRegion(
+    std::uint64_t since_version,
+    int& min_x, int& min_y, int& min_z,
+    int& max_x, int& max_y, int& max_z) const
+{
+    if (since_version > m_version ||
+        m_version - since_version > m_modified.size())
+    {
+        return false;
+    }
+
+    min_x = min_y = min_z = std::numeric_limits<int>::max();
+    max_x = max_y = max_z = std::numeric_limits<int>::lowest();
+    for (auto it = m_modified.rbegin(); it != m_modified.rend(); ++it) {
+        if (it->version <= since_version) {
+            break;
+        }
+        min_x = std::min(min_x, it->min_x);
+        min_y = std::min(min_y, it->min_y);
+        min_z = std::min(min_z, it->min_z);
+        max_x = std::max(max_x, it->max_x);
+        max_y = std::max(max_y, it->max_y);
+        max_z = std::max(max_z, it->max_z);
+    }
+    return true;
 }
 
 /// Count the number of obstacles in the occupancy grid.
@@ -379,9 +459,17 @@ void OccupancyGrid::addPointsToField(
             }
         }
         m_grid->addPointsToMap(pts);
+        if (m_pyramid) {
+            m_pyramid->update(pts);
+        }
+        recordModification(pts);
     }
     else {
         m_grid->addPointsToMap(points);
+        if (m_pyramid) {
+            m_pyramid->update(points);
+        }
+        recordModification(points);
     }
 }
 
@@ -408,9 +496,17 @@ void OccupancyGrid::removePointsFromField(
             }
         }
         m_grid->removePointsFromMap(pts);
+        if (m_pyramid) {
+            m_pyramid->update(pts);
+        }
+        recordModification(pts);
     }
     else {
         m_grid->removePointsFromMap(points);
+        if (m_pyramid) {
+            m_pyramid->update(points);
+        }
+        recordModification(points);
     }
 }
 
@@ -423,6 +519,57 @@ void OccupancyGrid::updatePointsInField(
 {
     // TODO: ref counting
     m_grid->updatePointsInMap(old_points, new_points);
+    if (m_pyramid) {
+        m_pyramid->update(old_points);
+        m_pyramid->update(new_points);
+    }
+    recordModification(old_points);
+    recordModification(new_points);
+}
+
+/// Record a new version of the grid in which the distances of cells within the
+/// propagation distance of any of the given points may have changed.
+void OccupancyGrid::recordModification(const std::vector<Vector3>& points)
+{
+    if (points.empty()) {
+        return;
+    }
+
+    ModifiedRegion region;
+    region.min_x = region.min_y = region.min_z = std::numeric_limits<int>::max();
+    region.max_x = region.max_y = region.max_z = std::numeric_limits<int>::lowest();
+    for (const Vector3& p : points) {
+        int gx, gy, gz;
+        worldToGrid(p.x(), p.y(), p.z(), gx, gy, gz);
+        region.min_x = std::min(region.min_x, gx);
+        region.min_y = std::min(region.min_y, gy);
+        region.min_z = std::min(region.min_z, gz);
+        region.max_x = std::max(region.max_x, gx);
+        region.max_y = std::max(region.max_y, gy);
+        region.max_z = std::max(region.max_z, gz);
+    }
+
+    const int inflation = (int)std::ceil(
+            m_grid->getUninitializedDistance() / m_grid->resolution()) + 1;
+    region.min_x -= inflation;
+    region.min_y -= inflation;
+    region.min_z -= inflation;
+    region.max_x += inflation;
+    region.max_y += inflation;
+    region.max_z += inflation;
+
+    region.version = ++m_version;
+    m_modified.push_back(region);
+    if (m_modified.size() > MAX_MODIFIED_REGIONS) {
+        m_modified.pop_front();
+    }
+}
+
+/// Record a new version of the grid in which any cell may have changed.
+void OccupancyGrid::recordReset()
+{
+    ++m_version;
+    m_modified.clear();
 }
 
 void OccupancyGrid::initRefCounts()
@@ -33,6 +33,7 @@
 #include <smpl/planning_params.h>
 
 // standard includes
+#include <limits>
 #include <sstream>
 
 // system includes
@@ -62,6 +63,12 @@ PlanningParams::PlanningParams() :
     shortcut_path(DefaultShortcutPath),
     interpolate_path(DefaultInterpolatePath),
     shortcut_type(DefaultShortcutType),
+    shortcut_thread_count(DefaultShortcutThreadCount),
+    shortcut_time_limit(DefaultShortcutTimeLimit),
+    time_parameterize_path(DefaultTimeParameterizePath),
+    time_parameterization_time_limit(DefaultTimeParameterizationTimeLimit),
+    optimize_path_clearance(DefaultOptimizePathClearance),
+    clearance_margin(DefaultClearanceMargin),
 
     m_warn_defaults(false)
 {
@@ -251,4 +258,133 @@ void PlanningParams::convertToString(const Parameter& p, std::string& val) const
     val = boost::apply_visitor(string_converter(), p);
 }
 
+static
+void WriteParam(std::ostream& os, const std::string& name, const Parameter& p)
+{
+    struct param_writer : public boost::static_visitor<void> {
+        std::ostream* os;
+        const std::string* name;
+        void operator()(bool val) const { *os << "b " << *name << ' ' << (int)val << '\n'; }
+        void operator()(double val) const { *os << "d " << *name << ' ' << val << '\n'; }
+        void operator()(int val) const { *os << "i " << *name << ' ' << val << '\n'; }
+        void operator()(const std::string& val) const { *os << "s " << *name << ' ' << val << '\n'; }
+    };
+
+    param_writer writer;
+    writer.os = &os;
+    writer.name = &name;
+    boost::apply_visitor(writer, p);
+}
+
+static
+bool ReadParam(const std::string& line, std::string& name, Parameter& p)
+{
+    // "<type> <name> <value>", where string values may contain spaces
+    if (line.size() < 4 || line[1] != ' ') {
+        return false;
+    }
+    auto sep = line.find(' ', 2);
+    if (sep == std::string::npos || sep == 2) {
+        return false;
+    }
+    name = line.substr(2, sep - 2);
+    auto value = line.substr(sep + 1);
+
+    try {
+        switch (line[0]) {
+        case 'b':
+            p = std::stoi(value) != 0;
+            return true;
+        case 'i':
+            p = std::stoi(value);
+            return true;
+        case 'd':
+            p = std::stod(value);
+            return true;
+        case 's':
+            p = value;
+            return true;
+        default:
+            return false;
+        }
+    } catch (const std::logic_error&) { // thrown by std::stoi and std::stod
+        return false;
+    }
+}
+
+auto PlanningParams::serialize() const -> std::string
+{
+    std::ostringstream oss;
+    oss.precision(std::numeric_limits<double>::max_digits10);
+
+    WriteParam(oss, "@cost_per_cell", cost_per_cell);
+    WriteParam(oss, "@shortcut_path", shortcut_path);
+    WriteParam(oss, "@interpolate_path", interpolate_path);
+    WriteParam(oss, "@shortcut_type", (int)shortcut_type);
+    WriteParam(oss, "@shortcut_thread_count", shortcut_thread_count);
+    WriteParam(oss, "@shortcut_time_limit", shortcut_time_limit);
+    WriteParam(oss, "@time_parameterize_path", time_parameterize_path);
+    WriteParam(oss, "@time_parameterization_time_limit", time_parameterization_time_limit);
+    WriteParam(oss, "@optimize_path_clearance", optimize_path_clearance);
+    WriteParam(oss, "@clearance_margin", clearance_margin);
+
+    for (auto& entry : params) {
+        WriteParam(oss, entry.first, entry.second);
+    }
+    return oss.str();
+}
+
+bool PlanningParams::deserialize(const std::string& data)
+{
+    PlanningParams out;
+    out.m_warn_defaults = m_warn_defaults;
+    out.plan_output_dir = plan_output_dir;
+    out.trace_output_dir = trace_output_dir;
+
+    std::istringstream iss(data);
+    std::string line;
+    while (std::getline(iss, line)) {
+        std::string name;
+        Parameter p;
+        if (!ReadParam(line, name, p)) {
+            SMPL_ERROR("Malformed planning parameter '%s'", line.c_str());
+            return false;
+        }
+
+        if (name[0] != '@') {
+            out.params[name] = p;
+            continue;
+        }
+
+        int shortcut_type;
+        if (name == "@cost_per_cell") {
+            convertToInt(p, out.cost_per_cell);
+        } else if (name == "@shortcut_path") {
+            convertToBool(p, out.shortcut_path);
+        } else if (name == "@interpolate_path") {
+            convertToBool(p, out.interpolate_path);
+        } else if (name == "@shortcut_type") {
+            convertToInt(p, shortcut_type);
+            out.shortcut_type = (ShortcutType)shortcut_type;
+        } else if (name == "@shortcut_thread_count") {
+            convertToInt(p, out.shortcut_thread_count);
+        } else if (name == "@shortcut_time_limit") {
+            convertToDouble(p, out.shortcut_time_limit);
+        } else if (name == "@time_parameterize_path") {
+            convertToBool(p, out.time_parameterize_path);
+        } else if (name == "@time_parameterization_time_limit") {
+            convertToDouble(p, out.time_parameterization_time_limit);
+        } else if (name == "@optimize_path_clearance") {
+            convertToBool(p, out.optimize_path_clearance);
+        } else if (name == "@clearance_margin") {
+            convertToDouble(p, out.clearance_margin);
+        } else {
+            SMPL_WARN("Ignore unrecognized planning parameter field '%s'", name.c_str());
+        }
+    }
+
+    *this = std::move(out);
+    return true;
+}
+
 } // namespace smpl
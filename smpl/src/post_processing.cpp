@@ -33,8 +33,18 @@
 #include <smpl/post_processing.h>
 
 // standard includes
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
 #include <numeric>
+#include <random>
+#include <thread>
 
 // project includes
 #include <smpl/angles.h>
@@ -63,6 +73,22 @@ double distance(
     return dist;
 }
 
+// Return the difference between two positions of a joint variable, taking
+// the shortest path for joints without position limits
+static
+double diff(
+    const RobotModel& robot,
+    const RobotState& from,
+    const RobotState& to,
+    size_t vidx)
+{
+    if (!robot.hasPosLimit(vidx)) {
+        return angles::shortest_angle_diff(to[vidx], from[vidx]);
+    } else {
+        return to[vidx] - from[vidx];
+    }
+}
+
 double pv_distance(
     const RobotModel& robot,
     const RobotState& from,
@@ -355,6 +381,276 @@ void ShortcutPath(
     SMPL_INFO("Shortcutted path: waypount_count: %zu, cost: %0.3f", pout.size(), next_cost);
 }
 
+// number of shortcut candidates sampled per worker thread in each round
+static const int SHORTCUT_CANDIDATES_PER_WORKER = 8;
+
+// number of consecutive rounds without an accepted shortcut after which
+// parallel shortcutting gives up
+static const int MAX_STALLED_SHORTCUT_ROUNDS = 8;
+
+struct ShortcutCandidate
+{
+    size_t i;
+    size_t j;
+    double savings;
+    bool valid;
+};
+
+// Runs a job once per collision checker, concurrently, with the calling thread
+// taking the first checker. The worker threads persist across jobs so that
+// shortcutting rounds do not pay for thread creation.
+class ShortcutWorkerPool
+{
+public:
+
+    explicit ShortcutWorkerPool(const std::vector<CollisionChecker*>& checkers) :
+        m_checkers(checkers)
+    {
+        for (size_t w = 1; w < m_checkers.size(); ++w) {
+            m_threads.emplace_back(&ShortcutWorkerPool::work, this, m_checkers[w]);
+        }
+    }
+
+    ~ShortcutWorkerPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_shutdown = true;
+        }
+        m_start.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    void run(const std::function<void(CollisionChecker*)>& job)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_job = job;
+            m_active = (int)m_threads.size();
+            ++m_generation;
+        }
+        m_start.notify_all();
+
+        job(m_checkers[0]);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finish.wait(lock, [&]() { return m_active == 0; });
+    }
+
+private:
+
+    std::vector<CollisionChecker*> m_checkers;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_finish;
+    std::function<void(CollisionChecker*)> m_job;
+    std::uint64_t m_generation = 0;
+    int m_active = 0;
+    bool m_shutdown = false;
+
+    void work(CollisionChecker* cc)
+    {
+        std::uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_start.wait(lock, [&]() {
+                return m_shutdown || m_generation != seen;
+            });
+            if (m_shutdown) {
+                return;
+            }
+            seen = m_generation;
+            auto job = m_job;
+
+            lock.unlock();
+            job(cc);
+            lock.lock();
+
+            if (--m_active == 0) {
+                m_finish.notify_all();
+            }
+        }
+    }
+};
+
+void ParallelShortcutPath(
+    RobotModel* rm,
+    const std::vector<CollisionChecker*>& checkers,
+    const std::vector<RobotState>& pin,
+    std::vector<RobotState>& pout,
+    double time_budget)
+{
+    if (pin.size() < 3 || checkers.empty()) {
+        pout = pin;
+        return;
+    }
+
+    auto then = clock::now();
+    auto deadline = then + std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(time_budget));
+
+    std::vector<double> costs;
+    ComputePositionPathCosts(rm, pin, costs);
+    const double prev_cost = std::accumulate(costs.begin(), costs.end(), 0.0);
+
+    ShortcutWorkerPool pool(checkers);
+
+    // check all candidates, or, if bounded, as many of the candidates as
+    // possible before the deadline
+    std::vector<ShortcutCandidate> candidates;
+    std::vector<RobotState> path;
+    auto check_candidates = [&](bool bounded)
+    {
+        std::atomic<size_t> next_candidate(0);
+        pool.run([&](CollisionChecker* cc)
+        {
+            while (!bounded || clock::now() < deadline) {
+                const size_t c = next_candidate++;
+                if (c >= candidates.size()) {
+                    break;
+                }
+                ShortcutCandidate& candidate = candidates[c];
+                candidate.valid = cc->isStateToStateValid(
+                        path[candidate.i], path[candidate.j]);
+            }
+        });
+    };
+
+    // Make the same greedy pass as ShortcutPath, extending a shortcut from
+    // the current anchor for as long as it remains valid, but check the next
+    // several extensions concurrently. The result is identical to the serial
+    // shortcut, so the randomized rounds below can only improve upon it.
+    path = pin;
+    std::vector<RobotState> greedy_path;
+    greedy_path.push_back(path.front());
+    size_t anchor = 0;
+    size_t reached = 1;
+    while (reached < path.size() - 1) {
+        candidates.clear();
+        const size_t last = std::min(path.size() - 1, reached + checkers.size());
+        for (size_t j = reached + 1; j <= last; ++j) {
+            candidates.push_back(ShortcutCandidate{ anchor, j, 0.0, false });
+        }
+        check_candidates(false);
+
+        auto invalid = std::find_if(begin(candidates), end(candidates),
+                [](const ShortcutCandidate& c) { return !c.valid; });
+        if (invalid == end(candidates)) {
+            reached = last;
+        } else {
+            // the shortcut to the last valid extension is final
+            anchor = invalid->j - 1;
+            reached = invalid->j;
+            greedy_path.push_back(path[anchor]);
+        }
+    }
+    greedy_path.push_back(path.back());
+    path = std::move(greedy_path);
+    ComputePositionPathCosts(rm, path, costs);
+
+    std::mt19937 rng;
+    std::vector<double> cum_costs;
+    std::vector<ShortcutCandidate> accepted;
+
+    int round_count = 0;
+    int stalled_rounds = 0;
+    while (path.size() > 2 &&
+        stalled_rounds < MAX_STALLED_SHORTCUT_ROUNDS &&
+        clock::now() < deadline)
+    {
+        ++round_count;
+
+        cum_costs.assign(path.size(), 0.0);
+        for (size_t i = 1; i < path.size(); ++i) {
+            cum_costs[i] = cum_costs[i - 1] + costs[i - 1];
+        }
+
+        // sample candidates that would reduce the path cost, if valid
+        candidates.clear();
+        std::uniform_int_distribution<size_t> waypoint_dist(0, path.size() - 1);
+        const size_t sample_count =
+                checkers.size() * SHORTCUT_CANDIDATES_PER_WORKER;
+        for (size_t k = 0; k < sample_count; ++k) {
+            size_t i = waypoint_dist(rng);
+            size_t j = waypoint_dist(rng);
+            if (i > j) {
+                std::swap(i, j);
+            }
+            if (j - i < 2) {
+                continue;
+            }
+            const double savings = (cum_costs[j] - cum_costs[i]) -
+                    distance(*rm, path[i], path[j]);
+            if (savings <= 0.0) {
+                continue;
+            }
+            candidates.push_back(ShortcutCandidate{ i, j, savings, false });
+        }
+
+        // check the most promising candidates first, so that the best ones
+        // are decided if the deadline interrupts the round
+        std::sort(begin(candidates), end(candidates),
+                [](const ShortcutCandidate& a, const ShortcutCandidate& b)
+                {
+                    return a.savings > b.savings;
+                });
+
+        check_candidates(true);
+
+        // greedily accept non-overlapping shortcuts by decreasing savings
+        accepted.clear();
+        for (const ShortcutCandidate& candidate : candidates) {
+            if (!candidate.valid) {
+                continue;
+            }
+            auto overlaps = [&](const ShortcutCandidate& a) {
+                return candidate.i < a.j && a.i < candidate.j;
+            };
+            if (std::none_of(begin(accepted), end(accepted), overlaps)) {
+                accepted.push_back(candidate);
+            }
+        }
+
+        if (accepted.empty()) {
+            ++stalled_rounds;
+            continue;
+        }
+        stalled_rounds = 0;
+
+        // remove the waypoints bypassed by the accepted shortcuts
+        std::vector<bool> bypassed(path.size(), false);
+        for (const ShortcutCandidate& candidate : accepted) {
+            for (size_t k = candidate.i + 1; k < candidate.j; ++k) {
+                bypassed[k] = true;
+            }
+        }
+
+        std::vector<RobotState> next_path;
+        next_path.reserve(path.size());
+        for (size_t k = 0; k < path.size(); ++k) {
+            if (!bypassed[k]) {
+                next_path.push_back(std::move(path[k]));
+            }
+        }
+        path = std::move(next_path);
+        ComputePositionPathCosts(rm, path, costs);
+    }
+
+    const double next_cost = std::accumulate(costs.begin(), costs.end(), 0.0);
+
+    pout = std::move(path);
+
+    auto now = clock::now();
+    SMPL_INFO("Parallel path shortcutting took %0.3f seconds (%d rounds, %zu threads)", std::chrono::duration<double>(now - then).count(), round_count, checkers.size());
+
+    SMPL_INFO("Original path: waypoint count: %zu, cost: %0.3f", pin.size(), prev_cost);
+    SMPL_INFO("Shortcutted path: waypount_count: %zu, cost: %0.3f", pout.size(), next_cost);
+}
+
 bool CreatePositionVelocityPath(
     RobotModel* rm,
     const std::vector<RobotState>& path,
@@ -391,6 +687,415 @@ bool CreatePositionVelocityPath(
     return true;
 }
 
+// maximum distance, in joint space, between consecutive grid points of the
+// time parameterization
+static const double TOPP_MAX_GRID_STEP = 0.05;
+
+// number of bisection steps used to compute the upper bound of each
+// controllable set of the time parameterization
+static const int TOPP_BISECTION_STEPS = 48;
+
+// Compute the interval of path accelerations u admissible at a grid point with
+// squared path velocity x, given the path derivatives at the grid point, that
+// also reach a squared path velocity in [0, x_next_max] at the next grid point,
+// a distance ds along the path. Return false if the interval is empty.
+static
+bool ComputeAdmissiblePathAccelerations(
+    const RobotModel& robot,
+    const std::vector<double>& dq,
+    const std::vector<double>& ddq,
+    double x,
+    double ds,
+    double x_next_max,
+    double& u_lo,
+    double& u_hi)
+{
+    u_lo = -x / (2.0 * ds);
+    u_hi = (x_next_max - x) / (2.0 * ds);
+    for (size_t vidx = 0; vidx < dq.size(); ++vidx) {
+        const double acc = robot.accLimit(vidx);
+        if (acc <= 0.0) {
+            continue;
+        }
+
+        // -acc <= dq * u + ddq * x <= acc
+        if (std::fabs(dq[vidx]) < 1e-9) {
+            if (std::fabs(ddq[vidx] * x) > acc) {
+                return false;
+            }
+            continue;
+        }
+
+        double lo = (-acc - ddq[vidx] * x) / dq[vidx];
+        double hi = (acc - ddq[vidx] * x) / dq[vidx];
+        if (lo > hi) {
+            std::swap(lo, hi);
+        }
+        u_lo = std::max(u_lo, lo);
+        u_hi = std::min(u_hi, hi);
+    }
+    return u_lo <= u_hi;
+}
+
+bool ComputeTimeOptimalParameterization(
+    RobotModel* rm,
+    const std::vector<RobotState>& path,
+    std::vector<double>& times,
+    double time_limit)
+{
+    auto then = clock::now();
+    auto deadline = then + std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(time_limit));
+
+    times.assign(path.size(), 0.0);
+    if (path.size() < 2) {
+        return true;
+    }
+
+    const size_t var_count = rm->getPlanningJoints().size();
+
+    // Discretize the path into grid points, subdividing long segments, and
+    // record the grid point at which each waypoint is reached. Within each
+    // segment, the path is a straight line parameterized by arc length.
+    struct Segment
+    {
+        std::vector<double> dir;
+        double length;
+    };
+    std::vector<Segment> segments;
+    std::vector<double> s;              // path parameter at each grid point
+    std::vector<size_t> grid_segment;   // segment following each grid point
+    std::vector<size_t> waypoint_grid(path.size(), 0);
+
+    s.push_back(0.0);
+    for (size_t i = 1; i < path.size(); ++i) {
+        Segment seg;
+        seg.dir.resize(var_count);
+        for (size_t vidx = 0; vidx < var_count; ++vidx) {
+            seg.dir[vidx] = diff(*rm, path[i - 1], path[i], vidx);
+        }
+        seg.length = std::sqrt(std::inner_product(
+                seg.dir.begin(), seg.dir.end(), seg.dir.begin(), 0.0));
+        if (seg.length < 1e-9) {
+            // duplicate waypoints are reached at the same time
+            waypoint_grid[i] = s.size() - 1;
+            continue;
+        }
+        for (double& d : seg.dir) {
+            d /= seg.length;
+        }
+
+        const int step_count =
+                std::max(1, (int)std::ceil(seg.length / TOPP_MAX_GRID_STEP));
+        const double s_first = s.back();
+        for (int k = 1; k <= step_count; ++k) {
+            grid_segment.push_back(segments.size());
+            s.push_back(s_first + seg.length * (double)k / (double)step_count);
+        }
+        waypoint_grid[i] = s.size() - 1;
+        segments.push_back(std::move(seg));
+    }
+
+    // a single grid step would join two points at which the path is at rest,
+    // leaving no room to accelerate, so split it
+    if (s.size() == 2) {
+        s.insert(s.begin() + 1, 0.5 * s.back());
+        grid_segment.push_back(grid_segment.back());
+        for (auto& g : waypoint_grid) {
+            if (g == 1) {
+                g = 2;
+            }
+        }
+    }
+
+    const size_t grid_count = s.size();
+    if (grid_count < 2) {
+        return true;
+    }
+
+    // Compute the first and second path derivatives at each grid point. At
+    // waypoints, the change in direction is spread over the neighboring grid
+    // steps.
+    std::vector<std::vector<double>> dq(grid_count, std::vector<double>(var_count));
+    std::vector<std::vector<double>> ddq(grid_count, std::vector<double>(var_count, 0.0));
+    for (size_t g = 0; g < grid_count; ++g) {
+        const size_t prev_seg = g > 0 ? grid_segment[g - 1] : grid_segment[g];
+        const size_t next_seg = g + 1 < grid_count ? grid_segment[g] : prev_seg;
+        const std::vector<double>& d_prev = segments[prev_seg].dir;
+        const std::vector<double>& d_next = segments[next_seg].dir;
+        for (size_t vidx = 0; vidx < var_count; ++vidx) {
+            dq[g][vidx] = 0.5 * (d_prev[vidx] + d_next[vidx]);
+        }
+        if (prev_seg != next_seg) {
+            const double h = s[g + 1] - s[g - 1];
+            for (size_t vidx = 0; vidx < var_count; ++vidx) {
+                ddq[g][vidx] = 2.0 * (d_next[vidx] - d_prev[vidx]) / h;
+            }
+        }
+    }
+
+    // maximum squared path velocity at each grid point due to velocity limits
+    std::vector<double> x_vel(grid_count, std::numeric_limits<double>::infinity());
+    for (size_t g = 0; g < grid_count; ++g) {
+        for (size_t vidx = 0; vidx < var_count; ++vidx) {
+            const double vel = rm->velLimit(vidx);
+            if (vel <= 0.0 || std::fabs(dq[g][vidx]) < 1e-9) {
+                continue;
+            }
+            const double sdot = vel / std::fabs(dq[g][vidx]);
+            x_vel[g] = std::min(x_vel[g], sdot * sdot);
+        }
+        if (!std::isfinite(x_vel[g])) {
+            SMPL_WARN("Path is not constrained by any velocity limit");
+            return false;
+        }
+    }
+
+    // backward pass: compute the upper bound of the controllable set at each
+    // grid point, from which the path may be brought to rest at the end
+    double u_lo, u_hi;
+    std::vector<double> x_max(grid_count, 0.0);
+    for (size_t g = grid_count - 1; g-- > 0; ) {
+        if (clock::now() > deadline) {
+            SMPL_WARN("Time parameterization exceeded time limit (%0.3f seconds)", time_limit);
+            return false;
+        }
+
+        const double ds = s[g + 1] - s[g];
+        auto feasible = [&](double x) {
+            return ComputeAdmissiblePathAccelerations(
+                    *rm, dq[g], ddq[g], x, ds, x_max[g + 1], u_lo, u_hi);
+        };
+
+        if (feasible(x_vel[g])) {
+            x_max[g] = x_vel[g];
+            continue;
+        }
+
+        // the controllable set is an interval containing 0
+        double lo = 0.0, hi = x_vel[g];
+        for (int k = 0; k < TOPP_BISECTION_STEPS; ++k) {
+            const double mid = 0.5 * (lo + hi);
+            if (feasible(mid)) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        x_max[g] = lo;
+    }
+
+    // forward pass: greedily choose the maximum admissible path acceleration,
+    // starting from rest
+    std::vector<double> x(grid_count, 0.0);
+    for (size_t g = 0; g + 1 < grid_count; ++g) {
+        const double ds = s[g + 1] - s[g];
+        double u = -x[g] / (2.0 * ds);
+        if (ComputeAdmissiblePathAccelerations(
+                *rm, dq[g], ddq[g], x[g], ds, x_max[g + 1], u_lo, u_hi))
+        {
+            u = u_hi;
+        }
+        x[g + 1] = std::max(0.0, std::min(x_max[g + 1], x[g] + 2.0 * ds * u));
+    }
+
+    // integrate the time along the path
+    std::vector<double> t(grid_count, 0.0);
+    for (size_t g = 0; g + 1 < grid_count; ++g) {
+        const double sdot_sum = std::sqrt(x[g]) + std::sqrt(x[g + 1]);
+        if (sdot_sum <= 0.0) {
+            SMPL_WARN("Time parameterization stalled at path parameter %0.3f", s[g]);
+            return false;
+        }
+        t[g + 1] = t[g] + 2.0 * (s[g + 1] - s[g]) / sdot_sum;
+    }
+
+    for (size_t i = 0; i < path.size(); ++i) {
+        times[i] = t[waypoint_grid[i]];
+    }
+
+    SMPL_INFO("Time parameterization took %0.3f seconds (%zu grid points, duration %0.3f seconds)", std::chrono::duration<double>(clock::now() - then).count(), grid_count, times.back());
+    return true;
+}
+
+// Return the weighted sum of the obstacle and smoothness costs of a path
+static
+double PathClearanceObjective(
+    const RobotModel& robot,
+    const std::vector<RobotState>& path,
+    const std::vector<double>& obstacle_costs,
+    const PathClearanceParams& params)
+{
+    double smoothness = 0.0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        for (size_t vidx = 0; vidx < path[i].size(); ++vidx) {
+            const double d = diff(robot, path[i - 1], path[i], vidx);
+            smoothness += 0.5 * d * d;
+        }
+    }
+    const double obstacle = std::accumulate(
+            obstacle_costs.begin(), obstacle_costs.end(), 0.0);
+    return params.smoothness_weight * smoothness +
+            params.obstacle_weight * obstacle;
+}
+
+bool OptimizePathClearance(
+    RobotModel* rm,
+    CollisionChecker* cc,
+    std::vector<RobotState>& path,
+    const PathClearanceParams& params)
+{
+    auto* cost_iface = cc->getExtension<ObstacleCostExtension>();
+    if (!cost_iface) {
+        SMPL_WARN("Path clearance optimization requires an Obstacle Cost Extension");
+        return false;
+    }
+
+    if (path.size() < 2) {
+        return true;
+    }
+
+    auto then = clock::now();
+    auto deadline = then + std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(params.time_limit));
+
+    const size_t var_count = rm->getPlanningJoints().size();
+
+    // resample the path so that there are waypoints to move along each segment
+    std::vector<RobotState> q;
+    q.push_back(path.front());
+    for (size_t i = 1; i < path.size(); ++i) {
+        const double len = distance(*rm, path[i - 1], path[i]);
+        const int step_count = std::max(
+                1, (int)std::ceil(len / params.max_waypoint_step));
+        for (int k = 1; k <= step_count; ++k) {
+            const double alpha = (double)k / (double)step_count;
+            RobotState p(var_count);
+            for (size_t vidx = 0; vidx < var_count; ++vidx) {
+                p[vidx] = path[i - 1][vidx] +
+                        alpha * diff(*rm, path[i - 1], path[i], vidx);
+            }
+            q.push_back(std::move(p));
+        }
+    }
+
+    const size_t n = q.size();
+    if (n < 3) {
+        return true;
+    }
+
+    std::vector<double> costs(n);
+    for (size_t i = 0; i < n; ++i) {
+        costs[i] = cost_iface->obstacleCost(q[i], params.margin);
+    }
+    double objective = PathClearanceObjective(*rm, q, costs, params);
+    const double initial_objective = objective;
+
+    const double min_update_step = 1e-4;
+    double update_step = params.max_update_step;
+
+    std::vector<std::vector<double>> grad(n, std::vector<double>(var_count, 0.0));
+    std::vector<double> cost_grad;
+    std::vector<std::vector<double>> update(n, std::vector<double>(var_count, 0.0));
+    std::vector<double> c(n), d(n);
+    std::vector<RobotState> q_next;
+    std::vector<double> costs_next(n);
+
+    int iteration = 0;
+    for ( ; iteration < params.max_iterations; ++iteration) {
+        if (clock::now() > deadline || update_step < min_update_step) {
+            break;
+        }
+
+        // gradient of the objective with respect to the interior waypoints
+        for (size_t i = 1; i + 1 < n; ++i) {
+            for (size_t vidx = 0; vidx < var_count; ++vidx) {
+                grad[i][vidx] = params.smoothness_weight * (
+                        diff(*rm, q[i + 1], q[i], vidx) -
+                        diff(*rm, q[i], q[i - 1], vidx));
+            }
+            if (costs[i] <= 0.0) {
+                continue; // beyond the margin of all obstacles
+            }
+            cost_iface->obstacleCostGradient(q[i], params.margin, cost_grad);
+            for (size_t vidx = 0; vidx < var_count; ++vidx) {
+                grad[i][vidx] += params.obstacle_weight * cost_grad[vidx];
+            }
+        }
+
+        // precondition the gradient by the inverse of the tridiagonal
+        // smoothness metric, A = tridiag(-1, 2, -1), with the Thomas algorithm,
+        // and find the largest resulting waypoint update
+        double max_update = 0.0;
+        for (size_t vidx = 0; vidx < var_count; ++vidx) {
+            // forward sweep over interior waypoints 1..n-2
+            c[1] = -0.5;
+            d[1] = 0.5 * grad[1][vidx];
+            for (size_t i = 2; i + 1 < n; ++i) {
+                const double m = 2.0 + c[i - 1];
+                c[i] = -1.0 / m;
+                d[i] = (grad[i][vidx] + d[i - 1]) / m;
+            }
+            // back substitution
+            update[n - 2][vidx] = d[n - 2];
+            for (size_t i = n - 2; i-- > 1; ) {
+                update[i][vidx] = d[i] - c[i] * update[i + 1][vidx];
+            }
+            for (size_t i = 1; i + 1 < n; ++i) {
+                max_update = std::max(max_update, std::fabs(update[i][vidx]));
+            }
+        }
+
+        if (max_update <= 0.0) {
+            break; // stationary
+        }
+
+        // take a step bounded by the current update step and keep it if it
+        // decreases the objective
+        const double scale = update_step / max_update;
+        q_next = q;
+        for (size_t i = 1; i + 1 < n; ++i) {
+            for (size_t vidx = 0; vidx < var_count; ++vidx) {
+                double& pos = q_next[i][vidx];
+                pos -= scale * update[i][vidx];
+                if (rm->hasPosLimit(vidx)) {
+                    pos = std::max(rm->minPosLimit(vidx), pos);
+                    pos = std::min(rm->maxPosLimit(vidx), pos);
+                }
+            }
+        }
+
+        costs_next.front() = costs.front();
+        costs_next.back() = costs.back();
+        for (size_t i = 1; i + 1 < n; ++i) {
+            costs_next[i] = cost_iface->obstacleCost(q_next[i], params.margin);
+        }
+
+        const double next_objective =
+                PathClearanceObjective(*rm, q_next, costs_next, params);
+        if (next_objective < objective) {
+            q.swap(q_next);
+            costs.swap(costs_next);
+            objective = next_objective;
+            update_step = std::min(params.max_update_step, 2.0 * update_step);
+        } else {
+            update_step *= 0.5;
+        }
+    }
+
+    SMPL_INFO("Path clearance optimization took %0.3f seconds (%d iterations, %zu waypoints, objective %0.3f -> %0.3f)", std::chrono::duration<double>(clock::now() - then).count(), iteration, n, initial_objective, objective);
+
+    for (size_t i = 1; i < n; ++i) {
+        if (!cc->isStateToStateValid(q[i - 1], q[i])) {
+            SMPL_WARN("Path optimized for clearance is invalid at waypoint %zu", i);
+            return false;
+        }
+    }
+
+    path = std::move(q);
+    return true;
+}
+
 bool ExtractPositionPath(
     RobotModel* rm,
     const std::vector<RobotState>& pv_path,
@@ -80,6 +80,16 @@ ForwardKinematicsInterface::~ForwardKinematicsInterface()
 {
 }
 
+void ForwardKinematicsInterface::computeFKBatch(
+    const RobotState* states,
+    int count,
+    Affine3* poses)
+{
+    for (int i = 0; i < count; ++i) {
+        poses[i] = computeFK(states[i]);
+    }
+}
+
 InverseKinematicsInterface::~InverseKinematicsInterface()
 {
 }
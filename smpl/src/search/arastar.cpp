@@ -72,7 +72,8 @@ ARAStar::ARAStar(
     m_expand_count(0),
     m_search_time_init(clock::duration::zero()),
     m_search_time(clock::duration::zero()),
-    m_satisfied_eps(std::numeric_limits<double>::infinity())
+    m_satisfied_eps(std::numeric_limits<double>::infinity()),
+    m_trace(NULL)
 {
     environment_ = space;
 
@@ -161,6 +162,10 @@ int ARAStar::replan(
         m_last_goal_state_id = m_goal_state_id;
     }
 
+    if (m_trace != NULL) {
+        m_trace->beginSearch(m_start_state_id, m_goal_state_id);
+    }
+
     auto start_time = clock::now();
     int num_expansions = 0;
     clock::duration elapsed_time = clock::duration::zero();
@@ -183,6 +188,9 @@ int ARAStar::replan(
             m_incons.clear();
             SMPL_DEBUG_NAMED(SLOG, "Begin new search iteration %d with epsilon = %0.3f", m_iteration, m_curr_eps);
         }
+        if (m_trace != NULL) {
+            m_trace->beginIteration(m_iteration, m_curr_eps);
+        }
         err = improvePath(start_time, goal_state, num_expansions, elapsed_time);
         if (m_curr_eps == m_initial_eps) {
             m_expand_count_init += num_expansions;
@@ -202,12 +210,21 @@ int ARAStar::replan(
         if (m_allow_partial_solutions && !m_open.empty()) {
             SearchState* next_state = m_open.min();
             extractPath(next_state, *solution, *cost);
+            if (m_trace != NULL) {
+                m_trace->endSearch(true, *cost, num_expansions);
+            }
             return !SUCCESS;
         }
+        if (m_trace != NULL) {
+            m_trace->endSearch(false, -1, num_expansions);
+        }
         return !err;
     }
 
     extractPath(goal_state, *solution, *cost);
+    if (m_trace != NULL) {
+        m_trace->endSearch(true, *cost, num_expansions);
+    }
     return !SUCCESS;
 }
 
@@ -531,6 +548,10 @@ void ARAStar::expand(SearchState* s)
 
     SMPL_DEBUG_NAMED(SELOG, "  %zu successors", m_succs.size());
 
+    if (m_trace != NULL) {
+        m_trace->expansion(s->state_id, s->eg, s->h, s->f, m_succs, m_costs);
+    }
+
     for (size_t sidx = 0; sidx < m_succs.size(); ++sidx) {
         int succ_state_id = m_succs[sidx];
         int cost = m_costs[sidx];
@@ -76,6 +76,10 @@ void ARAStarEGraph::expand(SearchState* s)
 
     SMPL_DEBUG_NAMED(SELOG, "  %zu successors", m_succs.size());
 
+    if (m_trace != NULL) {
+        m_trace->expansion(s->state_id, s->eg, s->h, s->f, m_succs, m_costs);
+    }
+
     for (size_t sidx = 0; sidx < m_succs.size(); ++sidx) {
         int succ_state_id = m_succs[sidx];
         int cost = m_costs[sidx];
@@ -0,0 +1,428 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+#include <smpl/search/search_trace.h>
+
+// standard includes
+#include <string.h>
+#include <sstream>
+
+// project includes
+#include <smpl/console/console.h>
+
+namespace smpl {
+
+static const char* TRACE_LOG = "search.trace";
+
+static const char TRACE_MAGIC[] = "SMPLTRACE";
+static const std::uint8_t TRACE_VERSION = 1;
+
+// buffered bytes are written out once the buffer grows past this size
+static const std::size_t TRACE_BUFFER_SIZE = 1 << 16;
+
+static
+void AppendVarint(std::string& buf, std::uint64_t value)
+{
+    while (value >= 0x80) {
+        buf.push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    buf.push_back((char)value);
+}
+
+// zigzag-encode so that small negative values also take few bytes
+static
+void AppendSignedVarint(std::string& buf, std::int64_t value)
+{
+    AppendVarint(buf, ((std::uint64_t)value << 1) ^ (std::uint64_t)(value >> 63));
+}
+
+static
+void AppendDouble(std::string& buf, double value)
+{
+    char bytes[sizeof(value)];
+    memcpy(bytes, &value, sizeof(value));
+    buf.append(bytes, sizeof(bytes));
+}
+
+static
+bool ReadVarint(std::istream& is, std::uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        auto c = is.get();
+        if (c == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= (std::uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static
+bool ReadSignedVarint(std::istream& is, std::int64_t& value)
+{
+    std::uint64_t u;
+    if (!ReadVarint(is, u)) {
+        return false;
+    }
+    value = (std::int64_t)(u >> 1) ^ -(std::int64_t)(u & 1);
+    return true;
+}
+
+template <class T>
+bool ReadVarint(std::istream& is, T& value)
+{
+    std::uint64_t u;
+    if (!ReadVarint(is, u)) {
+        return false;
+    }
+    value = (T)u;
+    return true;
+}
+
+template <class T>
+bool ReadSignedVarint(std::istream& is, T& value)
+{
+    std::int64_t i;
+    if (!ReadSignedVarint(is, i)) {
+        return false;
+    }
+    value = (T)i;
+    return true;
+}
+
+static
+bool ReadDouble(std::istream& is, double& value)
+{
+    char bytes[sizeof(value)];
+    if (!is.read(bytes, sizeof(bytes))) {
+        return false;
+    }
+    memcpy(&value, bytes, sizeof(value));
+    return true;
+}
+
+// Read a length-prefixed string, rejecting lengths beyond \p max_size before
+// allocating for them.
+static
+bool ReadString(std::istream& is, std::string& s, std::uint64_t max_size)
+{
+    std::uint64_t size;
+    if (!ReadVarint(is, size) || size > max_size) {
+        return false;
+    }
+    s.resize(size);
+    return size == 0 || (bool)is.read(&s[0], size);
+}
+
+SearchTraceWriter::~SearchTraceWriter()
+{
+    close();
+}
+
+bool SearchTraceWriter::open(const std::string& filename)
+{
+    close();
+
+    m_ofs.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_ofs.is_open()) {
+        SMPL_ERROR_NAMED(TRACE_LOG, "Failed to open trace file '%s'", filename.c_str());
+        return false;
+    }
+
+    m_buffer.clear();
+    m_buffer.append(TRACE_MAGIC, sizeof(TRACE_MAGIC) - 1);
+    m_buffer.push_back((char)TRACE_VERSION);
+    return true;
+}
+
+void SearchTraceWriter::close()
+{
+    if (m_ofs.is_open()) {
+        flush(true);
+        m_ofs.close();
+    }
+}
+
+void SearchTraceWriter::writeBlob(
+    const std::string& name,
+    const void* data,
+    std::size_t size)
+{
+    m_buffer.push_back((char)SearchTraceRecordType::Blob);
+    AppendVarint(m_buffer, name.size());
+    m_buffer.append(name);
+    AppendVarint(m_buffer, size);
+    m_buffer.append((const char*)data, size);
+    flush(false);
+}
+
+void SearchTraceWriter::beginSearch(int start_state_id, int goal_state_id)
+{
+    m_search_start = clock::now();
+    m_last_time = 0;
+    m_buffer.push_back((char)SearchTraceRecordType::SearchBegin);
+    AppendSignedVarint(m_buffer, start_state_id);
+    AppendSignedVarint(m_buffer, goal_state_id);
+}
+
+void SearchTraceWriter::beginIteration(int iteration, double eps)
+{
+    m_buffer.push_back((char)SearchTraceRecordType::Iteration);
+    writeTime();
+    AppendSignedVarint(m_buffer, iteration);
+    AppendDouble(m_buffer, eps);
+}
+
+void SearchTraceWriter::expansion(
+    int state_id,
+    unsigned int g,
+    unsigned int h,
+    unsigned int f,
+    const std::vector<int>& succs,
+    const std::vector<int>& costs)
+{
+    m_buffer.push_back((char)SearchTraceRecordType::Expansion);
+    writeTime();
+    AppendSignedVarint(m_buffer, state_id);
+    AppendVarint(m_buffer, g);
+    AppendVarint(m_buffer, h);
+    AppendVarint(m_buffer, f);
+    AppendVarint(m_buffer, succs.size());
+    for (std::size_t i = 0; i < succs.size(); ++i) {
+        // successors tend to have ids close to their predecessor's
+        AppendSignedVarint(m_buffer, (std::int64_t)succs[i] - state_id);
+        AppendSignedVarint(m_buffer, costs[i]);
+    }
+    flush(false);
+}
+
+void SearchTraceWriter::endSearch(bool solved, int cost, int expansions)
+{
+    m_buffer.push_back((char)SearchTraceRecordType::SearchEnd);
+    writeTime();
+    m_buffer.push_back((char)solved);
+    AppendSignedVarint(m_buffer, cost);
+    AppendSignedVarint(m_buffer, expansions);
+    flush(true);
+}
+
+// Append the time since the last timed record, in nanoseconds.
+void SearchTraceWriter::writeTime()
+{
+    auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now() - m_search_start).count();
+    AppendSignedVarint(m_buffer, now - m_last_time);
+    m_last_time = now;
+}
+
+void SearchTraceWriter::flush(bool force)
+{
+    if (!m_ofs.is_open()) {
+        m_buffer.clear();
+        return;
+    }
+    if (force || m_buffer.size() >= TRACE_BUFFER_SIZE) {
+        m_ofs.write(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+        if (force) {
+            m_ofs.flush();
+        }
+    }
+}
+
+bool SearchTraceReader::open(const std::string& filename)
+{
+    m_ifs.close();
+    m_ifs.clear();
+    m_ifs.open(filename, std::ios::in | std::ios::binary);
+    if (!m_ifs.is_open()) {
+        SMPL_ERROR_NAMED(TRACE_LOG, "Failed to open trace file '%s'", filename.c_str());
+        return false;
+    }
+
+    char magic[sizeof(TRACE_MAGIC) - 1];
+    if (!m_ifs.read(magic, sizeof(magic)) ||
+        memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0)
+    {
+        SMPL_ERROR_NAMED(TRACE_LOG, "'%s' is not a search trace", filename.c_str());
+        m_ifs.close();
+        return false;
+    }
+
+    auto version = m_ifs.get();
+    if (version != TRACE_VERSION) {
+        SMPL_ERROR_NAMED(TRACE_LOG, "Unsupported search trace version %d", version);
+        m_ifs.close();
+        return false;
+    }
+
+    // remember the size of the trace to validate stored lengths against
+    auto pos = m_ifs.tellg();
+    m_ifs.seekg(0, std::ios::end);
+    m_size = m_ifs.tellg();
+    m_ifs.seekg(pos);
+
+    m_time = 0;
+    m_error = false;
+    return true;
+}
+
+bool SearchTraceReader::read(SearchTraceRecord& record)
+{
+    // the trace may only end cleanly between records
+    auto type = m_ifs.get();
+    if (type == std::char_traits<char>::eof()) {
+        return false;
+    }
+
+    if (!readRecord(type, record)) {
+        SMPL_ERROR_NAMED(TRACE_LOG, "Search trace is truncated or malformed");
+        m_error = true;
+        return false;
+    }
+    return true;
+}
+
+bool SearchTraceReader::readRecord(int type, SearchTraceRecord& record)
+{
+    record.type = (SearchTraceRecordType)type;
+
+    auto readTime = [&]()
+    {
+        std::int64_t dt;
+        if (!ReadSignedVarint(m_ifs, dt)) {
+            return false;
+        }
+        m_time += dt;
+        record.time = m_time;
+        return true;
+    };
+
+    // lengths stored in a malformed trace may not fit in the rest of the file
+    auto remaining = [&]() -> std::uint64_t
+    {
+        auto pos = (std::int64_t)m_ifs.tellg();
+        return pos < 0 || pos > m_size ? 0 : (std::uint64_t)(m_size - pos);
+    };
+
+    switch (record.type) {
+    case SearchTraceRecordType::Blob:
+        return ReadString(m_ifs, record.name, remaining()) &&
+                ReadString(m_ifs, record.data, remaining());
+    case SearchTraceRecordType::SearchBegin:
+        m_time = 0;
+        record.time = 0;
+        return ReadSignedVarint(m_ifs, record.start_state_id) &&
+                ReadSignedVarint(m_ifs, record.goal_state_id);
+    case SearchTraceRecordType::Iteration:
+        return readTime() &&
+                ReadSignedVarint(m_ifs, record.iteration) &&
+                ReadDouble(m_ifs, record.eps);
+    case SearchTraceRecordType::Expansion:
+    {
+        std::uint64_t count;
+        if (!readTime() ||
+            !ReadSignedVarint(m_ifs, record.state_id) ||
+            !ReadVarint(m_ifs, record.g) ||
+            !ReadVarint(m_ifs, record.h) ||
+            !ReadVarint(m_ifs, record.f) ||
+            !ReadVarint(m_ifs, count) ||
+            count > remaining() / 2) // each successor takes at least 2 bytes
+        {
+            return false;
+        }
+        record.succs.resize(count);
+        record.costs.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            std::int64_t offset;
+            if (!ReadSignedVarint(m_ifs, offset) ||
+                !ReadSignedVarint(m_ifs, record.costs[i]))
+            {
+                return false;
+            }
+            record.succs[i] = (int)(record.state_id + offset);
+        }
+        return true;
+    }
+    case SearchTraceRecordType::SearchEnd:
+    {
+        if (!readTime()) {
+            return false;
+        }
+        auto solved = m_ifs.get();
+        if (solved == std::char_traits<char>::eof()) {
+            return false;
+        }
+        record.solved = solved != 0;
+        return ReadSignedVarint(m_ifs, record.cost) &&
+                ReadSignedVarint(m_ifs, record.expansions);
+    }
+    default:
+        SMPL_ERROR_NAMED(TRACE_LOG, "Unrecognized search trace record type %d", type);
+        return false;
+    }
+}
+
+auto EncodeTraceProperties(const std::map<std::string, std::string>& props)
+    -> std::string
+{
+    std::string data;
+    for (auto& entry : props) {
+        data += entry.first;
+        data += ' ';
+        data += entry.second;
+        data += '\n';
+    }
+    return data;
+}
+
+bool DecodeTraceProperties(
+    const std::string& data,
+    std::map<std::string, std::string>& props)
+{
+    std::istringstream iss(data);
+    std::string line;
+    while (std::getline(iss, line)) {
+        auto sep = line.find(' ');
+        if (sep == 0 || sep == std::string::npos) {
+            return false;
+        }
+        props[line.substr(0, sep)] = line.substr(sep + 1);
+    }
+    return true;
+}
+
+} // namespace smpl
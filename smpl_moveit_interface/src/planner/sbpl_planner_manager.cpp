@@ -1,5 +1,8 @@
 #include "sbpl_planner_manager.h"
 
+// standard includes
+#include <algorithm>
+
 // system includes
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/robot_state/conversions.h>
@@ -550,43 +553,69 @@ bool LoadPlannerConfigurationMapping(
     return true;
 }
 
-// retrive an already-initialized model for a given group
-auto GetModelForGroup(
+// create an sbpl robot model for a given group
+auto CreateModelForGroup(
     SBPLPlannerManager* manager,
     const std::string& group_name)
-    -> MoveItRobotModel*
+    -> std::unique_ptr<MoveItRobotModel>
 {
-    auto it = manager->m_sbpl_models.find(group_name);
-    if (it != end(manager->m_sbpl_models)) {
-        ROS_DEBUG_NAMED(PP_LOGGER, "Use existing SBPL Robot Model for group '%s'", group_name.c_str());
-        return it->second.get();
-    }
-
     auto model = smpl::make_unique<MoveItRobotModel>();
     if (!model->init(manager->m_robot_model, group_name)) {
         ROS_WARN_NAMED(PP_LOGGER, "Failed to initialize SBPL Robot Model");
-        return NULL;
+        return nullptr;
     }
 
     ROS_INFO_NAMED(PP_LOGGER, "Created SBPL Robot Model for group '%s'", group_name.c_str());
-    auto ent = manager->m_sbpl_models.insert(std::make_pair(group_name, std::move(model)));
-    return ent.first->second.get();
+    return std::move(model);
 }
 
-auto GetPlanningContextForPlanner(
+// Releases a context created while the pool was full of busy contexts, along
+// with the sbpl robot model it plans for
+struct TransientContextDeleter
+{
+    std::shared_ptr<MoveItRobotModel> model;
+
+    void operator()(SBPLPlanningContext* context) const { delete context; }
+};
+
+// retrieve an idle context from the pool for a given group + planner_id, or
+// create a new one if all existing contexts are busy. The new context replaces
+// an idle context if the pool is full, and is not pooled at all if every
+// pooled context is busy.
+auto AcquirePlanningContext(
     SBPLPlannerManager* manager,
-    MoveItRobotModel* model,
+    const std::string& group_name,
     const std::string& planner_id)
     -> SBPLPlanningContextPtr
 {
     SBPLPlanningContextPtr null_context;
-    auto it = manager->m_contexts.find(planner_id);
-    if (it != end(manager->m_contexts)) {
-        return it->second;
+
+    {
+        std::lock_guard<std::mutex> lock(manager->m_contexts_mutex);
+        auto& pool = manager->m_contexts[planner_id];
+        for (auto& entry : pool) {
+            // Only the pool hands out references to pooled contexts, and only
+            // while holding the lock, so a context referenced solely by the
+            // pool can not become busy behind our back
+            if (entry.context.use_count() == 1 &&
+                entry.context->getGroupName() == group_name)
+            {
+                ROS_DEBUG_NAMED(PP_LOGGER, "Use idle SBPL Planning Context for planner '%s'", planner_id.c_str());
+                return entry.context;
+            }
+        }
     }
 
-    auto context = SBPLPlanningContextPtr(new SBPLPlanningContext(
-            model, "sbpl_planning_context", model->planningGroupName()));
+    // constructing and initializing a context may be expensive (loading
+    // motion primitives, etc.), so don't block other requests meanwhile
+
+    auto model = CreateModelForGroup(manager, group_name);
+    if (!model) {
+        return null_context;
+    }
+
+    auto context = smpl::make_unique<SBPLPlanningContext>(
+            model.get(), "sbpl_planning_context", group_name);
 
     // find a configuration for this group + planner_id
     auto& configs = manager->getPlannerConfigurations();
@@ -597,7 +626,6 @@ auto GetPlanningContextForPlanner(
     for (auto& config : configs) {
         auto& name = config.first;
         auto& settings = config.second;
-        auto& group_name = model->planningGroupName();
         if (name == group_name) {
             all_params.insert(begin(settings.config), end(settings.config));
         } else if (name == planner_id) {
@@ -610,8 +638,30 @@ auto GetPlanningContextForPlanner(
         return null_context;
     }
 
-    manager->m_contexts.insert(std::make_pair(planner_id, context));
-    return context;
+    std::lock_guard<std::mutex> lock(manager->m_contexts_mutex);
+    auto& pool = manager->m_contexts[planner_id];
+
+    if (pool.size() >= (size_t)manager->m_max_pooled_contexts) {
+        auto idle = std::find_if(begin(pool), end(pool),
+                [](const SBPLPlannerManager::PooledContext& entry) {
+                    return entry.context.use_count() == 1;
+                });
+        if (idle == end(pool)) {
+            ROS_INFO_NAMED(PP_LOGGER, "Created transient SBPL Planning Context for planner '%s' (%zu pooled contexts busy)", planner_id.c_str(), pool.size());
+            TransientContextDeleter deleter;
+            deleter.model = std::move(model);
+            return SBPLPlanningContextPtr(context.release(), deleter);
+        }
+        ROS_DEBUG_NAMED(PP_LOGGER, "Evict idle SBPL Planning Context for planner '%s'", planner_id.c_str());
+        pool.erase(idle);
+    }
+
+    SBPLPlannerManager::PooledContext entry;
+    entry.model = std::move(model);
+    entry.context = SBPLPlanningContextPtr(context.release());
+    pool.push_back(std::move(entry));
+    ROS_INFO_NAMED(PP_LOGGER, "Created SBPL Planning Context %zu for planner '%s'", pool.size(), planner_id.c_str());
+    return pool.back().context;
 }
 
 auto SelectPlanningLink(
@@ -655,6 +705,7 @@ auto SelectPlanningLink(
 SBPLPlannerManager::SBPLPlannerManager() :
     Base(),
     m_robot_model(),
+    m_max_pooled_contexts(4),
     m_viz()
 {
     ROS_DEBUG_NAMED(PP_LOGGER, "Constructed SBPL Planner Manager");
@@ -680,6 +731,12 @@ bool SBPLPlannerManager::initialize(
     m_robot_model = model;
 
     ros::NodeHandle nh(ns);
+    nh.param("max_pooled_contexts", m_max_pooled_contexts, 4);
+    if (m_max_pooled_contexts < 1) {
+        ROS_WARN_NAMED(PP_LOGGER, "max_pooled_contexts must be positive");
+        m_max_pooled_contexts = 1;
+    }
+
     PlannerConfigurationMap pcm;
     if (!LoadPlannerConfigurationMapping(nh, *model, &pcm)) {
         ROS_ERROR_NAMED(PP_LOGGER, "Failed to load planner configurations");
@@ -730,17 +787,26 @@ auto SBPLPlannerManager::getPlanningContext(
         return null_context;
     }
 
-    ////////////////////////////////////////
-    // Initialize/Update SBPL Robot Model //
-    ////////////////////////////////////////
+    ///////////////////////////////////////////
+    // Acquire an idle SBPL Planning Context //
+    ///////////////////////////////////////////
 
     auto* mutable_me = const_cast<SBPLPlannerManager*>(this);
-    auto* sbpl_model = GetModelForGroup(mutable_me, req.group_name);
-    if (!sbpl_model) {
-        ROS_WARN_NAMED(PP_LOGGER, "No SBPL Robot Model available for group '%s'", req.group_name.c_str());
+    auto sbpl_context = AcquirePlanningContext(
+            mutable_me, req.group_name, req.planner_id);
+    if (!sbpl_context) {
+        ROS_WARN_NAMED(PP_LOGGER, "No SBPL Planning Context available for planner '%s'", req.planner_id.c_str());
         return null_context;
     }
 
+    /////////////////////////////
+    // Update SBPL Robot Model //
+    /////////////////////////////
+
+    // the acquired context is ours alone until the caller releases it, so
+    // its sbpl robot model may be updated without further synchronization
+    auto* sbpl_model = sbpl_context->m_robot_model;
+
     auto planning_link = SelectPlanningLink(this, req);
     if (planning_link.empty()) {
         ROS_INFO_NAMED(PP_LOGGER, "Clear the planning link");
@@ -761,17 +827,10 @@ auto SBPLPlannerManager::getPlanningContext(
         return null_context;
     }
 
-    /////////////////////////////////////////////
-    // Initialize/Update SBPL Planning Context //
-    /////////////////////////////////////////////
-
 #if 0
     LogPlanningScene(*planning_scene);
 #endif
 
-    auto sbpl_context = GetPlanningContextForPlanner(
-            mutable_me, sbpl_model, req.planner_id);
-
     sbpl_context->setPlanningScene(planning_scene);
     sbpl_context->setMotionPlanRequest(req);
 
@@ -1,6 +1,13 @@
 #ifndef sbpl_interface_sbpl_planner_manager_h
 #define sbpl_interface_sbpl_planner_manager_h
 
+// standard includes
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 // system includes
 #include <XmlRpcValue.h>
 #include <moveit/macros/class_forward.h>
@@ -61,12 +68,25 @@ public:
 
     moveit::core::RobotModelConstPtr m_robot_model;
 
-    // per-group sbpl robot model
-    // TODO: make unique per context instance
-    std::map<std::string, std::unique_ptr<MoveItRobotModel>> m_sbpl_models;
-
-    // per-configuration context
-    std::map<std::string, SBPLPlanningContextPtr> m_contexts;
+    // A planning context along with the sbpl robot model it plans for. The
+    // sbpl robot model holds per-request state (planning link, planning
+    // scene), so each context gets its own instance.
+    struct PooledContext
+    {
+        std::unique_ptr<MoveItRobotModel> model;
+        SBPLPlanningContextPtr context;
+    };
+
+    // per-configuration pool of contexts. A context is idle when the pool
+    // holds the only reference to it; otherwise it has been handed out to
+    // service a request that may still be planning.
+    std::map<std::string, std::vector<PooledContext>> m_contexts;
+    std::mutex m_contexts_mutex;
+
+    // maximum number of contexts pooled per configuration. Requests that
+    // arrive while the pool is full of busy contexts are serviced by
+    // transient contexts that are destroyed once released.
+    int m_max_pooled_contexts;
 
     smpl::VisualizerROS m_viz;
 
@@ -1,6 +1,7 @@
 #include "sbpl_planning_context.h"
 
 // standard includes
+#include <algorithm>
 #include <chrono>
 
 // system includes
@@ -152,12 +153,22 @@ auto UpdateOrCreateGrid(
             workspace.max_corner.y != context->m_prev_workspace.max_corner.y ||
             workspace.max_corner.z != context->m_prev_workspace.max_corner.z;
 
-    if (scene != context->m_prev_scene || workspace_diff) {
-        ROS_DEBUG_NAMED(PP_LOGGER, "   -> Scene or workspace changed (scene: %p -> %p)", context->m_prev_scene.get(), scene.get());
+    auto& world = *scene->getWorld();
+
+    auto snapshot_world = [&]()
+    {
+        context->m_prev_world_objects.clear();
+        for (auto it = world.begin(); it != world.end(); ++it) {
+            context->m_prev_world_objects[it->first] = it->second;
+        }
+    };
+
+    auto rebuild_grid = [&]()
+    {
         {
             auto g = std::move(grid); // for lack of a swap or destroy
         }
-        return CreateHeuristicGrid(
+        auto new_grid = CreateHeuristicGrid(
                 *scene,
                 workspace,
                 context->m_robot_model->planningGroupName(),
@@ -165,70 +176,104 @@ auto UpdateOrCreateGrid(
                 context->m_grid_res_y,
                 context->m_grid_res_z,
                 context->m_grid_inflation_radius);
-    } else {
-        ROS_DEBUG_NAMED(PP_LOGGER, "   -> Update persistent grid");
-        auto voxelize = [&](const collision_detection::World::Object& object)
-        {
-            std::vector<std::vector<Eigen::Vector3d>> voxelses; // , my precious
-            Eigen::Vector3d grid_origin;
-            grid_origin.x() = grid->originX();
-            grid_origin.y() = grid->originY();
-            grid_origin.z() = grid->originZ();
-            smpl::collision::VoxelizeObject(
-                    object,
-                    grid->resolution(),
-                    grid_origin,
-                    voxelses);
-            return voxelses;
-        };
-
-        auto remove_object = [&](const collision_detection::World::Object& object)
-        {
-            auto voxelses = voxelize(object);
-            for (auto& voxels : voxelses) {
-                grid->removePointsFromField(voxels);
-            }
-        };
+        if (new_grid) {
+            snapshot_world();
+        }
+        return new_grid;
+    };
 
-        auto insert_object = [&](const collision_detection::World::Object& object)
-        {
-            auto voxelses = voxelize(object);
-            for (auto& voxels : voxelses) {
-                grid->addPointsToField(voxels);
-            }
-        };
+    if (!grid || workspace_diff) {
+        ROS_DEBUG_NAMED(PP_LOGGER, "   -> Grid missing or workspace changed");
+        return rebuild_grid();
+    }
 
-        auto wnew_begin = scene->getWorld()->begin();
-        auto wnew_end = scene->getWorld()->end();
+    auto& prev_objects = context->m_prev_world_objects;
 
-        auto wold_begin = context->m_prev_scene->getWorld()->begin();
-        auto wold_end = context->m_prev_scene->getWorld()->end();
+    // Objects are unchanged iff the world holds exactly the same object
+    // instances as when the grid was last updated
+    auto unchanged = [&](const std::string& id) {
+        auto it = prev_objects.find(id);
+        return it != end(prev_objects) && it->second == world.getObject(id);
+    };
 
-        // Remove objects that are in prev_scene but not in scene
-        for (auto it = wold_begin; it != wold_end; ++it) {
-            if (!scene->getWorld()->hasObject(it->first)) {
-                remove_object(*it->second);
-            }
+    auto world_unchanged = world.size() == prev_objects.size();
+    for (auto it = world.begin(); world_unchanged && it != world.end(); ++it) {
+        world_unchanged = unchanged(it->first);
+    }
+
+    if (world_unchanged) {
+        ROS_DEBUG_NAMED(PP_LOGGER, "   -> World unchanged");
+        return grid;
+    }
+
+    auto removed = [&](const std::pair<const std::string, collision_detection::World::ObjectConstPtr>& entry) {
+        return !world.hasObject(entry.first) ||
+                world.getObject(entry.first) != entry.second;
+    };
+
+    // Without reference counts, removing an object's voxels would also clear
+    // cells shared with other objects or the workspace boundary
+    if (!grid->refCounted() &&
+        std::any_of(begin(prev_objects), end(prev_objects), removed))
+    {
+        ROS_DEBUG_NAMED(PP_LOGGER, "   -> Objects removed from grid without reference counts");
+        return rebuild_grid();
+    }
+
+    ROS_DEBUG_NAMED(PP_LOGGER, "   -> Update persistent grid");
+    auto voxelize = [&](const collision_detection::World::Object& object)
+    {
+        std::vector<std::vector<Eigen::Vector3d>> voxelses; // , my precious
+        Eigen::Vector3d grid_origin;
+        grid_origin.x() = grid->originX();
+        grid_origin.y() = grid->originY();
+        grid_origin.z() = grid->originZ();
+        smpl::collision::VoxelizeObject(
+                object,
+                grid->resolution(),
+                grid_origin,
+                voxelses);
+        return voxelses;
+    };
+
+    auto remove_object = [&](const collision_detection::World::Object& object)
+    {
+        auto voxelses = voxelize(object);
+        for (auto& voxels : voxelses) {
+            grid->removePointsFromField(voxels);
         }
+    };
 
-        // Update objects that are in both scenes but whose properties have changed
-        for (auto it = wold_begin; it != wold_end; ++it) {
-            if (scene->getWorld()->hasObject(it->first)) {
-                remove_object(*it->second);
-                insert_object(*scene->getWorld()->getObject(it->first));
-            }
+    auto insert_object = [&](const collision_detection::World::Object& object)
+    {
+        auto voxelses = voxelize(object);
+        for (auto& voxels : voxelses) {
+            grid->addPointsToField(voxels);
         }
+    };
 
-        // Add objects that are in scene but not in prev_scene
-        for (auto it = wnew_begin; it != wnew_end; ++it) {
-            if (!context->m_prev_scene->getWorld()->hasObject(it->first)) {
-                insert_object(*it->second);
-            }
+    // Remove objects that have been removed or modified since the last update
+    int removed_count = 0;
+    for (auto& entry : prev_objects) {
+        if (removed(entry)) {
+            remove_object(*entry.second);
+            ++removed_count;
         }
+    }
 
-//        return std::move(grid);
-        return grid;
+    // Insert objects that have been added or modified since the last update
+    int inserted_count = 0;
+    for (auto it = world.begin(); it != world.end(); ++it) {
+        if (!unchanged(it->first)) {
+            insert_object(*it->second);
+            ++inserted_count;
+        }
     }
+
+    ROS_DEBUG_NAMED(PP_LOGGER, "   -> Removed %d and inserted %d objects", removed_count, inserted_count);
+
+    snapshot_world();
+    return grid;
 }
 
 bool InitPlanningParams(
@@ -275,6 +320,51 @@ bool InitPlanningParams(
     }
     pp->interpolate_path = config.at("interpolate_path") == "true";
 
+    {
+        auto it = config.find("shortcut_thread_count");
+        if (it != end(config)) {
+            try {
+                pp->shortcut_thread_count = std::max(1, std::stoi(it->second));
+            } catch (const std::logic_error&) { // thrown by std::stoi
+                ROS_WARN_NAMED(PP_LOGGER, "parameter 'shortcut_thread_count' is not an integer. defaulting to %d", smpl::PlanningParams::DefaultShortcutThreadCount);
+            }
+        }
+        it = config.find("shortcut_time_limit");
+        if (it != end(config)) {
+            try {
+                pp->shortcut_time_limit = std::stod(it->second);
+            } catch (const std::logic_error&) { // thrown by std::stod
+                ROS_WARN_NAMED(PP_LOGGER, "parameter 'shortcut_time_limit' is not a number. defaulting to %0.3f", smpl::PlanningParams::DefaultShortcutTimeLimit);
+            }
+        }
+    }
+
+    {
+        auto it = config.find("optimize_path_clearance");
+        pp->optimize_path_clearance = it != end(config) && it->second == "true";
+        it = config.find("clearance_margin");
+        if (it != end(config)) {
+            try {
+                pp->clearance_margin = std::stod(it->second);
+            } catch (const std::logic_error&) { // thrown by std::stod
+                ROS_WARN_NAMED(PP_LOGGER, "parameter 'clearance_margin' is not a number. defaulting to %0.3f", smpl::PlanningParams::DefaultClearanceMargin);
+            }
+        }
+    }
+
+    {
+        auto it = config.find("time_parameterize_path");
+        pp->time_parameterize_path = it != end(config) && it->second == "true";
+        it = config.find("time_parameterization_time_limit");
+        if (it != end(config)) {
+            try {
+                pp->time_parameterization_time_limit = std::stod(it->second);
+            } catch (const std::logic_error&) { // thrown by std::stod
+                ROS_WARN_NAMED(PP_LOGGER, "parameter 'time_parameterization_time_limit' is not a number. defaulting to %0.3f", smpl::PlanningParams::DefaultTimeParameterizationTimeLimit);
+            }
+        }
+    }
+
     //////////////////////////////
     // parse logging parameters //
     //////////////////////////////
@@ -288,6 +378,15 @@ bool InitPlanningParams(
         }
     }
 
+    {
+        auto it = config.find("trace_output_dir");
+        if (it != end(config)) {
+            pp->trace_output_dir = it->second;
+        } else {
+            pp->trace_output_dir.clear();
+        }
+    }
+
     //////////////////////////////////////////////
     // initialize structures against parameters //
     //////////////////////////////////////////////
@@ -531,7 +630,9 @@ auto CreateHeuristicGrid(
     // instantiating a full cspace here and using available voxels state
     // information for a more accurate heuristic
 
-    auto grid = smpl::make_unique<smpl::OccupancyGrid>(hdf);
+    // reference count cells so that objects may later be removed from the
+    // grid without clearing cells occupied by other objects
+    auto grid = smpl::make_unique<smpl::OccupancyGrid>(hdf, true);
     grid->setReferenceFrame(scene.getPlanningFrame());
 
     // temporary storage for collision shapes/objects
@@ -613,6 +714,21 @@ bool UpdatePlanner(
     }
     context->m_collision_checker->setPathConstraints(constraints);
 
+    // collision checkers are not thread-safe, so parallel shortcutting needs
+    // one per additional worker thread
+    context->m_shortcut_checkers.clear();
+    if (context->m_pp.shortcut_path) {
+        for (int i = 1; i < context->m_pp.shortcut_thread_count; ++i) {
+            auto checker = smpl::make_unique<MoveItCollisionChecker>();
+            if (!checker->init(context->m_robot_model, start_state, scene)) {
+                ROS_WARN_NAMED(PP_LOGGER, "Failed to initialize shortcut collision checker");
+                break;
+            }
+            checker->setPathConstraints(constraints);
+            context->m_shortcut_checkers.push_back(std::move(checker));
+        }
+    }
+
     // Create an occupancy grid (distance map) if required by the planner
     // TODO: this should be optional if a grid is not required by the planner
     if (true || context->m_use_grid) {
@@ -634,7 +750,12 @@ bool UpdatePlanner(
         return false;
     }
 
-    context->m_prev_scene = scene;
+    std::vector<smpl::CollisionChecker*> shortcut_checkers;
+    for (auto& checker : context->m_shortcut_checkers) {
+        shortcut_checkers.push_back(checker.get());
+    }
+    context->m_planner->setShortcutCheckers(shortcut_checkers);
+
     context->m_prev_workspace = workspace;
     return true;
 }
@@ -710,10 +831,12 @@ bool SBPLPlanningContext::solve(planning_interface::MotionPlanResponse& res)
         return false;
     }
 
-    ROS_DEBUG_NAMED(PP_LOGGER, "Convert planning scene to message type");
-    // translate planning scene to planning scene message
+    // The planner interface only consumes the robot state of the planning
+    // scene message; the world is pushed into the persistent grid by
+    // UpdatePlanner, so avoid serializing the complete scene
     moveit_msgs::PlanningScene scene_msg;
-    scene->getPlanningSceneMsg(scene_msg);
+    moveit::core::robotStateToRobotStateMsg(
+            scene->getCurrentState(), scene_msg.robot_state);
 
     ROS_DEBUG_NAMED(PP_LOGGER, "Solve!");
     moveit_msgs::MotionPlanResponse res_msg;
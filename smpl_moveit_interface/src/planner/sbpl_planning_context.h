@@ -5,8 +5,10 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 // system includes
+#include <moveit/collision_detection/world.h>
 #include <moveit/distance_field/propagation_distance_field.h>
 #include <moveit/macros/class_forward.h>
 #include <moveit/planning_interface/planning_interface.h>
@@ -63,6 +65,9 @@ public:
     MoveItRobotModel* m_robot_model;
     std::unique_ptr<MoveItCollisionChecker> m_collision_checker;
 
+    // independent checkers for the worker threads of parallel shortcutting
+    std::vector<std::unique_ptr<MoveItCollisionChecker>> m_shortcut_checkers;
+
     std::unique_ptr<smpl::OccupancyGrid> m_grid;
 
     std::unique_ptr<smpl::PlannerInterface> m_planner;
@@ -80,7 +85,11 @@ public:
     double m_grid_inflation_radius;
 
     moveit_msgs::WorkspaceParameters m_prev_workspace;
-    planning_scene::PlanningSceneConstPtr m_prev_scene;
+
+    // World objects the persistent grid was last updated with. World objects
+    // are copy-on-write, so an object modified since no longer shares its
+    // pointer with the corresponding object in the scene.
+    std::map<std::string, collision_detection::World::ObjectConstPtr> m_prev_world_objects;
 };
 
 MOVEIT_CLASS_FORWARD(SBPLPlanningContext);
@@ -7,7 +7,9 @@
 
 // system includes
 #include <Eigen/Dense>
+#include <ompl/base/MotionValidator.h>
 #include <ompl/base/Planner.h>
+#include <ompl/base/StateValidityChecker.h>
 
 #if OMPL_VERSION_VALUE >= 1004000  // Version greater than 1.4.0
 typedef Eigen::VectorXd OMPLProjection;
@@ -17,6 +19,7 @@ typedef ompl::base::EuclideanProjection OMPLProjection;
 
 namespace smpl {
 
+class CollisionChecker;
 class OccupancyGrid;
 
 namespace visual {
@@ -77,6 +80,49 @@ struct OMPLPlanner : public ompl::base::Planner
     friend struct detail::PlannerImpl;
 };
 
+/// \brief An OMPL state validity checker that forwards to an SMPL collision
+///     checker
+///
+/// When installed in the SpaceInformation given to an OMPLPlanner, the planner
+/// calls the SMPL collision checker directly, skipping the conversion of its
+/// states to OMPL states.
+struct SMPLStateValidityChecker : public ompl::base::StateValidityChecker
+{
+    smpl::CollisionChecker* checker;
+
+    SMPLStateValidityChecker(
+        const ompl::base::SpaceInformationPtr& si,
+        smpl::CollisionChecker* checker);
+
+    bool isValid(const ompl::base::State* state) const override;
+};
+
+/// \brief An OMPL motion validator that forwards whole motions to an SMPL
+///     collision checker
+///
+/// Motions are checked using CollisionChecker::isStateToStateValid, rather
+/// than by OMPL's state-by-state discretization, so that the collision checker
+/// may apply its own interpolation and ordering of checks. As with
+/// SMPLStateValidityChecker, an OMPLPlanner calls the SMPL collision checker
+/// directly when this validator is installed.
+struct SMPLMotionValidator : public ompl::base::MotionValidator
+{
+    smpl::CollisionChecker* checker;
+
+    SMPLMotionValidator(
+        const ompl::base::SpaceInformationPtr& si,
+        smpl::CollisionChecker* checker);
+
+    bool checkMotion(
+        const ompl::base::State* s1,
+        const ompl::base::State* s2) const override;
+
+    bool checkMotion(
+        const ompl::base::State* s1,
+        const ompl::base::State* s2,
+        std::pair<ompl::base::State*, double>& last_valid) const override;
+};
+
 auto MakeStateSMPL(
     const ompl::base::StateSpace* space,
     const ompl::base::State* state)
@@ -167,6 +167,21 @@ auto RobotModel::getExtension(size_t class_code) -> smpl::Extension*
 // CollisionChecker Implementation //
 /////////////////////////////////////
 
+// A state of a RealVectorStateSpace that aliases the memory of a RobotState,
+// rather than copying it, for passing to OMPL interfaces that only read the
+// state.
+struct RealVectorStateRef
+{
+    ompl::base::RealVectorStateSpace::StateType state;
+
+    explicit RealVectorStateRef(const smpl::RobotState& s)
+    {
+        state.values = const_cast<double*>(s.data());
+    }
+
+    auto get() const -> const ompl::base::State* { return &this->state; }
+};
+
 struct CollisionChecker : public smpl::CollisionChecker
 {
     ompl::base::StateSpace* space;
@@ -174,6 +189,16 @@ struct CollisionChecker : public smpl::CollisionChecker
     ompl::base::MotionValidator* validator;
     OMPLPlanner::VisualizerFun visualizer;
 
+    // SMPL collision checkers behind the OMPL state validity checker and
+    // motion validator, if those are SMPL bridges, to call directly
+    smpl::CollisionChecker* smpl_checker = NULL;
+    smpl::CollisionChecker* smpl_validator = NULL;
+
+    // whether states may be passed to OMPL as RealVectorStateRefs
+    bool real_vector_space = false;
+
+    void bind(ompl::base::SpaceInformation* si);
+
     /// \name smpl::CollisionChecker Interface
     ///@{
     bool isStateValid(
@@ -200,10 +225,35 @@ struct CollisionChecker : public smpl::CollisionChecker
     ///@}
 };
 
+void CollisionChecker::bind(ompl::base::SpaceInformation* si)
+{
+    this->space = si->getStateSpace().get();
+    this->checker = si->getStateValidityChecker().get();
+    this->validator = si->getMotionValidator().get();
+
+    auto* smpl_checker = dynamic_cast<SMPLStateValidityChecker*>(this->checker);
+    this->smpl_checker = smpl_checker != NULL ? smpl_checker->checker : NULL;
+
+    auto* smpl_validator = dynamic_cast<SMPLMotionValidator*>(this->validator);
+    this->smpl_validator = smpl_validator != NULL ? smpl_validator->checker : NULL;
+
+    this->real_vector_space =
+            dynamic_cast<ompl::base::RealVectorStateSpace*>(this->space) != NULL;
+}
+
 bool CollisionChecker::isStateValid(
     const smpl::RobotState& state,
     bool verbose)
 {
+    if (this->smpl_checker != NULL) {
+        return this->smpl_checker->isStateValid(state, verbose);
+    }
+
+    if (this->real_vector_space) {
+        RealVectorStateRef s(state);
+        return this->checker->isValid(s.get());
+    }
+
     auto* s = MakeStateOMPL(this->space, state);
     DEFER(this->space->freeState(s));
     return this->checker->isValid(s);
@@ -214,6 +264,16 @@ bool CollisionChecker::isStateToStateValid(
     const smpl::RobotState& finish,
     bool verbose)
 {
+    if (this->smpl_validator != NULL) {
+        return this->smpl_validator->isStateToStateValid(start, finish, verbose);
+    }
+
+    if (this->real_vector_space) {
+        RealVectorStateRef s(start);
+        RealVectorStateRef f(finish);
+        return this->validator->checkMotion(s.get(), f.get());
+    }
+
     auto* s = MakeStateOMPL(this->space, start);
     auto* f = MakeStateOMPL(this->space, finish);
     DEFER(this->space->freeState(s));
@@ -477,9 +537,7 @@ PlannerImpl::PlannerImpl(
     // Initialize Collision Checker Interface //
     ////////////////////////////////////////////
 
-    this->checker.space = planner->getSpaceInformation()->getStateSpace().get();
-    this->checker.checker = planner->getSpaceInformation()->getStateValidityChecker().get();
-    this->checker.validator = planner->getSpaceInformation()->getMotionValidator().get();
+    this->checker.bind(planner->getSpaceInformation().get());
 
     //////////////////////////////
     // Initialize Manip Lattice //
@@ -688,6 +746,24 @@ PlannerImpl::PlannerImpl(
         planner->params().declareParam<double>("short_dist_mprims_thresh", set, get);
     }
 
+    {
+        auto set = [&](bool val) { this->actions->useJacobianTables(val); };
+        auto get = [&]() { return this->actions->useJacobianTables(); };
+        planner->params().declareParam<bool>("use_jacobian_tables", set, get);
+    }
+
+    {
+        auto set = [&](double val) { this->actions->jacobianRegionSize(val); };
+        auto get = [&]() { return this->actions->jacobianRegionSize(); };
+        planner->params().declareParam<double>("jacobian_region_size", set, get);
+    }
+
+    {
+        auto set = [&](double val) { this->actions->snapJointDeltaThresh(val); };
+        auto get = [&]() { return this->actions->snapJointDeltaThresh(); };
+        planner->params().declareParam<double>("snap_joint_delta_thresh", set, get);
+    }
+
     {
         auto set = [&](bool val) { this->actions->useMultipleIkSolutions(val); };
         auto get = [&]() { return this->actions->useMultipleIkSolutions(); };
@@ -710,6 +786,12 @@ PlannerImpl::PlannerImpl(
                 auto get = [bfs_heuristic]() { return bfs_heuristic->costPerCell(); };
                 planner->params().declareParam<int>("bfs_cost_per_cell", set, get);
             }
+
+            {
+                auto set = [bfs_heuristic](bool val) { bfs_heuristic->setLazySearchEnabled(val); };
+                auto get = [bfs_heuristic]() { return bfs_heuristic->lazySearchEnabled(); };
+                planner->params().declareParam<bool>("bfs_lazy_search", set, get);
+            }
         }
     }
 
@@ -1019,6 +1101,10 @@ void PlannerImpl::setup(OMPLPlanner* planner)
 {
     SMPL_DEBUG("Planner::setup");
     planner->ompl::base::Planner::setup();
+
+    // the validity checker and motion validator may have been replaced, or
+    // only been created, during setup of the space information
+    this->checker.bind(planner->getSpaceInformation().get());
 }
 
 void PlannerImpl::checkValidity(OMPLPlanner* planner)
@@ -1054,6 +1140,15 @@ auto PlannerImpl::makeJointDistEGraphHeuristic(
         return nullptr;
     }
 
+    // the joint distance heuristic is the truncated, scaled euclidean
+    // distance in joint space, so index experience graph nodes by it
+    auto* jd = &h->jd;
+    h->setNodeMetric(
+            [jd](const RobotState& a, const RobotState& b) {
+                return jd->computeJointDistance(a, b);
+            },
+            JointDistHeuristic::FIXED_POINT_RATIO);
+
     double egw = 1.0;
     // params.param("egraph_epsilon", egw, 1.0);
     h->setWeightEGraph(egw);
@@ -1164,6 +1259,101 @@ void OMPLPlanner::getPlannerData(ompl::base::PlannerData& data) const
     return m_impl->getPlannerData(this, data);
 }
 
+// Copy an OMPL state into one of a set of per-thread RobotStates, reusing
+// its storage across calls.
+static
+auto MakeScratchStateSMPL(
+    const ompl::base::StateSpace* space,
+    const ompl::base::State* state,
+    int slot)
+    -> const smpl::RobotState&
+{
+    static thread_local smpl::RobotState scratch[2];
+    auto& s = scratch[slot];
+    auto* real_space = dynamic_cast<const ompl::base::RealVectorStateSpace*>(space);
+    if (real_space != NULL) {
+        auto* values = state->as<ompl::base::RealVectorStateSpace::StateType>()->values;
+        s.assign(values, values + real_space->getDimension());
+    } else {
+        space->copyToReals(s, state);
+    }
+    return s;
+}
+
+SMPLStateValidityChecker::SMPLStateValidityChecker(
+    const ompl::base::SpaceInformationPtr& si,
+    smpl::CollisionChecker* checker)
+:
+    ompl::base::StateValidityChecker(si),
+    checker(checker)
+{
+}
+
+bool SMPLStateValidityChecker::isValid(const ompl::base::State* state) const
+{
+    auto& s = MakeScratchStateSMPL(si_->getStateSpace().get(), state, 0);
+    return this->checker->isStateValid(s);
+}
+
+SMPLMotionValidator::SMPLMotionValidator(
+    const ompl::base::SpaceInformationPtr& si,
+    smpl::CollisionChecker* checker)
+:
+    ompl::base::MotionValidator(si),
+    checker(checker)
+{
+}
+
+bool SMPLMotionValidator::checkMotion(
+    const ompl::base::State* s1,
+    const ompl::base::State* s2) const
+{
+    auto* space = si_->getStateSpace().get();
+    auto& start = MakeScratchStateSMPL(space, s1, 0);
+    auto& finish = MakeScratchStateSMPL(space, s2, 1);
+    if (this->checker->isStateToStateValid(start, finish)) {
+        ++valid_;
+        return true;
+    } else {
+        ++invalid_;
+        return false;
+    }
+}
+
+bool SMPLMotionValidator::checkMotion(
+    const ompl::base::State* s1,
+    const ompl::base::State* s2,
+    std::pair<ompl::base::State*, double>& last_valid) const
+{
+    if (checkMotion(s1, s2)) {
+        return true;
+    }
+
+    // The motion is known to be invalid; walk it at the resolution of the
+    // state space to report how far along it remains valid. Mirrors
+    // ompl::base::DiscreteMotionValidator.
+    auto* space = si_->getStateSpace().get();
+    auto count = space->validSegmentCount(s1, s2);
+
+    auto* test = si_->allocState();
+    DEFER(si_->freeState(test));
+
+    auto j = 1u;
+    for (; j < count; ++j) {
+        space->interpolate(s1, s2, (double)j / (double)count, test);
+        auto& s = MakeScratchStateSMPL(space, test, 0);
+        if (!this->checker->isStateValid(s)) {
+            break;
+        }
+    }
+
+    last_valid.second = (double)(j - 1) / (double)count;
+    if (last_valid.first != NULL) {
+        space->interpolate(s1, s2, last_valid.second, last_valid.first);
+    }
+    return false;
+}
+
 auto MakeStateSMPL(
     const ompl::base::StateSpace* space,
     const ompl::base::State* state)
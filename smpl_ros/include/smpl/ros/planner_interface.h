@@ -130,6 +130,22 @@ public:
     /// @return The statistics
     auto getPlannerStats() -> std::map<std::string, double>;
 
+    /// \brief Provide collision checkers for parallel path shortcutting
+    ///
+    /// Collision checkers are not required to be thread-safe, so each worker
+    /// thread, beyond the one using the planning checker, requires a distinct
+    /// checker over the same world. At most shortcut_thread_count - 1 of these
+    /// are used.
+    void setShortcutCheckers(const std::vector<CollisionChecker*>& checkers);
+
+    /// \brief Add a blob to every search trace recorded by solve()
+    ///
+    /// Traces record the planning scene, the request, the occupancy grid, the
+    /// planning parameters, and the planning joints. Use this to record the
+    /// remainder of the configuration needed to replay a query, e.g. the robot
+    /// description and the collision model, which are unknown to the planner.
+    void setTraceBlob(const std::string& name, const std::string& data);
+
     /// \name Visualization
     ///@{
 
@@ -146,6 +162,12 @@ protected:
     CollisionChecker* m_checker;
     OccupancyGrid* m_grid;
 
+    // additional checkers for parallel shortcutting
+    std::vector<CollisionChecker*> m_shortcut_checkers;
+
+    // caller-provided configuration recorded in search traces
+    std::map<std::string, std::string> m_trace_blobs;
+
     ForwardKinematicsInterface* m_fk_iface;
 
     PlanningParams m_params;
@@ -182,6 +204,10 @@ protected:
 
     bool reinitPlanner(const std::string& planner_id);
 
+    void shortcutPath(
+        const std::vector<RobotState>& pin,
+        std::vector<RobotState>& pout) const;
+
     void postProcessPath(std::vector<RobotState>& path) const;
 };
 
@@ -1,5 +1,8 @@
 #include <smpl/ros/factories.h>
 
+// standard includes
+#include <limits>
+
 // system includes
 #include <smpl/console/console.h>
 #include <smpl/console/nonstd.h>
@@ -41,6 +44,9 @@ struct ManipLatticeActionSpaceParams
     double rpy_snap_thresh;
     double xyzrpy_snap_thresh;
     double short_dist_mprims_thresh;
+    bool use_jacobian_tables;
+    double jacobian_region_size;
+    double snap_joint_delta_thresh;
 };
 
 // Lookup parameters for ManipLatticeActionSpace, setting reasonable defaults
@@ -66,6 +72,10 @@ bool GetManipLatticeActionSpaceParams(
     pp.param("rpy_snap_dist_thresh", params.rpy_snap_thresh, 0.0);
     pp.param("xyzrpy_snap_dist_thresh", params.xyzrpy_snap_thresh, 0.0);
     pp.param("short_dist_mprims_thresh", params.short_dist_mprims_thresh, 0.0);
+
+    pp.param("use_jacobian_tables", params.use_jacobian_tables, false);
+    pp.param("jacobian_region_size", params.jacobian_region_size, 0.1);
+    pp.param("snap_joint_delta_thresh", params.snap_joint_delta_thresh, std::numeric_limits<double>::infinity());
     return true;
 }
 
@@ -191,6 +201,9 @@ auto MakeManipLattice(
     actions.ampThresh(MotionPrimitive::SNAP_TO_RPY, action_params.rpy_snap_thresh);
     actions.ampThresh(MotionPrimitive::SNAP_TO_XYZ_RPY, action_params.xyzrpy_snap_thresh);
     actions.ampThresh(MotionPrimitive::SHORT_DISTANCE, action_params.short_dist_mprims_thresh);
+    actions.useJacobianTables(action_params.use_jacobian_tables);
+    actions.jacobianRegionSize(action_params.jacobian_region_size);
+    actions.snapJointDeltaThresh(action_params.snap_joint_delta_thresh);
 
     if (!actions.load(action_params.mprim_filename)) {
         SMPL_ERROR("Failed to load actions from file '%s'", action_params.mprim_filename.c_str());
@@ -287,6 +300,9 @@ auto MakeManipLatticeEGraph(
     actions.ampThresh(MotionPrimitive::SNAP_TO_RPY, action_params.rpy_snap_thresh);
     actions.ampThresh(MotionPrimitive::SNAP_TO_XYZ_RPY, action_params.xyzrpy_snap_thresh);
     actions.ampThresh(MotionPrimitive::SHORT_DISTANCE, action_params.short_dist_mprims_thresh);
+    actions.useJacobianTables(action_params.use_jacobian_tables);
+    actions.jacobianRegionSize(action_params.jacobian_region_size);
+    actions.snapJointDeltaThresh(action_params.snap_joint_delta_thresh);
     if (!actions.load(action_params.mprim_filename)) {
         SMPL_ERROR("Failed to load actions from file '%s'", action_params.mprim_filename.c_str());
         return nullptr;
@@ -359,6 +375,12 @@ bool GetWorkspaceLatticeParams(
         }
     }
 
+    // optional ik cache configuration
+    params.getParam("ik_cache_size", wsp->ik_cache_size);
+    params.getParam("ik_cache_seed_res", wsp->ik_cache_seed_res);
+    params.getParam("ik_cache_position_tolerance", wsp->ik_cache_position_tolerance);
+    params.getParam("ik_cache_orientation_tolerance", wsp->ik_cache_orientation_tolerance);
+
     return true;
 }
 
@@ -493,6 +515,9 @@ auto MakeMultiFrameBFSHeuristic(
     double inflation_radius;
     params.param("bfs_inflation_radius", inflation_radius, 0.0);
     h->setInflationRadius(inflation_radius);
+    bool lazy_search;
+    params.param("bfs_lazy_search", lazy_search, false);
+    h->setLazySearchEnabled(lazy_search);
     if (!h->init(space, grid)) {
         return nullptr;
     }
@@ -517,6 +542,9 @@ auto MakeBFSHeuristic(
     double inflation_radius;
     params.param("bfs_inflation_radius", inflation_radius, 0.0);
     h->setInflationRadius(inflation_radius);
+    bool lazy_search;
+    params.param("bfs_lazy_search", lazy_search, false);
+    h->setLazySearchEnabled(lazy_search);
     if (!h->init(space, grid)) {
         return nullptr;
     }
@@ -592,10 +620,23 @@ auto MakeJointDistEGraphHeuristic(
     };
 
     auto h = make_unique<JointDistEGraphHeuristic>();
+    if (!h->jd.init(space)) {
+        return nullptr;
+    }
+
     if (!h->init(space, &h->jd)) {
         return nullptr;
     }
 
+    // the joint distance heuristic is the truncated, scaled euclidean
+    // distance in joint space, so index experience graph nodes by it
+    auto* jd = &h->jd;
+    h->setNodeMetric(
+            [jd](const RobotState& a, const RobotState& b) {
+                return jd->computeJointDistance(a, b);
+            },
+            JointDistHeuristic::FIXED_POINT_RATIO);
+
     double egw;
     params.param("egraph_epsilon", egw, 1.0);
     h->setWeightEGraph(egw);
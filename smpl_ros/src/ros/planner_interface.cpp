@@ -37,6 +37,8 @@
 #include <algorithm>
 #include <fstream>
 #include <chrono>
+#include <limits>
+#include <sstream>
 #include <utility>
 
 // system includes
@@ -45,6 +47,7 @@
 #include <boost/regex.hpp>
 #include <eigen_conversions/eigen_msg.h>
 #include <leatherman/utils.h>
+#include <ros/serialization.h>
 #include <sbpl/planners/mhaplanner.h>
 #include <smpl/angles.h>
 #include <smpl/console/console.h>
@@ -54,6 +57,8 @@
 #include <smpl/heuristic/egraph_bfs_heuristic.h>
 #include <smpl/heuristic/multi_frame_bfs_heuristic.h>
 #include <smpl/post_processing.h>
+#include <smpl/search/arastar.h>
+#include <smpl/search/search_trace.h>
 #include <smpl/stl/memory.h>
 #include <smpl/time.h>
 #include <smpl/types.h>
@@ -295,7 +300,10 @@ bool PlannerInterface::init(const PlanningParams& params)
 
     SMPL_INFO_NAMED(PI_LOGGER, "  Shortcut Path: %s", params.shortcut_path ? "true" : "false");
     SMPL_INFO_NAMED(PI_LOGGER, "  Shortcut Type: %s", to_string(params.shortcut_type).c_str());
+    SMPL_INFO_NAMED(PI_LOGGER, "  Shortcut Thread Count: %d", params.shortcut_thread_count);
     SMPL_INFO_NAMED(PI_LOGGER, "  Interpolate Path: %s", params.interpolate_path ? "true" : "false");
+    SMPL_INFO_NAMED(PI_LOGGER, "  Optimize Path Clearance: %s", params.optimize_path_clearance ? "true" : "false");
+    SMPL_INFO_NAMED(PI_LOGGER, "  Time Parameterize Path: %s", params.time_parameterize_path ? "true" : "false");
 
     if (!m_robot) {
         SMPL_ERROR("Robot Model given to Arm Planner Interface must be non-null");
@@ -508,6 +516,29 @@ void ProfilePath(RobotModel* robot, trajectory_msgs::JointTrajectory& traj)
     }
 }
 
+static
+bool TimeParameterizeTrajectory(
+    RobotModel* robot,
+    const std::vector<RobotState>& path,
+    double time_limit,
+    moveit_msgs::RobotTrajectory& traj)
+{
+    std::vector<double> times;
+    if (!ComputeTimeOptimalParameterization(robot, path, times, time_limit)) {
+        return false;
+    }
+
+    auto& points = traj.joint_trajectory.points;
+    for (size_t i = 0; i < points.size() && i < times.size(); ++i) {
+        points[i].time_from_start = ros::Duration(times[i]);
+    }
+    auto& md_points = traj.multi_dof_joint_trajectory.points;
+    for (size_t i = 0; i < md_points.size() && i < times.size(); ++i) {
+        md_points[i].time_from_start = ros::Duration(times[i]);
+    }
+    return true;
+}
+
 static
 void RemoveZeroDurationSegments(trajectory_msgs::JointTrajectory& traj)
 {
@@ -689,6 +720,88 @@ bool WritePath(
     return true;
 }
 
+// Open a new search trace in the given directory, creating the directory if
+// it does not exist.
+static
+bool OpenTrace(SearchTraceWriter& trace, const std::string& dir)
+{
+    boost::filesystem::path p(dir);
+
+    try {
+        if (!boost::filesystem::exists(p)) {
+            SMPL_INFO("Create trace output directory %s", p.native().c_str());
+            boost::filesystem::create_directory(p);
+        }
+
+        if (!boost::filesystem::is_directory(p)) {
+            SMPL_ERROR("Failed to record trace. %s is not a directory", dir.c_str());
+            return false;
+        }
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        SMPL_ERROR("Failed to create trace output directory %s", p.native().c_str());
+        return false;
+    }
+
+    std::stringstream ss_filename;
+    ss_filename << "trace_" << clock::now().time_since_epoch().count() << ".smpltrace";
+    p /= ss_filename.str();
+
+    SMPL_INFO("Record search trace to %s", p.native().c_str());
+    return trace.open(p.native());
+}
+
+// Record a serialized message in a trace, as a blob named after the message
+// type, e.g. "moveit_msgs/MotionPlanRequest"
+template <class Message>
+static
+void WriteMessageBlob(SearchTraceWriter& trace, const Message& msg)
+{
+    auto size = ros::serialization::serializationLength(msg);
+    std::vector<std::uint8_t> buffer(size);
+    ros::serialization::OStream stream(buffer.data(), size);
+    ros::serialization::serialize(stream, msg);
+    trace.writeBlob(
+            ros::message_traits::DataType<Message>::value(),
+            buffer.data(),
+            buffer.size());
+}
+
+// Record the geometry of the occupancy grid and its occupied voxels, so that
+// a replay can rebuild the same grid
+static
+void WriteGridBlobs(SearchTraceWriter& trace, const OccupancyGrid& grid)
+{
+    auto format = [](double d)
+    {
+        std::stringstream ss;
+        ss.precision(std::numeric_limits<double>::max_digits10);
+        ss << d;
+        return ss.str();
+    };
+
+    std::map<std::string, std::string> geometry;
+    geometry["origin_x"] = format(grid.originX());
+    geometry["origin_y"] = format(grid.originY());
+    geometry["origin_z"] = format(grid.originZ());
+    geometry["size_x"] = format(grid.sizeX());
+    geometry["size_y"] = format(grid.sizeY());
+    geometry["size_z"] = format(grid.sizeZ());
+    geometry["resolution"] = format(grid.resolution());
+    geometry["max_distance"] = format(
+            grid.getDistanceField()->getUninitializedDistance());
+    geometry["ref_counted"] = grid.refCounted() ? "true" : "false";
+    geometry["frame_id"] = grid.getReferenceFrame();
+    auto data = EncodeTraceProperties(geometry);
+    trace.writeBlob("smpl/OccupancyGrid", data.data(), data.size());
+
+    std::vector<Vector3> voxels;
+    grid.getOccupiedVoxels(voxels);
+    trace.writeBlob(
+            "smpl/OccupiedVoxels",
+            voxels.data(),
+            voxels.size() * sizeof(Vector3));
+}
+
 bool PlannerInterface::solve(
     // TODO: this planning scene is probably not being used in any meaningful way
     const moveit_msgs::PlanningScene& planning_scene,
@@ -737,8 +850,47 @@ bool PlannerInterface::solve(
         return false;
     }
 
+    // record the scene, the request, and the search so that this query can
+    // be replayed offline
+    SearchTraceWriter trace;
+    auto* traced_search = dynamic_cast<ARAStar*>(m_planner.get());
+    if (!m_params.trace_output_dir.empty()) {
+        if (traced_search == NULL) {
+            SMPL_WARN_NAMED(PI_LOGGER, "Search for planner '%s' does not support tracing", req.planner_id.c_str());
+        } else if (OpenTrace(trace, m_params.trace_output_dir)) {
+            WriteMessageBlob(trace, planning_scene);
+            WriteMessageBlob(trace, req);
+
+            // the world is only fully described by the occupancy grid
+            WriteGridBlobs(trace, *m_grid);
+
+            auto params = m_params.serialize();
+            trace.writeBlob("smpl/PlanningParams", params.data(), params.size());
+
+            std::map<std::string, std::string> robot;
+            for (auto& joint : m_robot->getPlanningJoints()) {
+                robot["planning_joints"] += joint + " ";
+            }
+            auto robot_data = EncodeTraceProperties(robot);
+            trace.writeBlob("smpl/RobotModel", robot_data.data(), robot_data.size());
+
+            for (auto& blob : m_trace_blobs) {
+                trace.writeBlob(blob.first, blob.second.data(), blob.second.size());
+            }
+
+            traced_search->setTrace(&trace);
+        }
+    }
+
     std::vector<RobotState> path;
-    if (!plan(req.allowed_planning_time, path)) {
+    auto planned = plan(req.allowed_planning_time, path);
+
+    if (trace.isOpen()) {
+        traced_search->setTrace(NULL);
+        trace.close();
+    }
+
+    if (!planned) {
         SMPL_ERROR("Failed to plan within alotted time frame (%0.2f seconds, %d expansions)", req.allowed_planning_time, m_planner->get_n_expands());
         res.planning_time = to_seconds(clock::now() - then);
         res.error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
@@ -783,7 +935,15 @@ bool PlannerInterface::solve(
         WritePath(m_robot, res.trajectory_start, res.trajectory, m_params.plan_output_dir);
     }
 
-    ProfilePath(m_robot, res.trajectory.joint_trajectory);
+    if (!m_params.time_parameterize_path ||
+        !TimeParameterizeTrajectory(
+                m_robot,
+                path,
+                m_params.time_parameterization_time_limit,
+                res.trajectory))
+    {
+        ProfilePath(m_robot, res.trajectory.joint_trajectory);
+    }
 //    RemoveZeroDurationSegments(traj);
 
     res.planning_time = to_seconds(clock::now() - then);
@@ -1449,6 +1609,48 @@ bool PlannerInterface::reinitPlanner(const std::string& planner_id)
     return true;
 }
 
+void PlannerInterface::setTraceBlob(
+    const std::string& name,
+    const std::string& data)
+{
+    m_trace_blobs[name] = data;
+}
+
+void PlannerInterface::setShortcutCheckers(
+    const std::vector<CollisionChecker*>& checkers)
+{
+    m_shortcut_checkers = checkers;
+}
+
+void PlannerInterface::shortcutPath(
+    const std::vector<RobotState>& pin,
+    std::vector<RobotState>& pout) const
+{
+    if (m_params.shortcut_thread_count <= 1 ||
+        m_params.shortcut_type != ShortcutType::JOINT_SPACE)
+    {
+        ShortcutPath(m_robot, m_checker, pin, pout, m_params.shortcut_type);
+        return;
+    }
+
+    // collision checkers need not be thread-safe, so each worker thread
+    // requires its own
+    std::vector<CollisionChecker*> checkers = { m_checker };
+    for (CollisionChecker* cc : m_shortcut_checkers) {
+        if (checkers.size() >= (size_t)m_params.shortcut_thread_count) {
+            break;
+        }
+        if (cc != m_checker) {
+            checkers.push_back(cc);
+        }
+    }
+    if (checkers.size() < (size_t)m_params.shortcut_thread_count) {
+        SMPL_WARN_ONCE_NAMED(PI_LOGGER, "Shortcutting with %zu of %d threads; register independent collision checkers with setShortcutCheckers()", checkers.size(), m_params.shortcut_thread_count);
+    }
+
+    ParallelShortcutPath(m_robot, checkers, pin, pout, m_params.shortcut_time_limit);
+}
+
 void PlannerInterface::postProcessPath(std::vector<RobotState>& path) const
 {
     // shortcut path
@@ -1457,11 +1659,20 @@ void PlannerInterface::postProcessPath(std::vector<RobotState>& path) const
             SMPL_WARN_NAMED(PI_LOGGER, "Failed to interpolate planned path with %zu waypoints before shortcutting.", path.size());
             std::vector<RobotState> ipath = path;
             path.clear();
-            ShortcutPath(m_robot, m_checker, ipath, path, m_params.shortcut_type);
+            shortcutPath(ipath, path);
         } else {
             std::vector<RobotState> ipath = path;
             path.clear();
-            ShortcutPath(m_robot, m_checker, ipath, path, m_params.shortcut_type);
+            shortcutPath(ipath, path);
+        }
+    }
+
+    // push path away from obstacles
+    if (m_params.optimize_path_clearance) {
+        PathClearanceParams clearance_params;
+        clearance_params.margin = m_params.clearance_margin;
+        if (!OptimizePathClearance(m_robot, m_checker, path, clearance_params)) {
+            SMPL_WARN_NAMED(PI_LOGGER, "Failed to optimize path clearance");
         }
     }
 
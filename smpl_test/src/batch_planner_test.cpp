@@ -0,0 +1,311 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#define BOOST_TEST_MODULE BatchPlannerTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// system includes
+#include <smpl/batch_planner.h>
+#include <smpl/collision_checker.h>
+#include <smpl/graph/manip_lattice.h>
+#include <smpl/graph/manip_lattice_action_space.h>
+#include <smpl/heuristic/joint_dist_heuristic.h>
+#include <smpl/robot_model.h>
+#include <smpl/search/arastar.h>
+
+// A point that translates freely within the unit square
+class PointRobotModel : public smpl::RobotModel
+{
+public:
+
+    PointRobotModel() { setPlanningJoints({ "x", "y" }); }
+
+    double minPosLimit(int jidx) const override { return 0.0; }
+    double maxPosLimit(int jidx) const override { return 1.0; }
+    bool hasPosLimit(int jidx) const override { return true; }
+    bool isContinuous(int jidx) const override { return false; }
+    double velLimit(int jidx) const override { return 1.0; }
+    double accLimit(int jidx) const override { return 1.0; }
+
+    bool checkJointLimits(const smpl::RobotState& state, bool verbose = false) override
+    {
+        for (auto v : state) {
+            if (v < 0.0 || v > 1.0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto getExtension(size_t class_code) -> smpl::Extension* override
+    {
+        return NULL;
+    }
+};
+
+// Collision checking for a PointRobotModel against an axis-aligned box. Each
+// instance counts its checks, without synchronization, as a stateful checker
+// would, so instances must not be shared between threads.
+class BoxCollisionChecker : public smpl::CollisionChecker
+{
+public:
+
+    BoxCollisionChecker(double min_x, double min_y, double max_x, double max_y) :
+        m_min_x(min_x), m_min_y(min_y), m_max_x(max_x), m_max_y(max_y)
+    { }
+
+    int check_count = 0;
+
+    bool isStateValid(const smpl::RobotState& state, bool verbose = false) override
+    {
+        ++check_count;
+        return state[0] < m_min_x || state[0] > m_max_x ||
+                state[1] < m_min_y || state[1] > m_max_y;
+    }
+
+    bool isStateToStateValid(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        bool verbose = false) override
+    {
+        std::vector<smpl::RobotState> path;
+        return interpolatePath(start, finish, path) &&
+                std::all_of(path.begin(), path.end(),
+                        [&](const smpl::RobotState& s) { return isStateValid(s); });
+    }
+
+    bool interpolatePath(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        std::vector<smpl::RobotState>& path) override
+    {
+        const double step = 0.005;
+        const double len = std::hypot(finish[0] - start[0], finish[1] - start[1]);
+        const int count = std::max(1, (int)std::ceil(len / step));
+        path.clear();
+        for (int k = 0; k <= count; ++k) {
+            const double alpha = (double)k / (double)count;
+            path.push_back({
+                start[0] + alpha * (finish[0] - start[0]),
+                start[1] + alpha * (finish[1] - start[1]) });
+        }
+        return true;
+    }
+
+    auto getExtension(size_t class_code) -> smpl::Extension* override
+    {
+        if (class_code == smpl::GetClassCode<smpl::CollisionChecker>()) {
+            return this;
+        }
+        return NULL;
+    }
+
+private:
+
+    double m_min_x;
+    double m_min_y;
+    double m_max_x;
+    double m_max_y;
+};
+
+// couples the lifetime of the lattice and its action space
+struct PointLattice : public smpl::ManipLattice
+{
+    smpl::ManipLatticeActionSpace actions;
+};
+
+// Construct a worker that searches a lattice over the unit square, with its
+// own collision checker, for the first solution found by weighted A*. The
+// lattice is cleared before each query so that results do not depend on the
+// order in which queries are handed out to workers.
+bool MakeWorker(smpl::RobotModel* robot, smpl::BatchPlannerWorker& worker)
+{
+    auto checker = std::make_shared<BoxCollisionChecker>(0.3, 0.2, 0.7, 0.8);
+    worker.context = checker;
+
+    auto space = std::unique_ptr<PointLattice>(new PointLattice);
+    if (!space->init(robot, checker.get(), { 0.05, 0.05 }, &space->actions) ||
+        !space->actions.init(space.get()))
+    {
+        return false;
+    }
+    space->actions.addMotionPrim({ 0.05, 0.0 }, false);
+    space->actions.addMotionPrim({ 0.0, 0.05 }, false);
+    space->actions.addMotionPrim({ 0.05, 0.05 }, false);
+    space->actions.addMotionPrim({ 0.05, -0.05 }, false);
+
+    auto heuristic = std::unique_ptr<smpl::JointDistHeuristic>(
+            new smpl::JointDistHeuristic);
+    if (!heuristic->init(space.get()) ||
+        !space->insertHeuristic(heuristic.get()))
+    {
+        return false;
+    }
+
+    auto search = std::unique_ptr<smpl::ARAStar>(
+            new smpl::ARAStar(space.get(), heuristic.get()));
+    search->set_initialsolution_eps(2.0);
+    search->set_search_mode(true);
+    search->setImproveSolution(false);
+
+    auto* lattice = space.get();
+    worker.clear_states = [lattice]() { lattice->clearStates(); };
+
+    worker.space = std::move(space);
+    worker.heuristics.push_back(std::move(heuristic));
+    worker.search = std::move(search);
+    return true;
+}
+
+auto MakeQuery(double sx, double sy, double gx, double gy) -> smpl::PlanningQuery
+{
+    smpl::PlanningQuery query;
+    query.start = { sx, sy };
+    query.goal.type = smpl::GoalType::JOINT_STATE_GOAL;
+    query.goal.angles = { gx, gy };
+    query.goal.angle_tolerances = { 0.025, 0.025 };
+    query.allowed_time = 10.0;
+    return query;
+}
+
+// Queries of varying difficulty around the box, including one whose goal lies
+// within the box and so must exhaust the reachable states before failing
+auto MakeQueries() -> std::vector<smpl::PlanningQuery>
+{
+    std::vector<smpl::PlanningQuery> queries;
+    for (int i = 0; i <= 4; ++i) {
+        queries.push_back(MakeQuery(0.1, 0.1 + 0.2 * i, 0.9, 0.9 - 0.2 * i));
+        queries.push_back(MakeQuery(0.1 + 0.2 * i, 0.05, 0.9 - 0.2 * i, 0.95));
+    }
+    queries.push_back(MakeQuery(0.5, 0.1, 0.5, 0.9));
+    queries.push_back(MakeQuery(0.8, 0.5, 0.2, 0.5));
+    queries.push_back(MakeQuery(0.1, 0.1, 0.15, 0.1));
+    queries.push_back(MakeQuery(0.1, 0.5, 0.5, 0.5));
+    return queries;
+}
+
+void CheckResultsEqual(
+    const std::vector<smpl::PlanningQueryResult>& expected,
+    const std::vector<smpl::PlanningQueryResult>& actual)
+{
+    BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        BOOST_TEST_CONTEXT("query " << i) {
+            BOOST_CHECK_EQUAL(expected[i].solved, actual[i].solved);
+            BOOST_CHECK_EQUAL(expected[i].cost, actual[i].cost);
+            BOOST_CHECK_EQUAL(expected[i].expansions, actual[i].expansions);
+            BOOST_CHECK_EQUAL(expected[i].solution_eps, actual[i].solution_eps);
+            BOOST_REQUIRE_EQUAL(expected[i].path.size(), actual[i].path.size());
+            for (size_t j = 0; j < expected[i].path.size(); ++j) {
+                BOOST_CHECK(expected[i].path[j] == actual[i].path[j]);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MultipleWorkersMatchSingleWorkerTest)
+{
+    PointRobotModel robot;
+    auto factory = [&](int, smpl::BatchPlannerWorker& worker)
+    {
+        return MakeWorker(&robot, worker);
+    };
+
+    auto queries = MakeQueries();
+
+    smpl::BatchPlanner single;
+    BOOST_REQUIRE(single.init(1, factory));
+    std::vector<smpl::PlanningQueryResult> expected;
+    BOOST_REQUIRE(single.solve(queries, expected));
+
+    // all but the query whose goal is in collision are solvable
+    auto num_solved = std::count_if(expected.begin(), expected.end(),
+            [](const smpl::PlanningQueryResult& r) { return r.solved; });
+    BOOST_CHECK_EQUAL(num_solved, queries.size() - 1);
+
+    smpl::BatchPlanner multi;
+    BOOST_REQUIRE(multi.init(4, factory));
+    BOOST_REQUIRE_EQUAL(multi.numWorkers(), 4);
+
+    // workers persist, with their state, across batches
+    for (int round = 0; round < 3; ++round) {
+        std::vector<smpl::PlanningQueryResult> actual;
+        smpl::BatchPlanningStats stats;
+        BOOST_REQUIRE(multi.solve(queries, actual, &stats));
+        BOOST_CHECK_EQUAL(stats.num_workers, 4);
+        BOOST_CHECK_EQUAL(stats.num_queries, (int)queries.size());
+        BOOST_CHECK_EQUAL(stats.num_solved, num_solved);
+        for (auto& result : actual) {
+            BOOST_CHECK(result.worker >= 0 && result.worker < 4);
+        }
+        CheckResultsEqual(expected, actual);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(FewerQueriesThanWorkersTest)
+{
+    PointRobotModel robot;
+    auto factory = [&](int, smpl::BatchPlannerWorker& worker)
+    {
+        return MakeWorker(&robot, worker);
+    };
+
+    smpl::BatchPlanner planner;
+    BOOST_REQUIRE(planner.init(4, factory));
+
+    std::vector<smpl::PlanningQuery> queries = { MakeQuery(0.1, 0.5, 0.9, 0.5) };
+    std::vector<smpl::PlanningQueryResult> results;
+    smpl::BatchPlanningStats stats;
+    BOOST_REQUIRE(planner.solve(queries, results, &stats));
+    BOOST_REQUIRE_EQUAL(results.size(), 1);
+    BOOST_CHECK(results[0].solved);
+    BOOST_CHECK_EQUAL(stats.num_workers, 1);
+
+    queries.clear();
+    BOOST_REQUIRE(planner.solve(queries, results, &stats));
+    BOOST_CHECK(results.empty());
+    BOOST_CHECK_EQUAL(stats.num_workers, 0);
+}
+
+BOOST_AUTO_TEST_CASE(UninitializedTest)
+{
+    smpl::BatchPlanner planner;
+    std::vector<smpl::PlanningQueryResult> results;
+    BOOST_CHECK(!planner.solve({ MakeQuery(0.1, 0.5, 0.9, 0.5) }, results));
+    BOOST_CHECK(!planner.init(0, [](int, smpl::BatchPlannerWorker&) { return true; }));
+}
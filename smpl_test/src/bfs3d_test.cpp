@@ -0,0 +1,292 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+// standard includes
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE BFS3DTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// system includes
+#include <smpl/bfs3d/bfs3d.h>
+
+// Large enough that frontiers around the center exceed the size at which they
+// are expanded in parallel
+static const int DIM_X = 80;
+static const int DIM_Y = 70;
+static const int DIM_Z = 60;
+
+struct Cell
+{
+    int x, y, z;
+};
+
+// A dense reference grid of walls and the distances of a plain 26-connected
+// breadth-first search over it
+struct ReferenceGrid
+{
+    std::vector<bool> walls;
+    std::vector<int> dist;
+
+    ReferenceGrid() : walls(DIM_X * DIM_Y * DIM_Z, false) { }
+
+    int index(int x, int y, int z) const { return (z * DIM_Y + y) * DIM_X + x; }
+
+    bool isWall(int x, int y, int z) const { return walls[index(x, y, z)]; }
+
+    void run(const std::vector<Cell>& starts)
+    {
+        dist.assign(walls.size(), -1);
+        std::deque<Cell> q;
+        for (auto& c : starts) {
+            if (!isWall(c.x, c.y, c.z) && dist[index(c.x, c.y, c.z)] < 0) {
+                dist[index(c.x, c.y, c.z)] = 0;
+                q.push_back(c);
+            }
+        }
+        while (!q.empty()) {
+            auto c = q.front();
+            q.pop_front();
+            auto d = dist[index(c.x, c.y, c.z)];
+            for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+            for (int dz = -1; dz <= 1; ++dz) {
+                Cell n = { c.x + dx, c.y + dy, c.z + dz };
+                if (n.x < 0 || n.x >= DIM_X ||
+                    n.y < 0 || n.y >= DIM_Y ||
+                    n.z < 0 || n.z >= DIM_Z ||
+                    isWall(n.x, n.y, n.z) ||
+                    dist[index(n.x, n.y, n.z)] >= 0)
+                {
+                    continue;
+                }
+                dist[index(n.x, n.y, n.z)] = d + 1;
+                q.push_back(n);
+            }
+            }
+            }
+        }
+    }
+};
+
+// Fill a reference grid with random walls, along with a solid slab that walls
+// off a pocket of unreachable cells at one end of the grid
+static
+void MakeRandomWalls(ReferenceGrid& grid, double density, unsigned seed)
+{
+    std::default_random_engine rng(seed);
+    std::bernoulli_distribution wall(density);
+    for (int z = 0; z < DIM_Z; ++z) {
+    for (int y = 0; y < DIM_Y; ++y) {
+    for (int x = 0; x < DIM_X; ++x) {
+        grid.walls[grid.index(x, y, z)] = (x == DIM_X - 5) || wall(rng);
+    }
+    }
+    }
+}
+
+static
+void CopyWalls(const ReferenceGrid& grid, smpl::BFS_3D& bfs)
+{
+    for (int z = 0; z < DIM_Z; ++z) {
+    for (int y = 0; y < DIM_Y; ++y) {
+    for (int x = 0; x < DIM_X; ++x) {
+        if (grid.isWall(x, y, z)) {
+            bfs.setWall(x, y, z);
+        }
+    }
+    }
+    }
+}
+
+// Compare the distance of every cell, blocking on cells the search has not
+// yet reached
+static
+void CheckDistances(const ReferenceGrid& grid, const smpl::BFS_3D& bfs)
+{
+    int mismatches = 0;
+    for (int z = 0; z < DIM_Z; ++z) {
+    for (int y = 0; y < DIM_Y; ++y) {
+    for (int x = 0; x < DIM_X; ++x) {
+        auto expected = grid.dist[grid.index(x, y, z)];
+        if (grid.isWall(x, y, z)) {
+            mismatches += bfs.getDistance(x, y, z) != smpl::BFS_3D::WALL;
+        } else if (expected < 0) {
+            mismatches += !bfs.isUndiscovered(x, y, z);
+        } else {
+            mismatches += bfs.getDistance(x, y, z) != expected;
+        }
+    }
+    }
+    }
+    BOOST_CHECK_EQUAL(mismatches, 0);
+}
+
+static const Cell CENTER = { DIM_X / 2, DIM_Y / 2, DIM_Z / 2 };
+
+BOOST_AUTO_TEST_CASE(ParallelSearchTest)
+{
+    ReferenceGrid grid;
+    MakeRandomWalls(grid, 0.2, 1);
+    grid.walls[grid.index(CENTER.x, CENTER.y, CENTER.z)] = false;
+    grid.run({ CENTER });
+
+    for (int num_threads : { 1, 4 }) {
+        BOOST_TEST_CONTEXT("num_threads = " << num_threads) {
+            smpl::BFS_3D bfs(DIM_X, DIM_Y, DIM_Z);
+            bfs.setNumThreads(num_threads);
+            BOOST_CHECK_EQUAL(bfs.numThreads(), num_threads);
+            CopyWalls(grid, bfs);
+
+            // searches may be rerun without resetting the walls
+            for (int i = 0; i < 2; ++i) {
+                bfs.run(CENTER.x, CENTER.y, CENTER.z);
+                CheckDistances(grid, bfs);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MultipleStartsTest)
+{
+    ReferenceGrid grid;
+    MakeRandomWalls(grid, 0.1, 2);
+    std::vector<Cell> starts = {
+        { 0, 0, 0 }, { DIM_X - 6, DIM_Y - 1, DIM_Z - 1 }, CENTER, CENTER
+    };
+    for (auto& c : starts) {
+        grid.walls[grid.index(c.x, c.y, c.z)] = false;
+    }
+    grid.run(starts);
+
+    smpl::BFS_3D bfs(DIM_X, DIM_Y, DIM_Z);
+    bfs.setNumThreads(4);
+    CopyWalls(grid, bfs);
+
+    std::vector<int> cells;
+    for (auto& c : starts) {
+        cells.insert(cells.end(), { c.x, c.y, c.z });
+    }
+    bfs.run(cells.begin(), cells.end());
+    CheckDistances(grid, bfs);
+}
+
+BOOST_AUTO_TEST_CASE(SharedWallGridTest)
+{
+    ReferenceGrid grid;
+    MakeRandomWalls(grid, 0.2, 3);
+    grid.walls[grid.index(CENTER.x, CENTER.y, CENTER.z)] = false;
+    grid.walls[grid.index(0, 0, 0)] = false;
+
+    auto walls = std::make_shared<smpl::BfsWallGrid>(DIM_X, DIM_Y, DIM_Z);
+    smpl::BFS_3D a(walls);
+    smpl::BFS_3D b(walls);
+    BOOST_CHECK(a.walls() == b.walls());
+
+    // walls set through one search are seen by the other
+    CopyWalls(grid, a);
+    BOOST_CHECK(b.isWall(DIM_X - 5, 0, 0));
+    BOOST_CHECK_EQUAL(a.countWalls(), b.countWalls());
+
+    grid.run({ CENTER });
+    a.run(CENTER.x, CENTER.y, CENTER.z);
+    CheckDistances(grid, a);
+
+    ReferenceGrid corner = grid;
+    corner.run({ { 0, 0, 0 } });
+    b.run(0, 0, 0);
+    CheckDistances(corner, b);
+
+    // opening the slab through the shared grid is picked up on the next run
+    for (int z = 0; z < DIM_Z; ++z) {
+        for (int y = 0; y < DIM_Y; ++y) {
+            grid.walls[grid.index(DIM_X - 5, y, z)] = false;
+            walls->unsetWall(DIM_X - 5, y, z);
+        }
+    }
+    grid.run({ CENTER });
+    a.run(CENTER.x, CENTER.y, CENTER.z);
+    CheckDistances(grid, a);
+
+    // a search may be moved to another grid of the same size, only
+    BOOST_CHECK(!b.setWallGrid(std::make_shared<smpl::BfsWallGrid>(DIM_X, DIM_Y, DIM_Z + 1)));
+    BOOST_CHECK(b.walls() == walls);
+    BOOST_CHECK(b.setWallGrid(std::make_shared<smpl::BfsWallGrid>(DIM_X, DIM_Y, DIM_Z)));
+    BOOST_CHECK_EQUAL(b.walls()->countWalls(), 0);
+    BOOST_CHECK_LT(b.countWalls(), a.countWalls());
+}
+
+BOOST_AUTO_TEST_CASE(LazySearchTest)
+{
+    ReferenceGrid grid;
+    MakeRandomWalls(grid, 0.2, 4);
+    grid.walls[grid.index(CENTER.x, CENTER.y, CENTER.z)] = false;
+    grid.run({ CENTER });
+
+    smpl::BFS_3D bfs(DIM_X, DIM_Y, DIM_Z);
+    bfs.setLazyEnabled(true);
+    BOOST_CHECK(bfs.lazyEnabled());
+    CopyWalls(grid, bfs);
+
+    bfs.run(CENTER.x, CENTER.y, CENTER.z);
+    BOOST_CHECK(!bfs.isRunning());
+
+    // nearby lookups only expand the region around the start
+    BOOST_CHECK_EQUAL(bfs.getDistance(CENTER.x, CENTER.y, CENTER.z), 0);
+    BOOST_CHECK_LT(bfs.countDiscovered(), DIM_X * DIM_Y * DIM_Z / 10);
+
+    // lookups in random order agree with a complete search
+    std::default_random_engine rng(5);
+    std::uniform_int_distribution<int> dx(0, DIM_X - 1);
+    std::uniform_int_distribution<int> dy(0, DIM_Y - 1);
+    std::uniform_int_distribution<int> dz(0, DIM_Z - 1);
+    int mismatches = 0;
+    for (int i = 0; i < 1000; ++i) {
+        auto x = dx(rng);
+        auto y = dy(rng);
+        auto z = dz(rng);
+        auto expected = grid.dist[grid.index(x, y, z)];
+        if (grid.isWall(x, y, z)) {
+            mismatches += bfs.getDistance(x, y, z) != smpl::BFS_3D::WALL;
+        } else if (expected >= 0) {
+            mismatches += bfs.getDistance(x, y, z) != expected;
+        }
+    }
+    BOOST_CHECK_EQUAL(mismatches, 0);
+
+    // rerunning restarts the lazy search
+    bfs.run(CENTER.x, CENTER.y, CENTER.z);
+    CheckDistances(grid, bfs);
+}
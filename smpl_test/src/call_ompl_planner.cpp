@@ -198,6 +198,11 @@ struct RobotModelConfig
     std::string planning_link;
     std::string kinematics_frame;
     std::string chain_tip_link;
+
+    // name and parameters of a closed-form IK solver to use in place of the
+    // numerical solver, if any
+    std::string ik_solver;
+    std::string ik_solver_params;
 };
 
 // Read planning group configuration from the param server
@@ -232,6 +237,9 @@ bool ReadRobotModelConfig(const ros::NodeHandle &nh, RobotModelConfig &config)
     // only required for generic kdl robot model?
     nh.getParam("kinematics_frame", config.kinematics_frame);
     nh.getParam("chain_tip_link", config.chain_tip_link);
+
+    nh.getParam("ik_solver", config.ik_solver);
+    nh.getParam("ik_solver_params", config.ik_solver_params);
     return true;
 }
 
@@ -328,6 +336,15 @@ auto SetupRobotModel(const std::string& urdf, const RobotModelConfig &config)
         return NULL;
     }
 
+    if (!config.ik_solver.empty()) {
+        ROS_INFO("Use analytic IK solver '%s'", config.ik_solver.c_str());
+        auto solver = smpl::MakeAnalyticIKSolver(config.ik_solver, config.ik_solver_params);
+        if (!solver || !rm->setAnalyticIKSolver(std::move(solver))) {
+            ROS_ERROR("Failed to install analytic IK solver '%s'", config.ik_solver.c_str());
+            return NULL;
+        }
+    }
+
     return std::move(rm);
 }
 
@@ -31,6 +31,8 @@
 
 // standard includes
 #include <stdlib.h>
+#include <string.h>
+#include <map>
 #include <string>
 #include <thread>
 #include <vector>
@@ -42,6 +44,7 @@
 #include <moveit_msgs/GetMotionPlan.h>
 #include <moveit_msgs/PlanningScene.h>
 #include <ros/ros.h>
+#include <ros/serialization.h>
 #include <kdl_conversions/kdl_msg.h>
 #include <smpl/ros/planner_interface.h>
 #include <smpl/distance_map/edge_euclid_distance_map.h>
@@ -52,6 +55,7 @@
 #include <visualization_msgs/MarkerArray.h>
 #include <smpl/angles.h>
 #include <smpl/debug/visualizer_ros.h>
+#include <smpl/search/search_trace.h>
 
 #include "collision_space_scene.h"
 #include "pr2_allowed_collision_pairs.h"
@@ -280,12 +284,106 @@ bool ReadInitialConfiguration(
     return true;
 }
 
+template <class Message>
+bool DeserializeMessage(const std::string& data, Message& msg)
+{
+    try {
+        ros::serialization::IStream stream((uint8_t*)&data[0], data.size());
+        ros::serialization::deserialize(stream, msg);
+    } catch (const ros::serialization::StreamOverrunException& ex) {
+        return false;
+    }
+    return true;
+}
+
+// The planning problem recorded in a search trace by PlannerInterface
+struct TraceProblem
+{
+    moveit_msgs::PlanningScene scene;
+    moveit_msgs::MotionPlanRequest req;
+    std::vector<Eigen::Vector3d> voxels;
+
+    // all blobs, including the configuration of the grid, the planner, the
+    // robot, and the collision model
+    std::map<std::string, std::string> blobs;
+};
+
+bool ReadTraceProblem(const std::string& filename, TraceProblem& problem)
+{
+    smpl::SearchTraceReader reader;
+    if (!reader.open(filename)) {
+        return false;
+    }
+
+    smpl::SearchTraceRecord record;
+    while (reader.read(record)) {
+        if (record.type == smpl::SearchTraceRecordType::Blob) {
+            problem.blobs[record.name] = std::move(record.data);
+        }
+    }
+    if (reader.error()) {
+        ROS_ERROR("Trace '%s' is truncated or corrupt", filename.c_str());
+        return false;
+    }
+
+    auto scene_name = ros::message_traits::DataType<moveit_msgs::PlanningScene>::value();
+    auto req_name = ros::message_traits::DataType<moveit_msgs::MotionPlanRequest>::value();
+    for (auto* name : {
+            scene_name,
+            req_name,
+            "smpl/OccupancyGrid",
+            "smpl/OccupiedVoxels",
+            "smpl/PlanningParams",
+            "smpl/RobotModel",
+            "robot_description",
+            "robot_collision_model" })
+    {
+        if (problem.blobs.find(name) == end(problem.blobs)) {
+            ROS_ERROR("Trace '%s' does not record '%s'", filename.c_str(), name);
+            return false;
+        }
+    }
+
+    if (!DeserializeMessage(problem.blobs[scene_name], problem.scene) ||
+        !DeserializeMessage(problem.blobs[req_name], problem.req))
+    {
+        ROS_ERROR("Trace '%s' contains a malformed planning scene or request", filename.c_str());
+        return false;
+    }
+
+    auto& voxels = problem.blobs["smpl/OccupiedVoxels"];
+    problem.voxels.resize(voxels.size() / sizeof(Eigen::Vector3d));
+    memcpy(problem.voxels.data(), voxels.data(), problem.voxels.size() * sizeof(Eigen::Vector3d));
+
+    ROS_INFO("Read planning problem for '%s' with %zu occupied voxels from trace", problem.req.planner_id.c_str(), problem.voxels.size());
+    return true;
+}
+
+// Return whether the configuration recorded in a trace matches the current
+// configuration, which a replay must use in place of the recorded one
+bool CheckTraceBlob(
+    const TraceProblem& problem,
+    const std::string& name,
+    const std::string& current)
+{
+    if (problem.blobs.at(name) != current) {
+        ROS_ERROR("Trace was recorded with a different '%s'", name.c_str());
+        return false;
+    }
+    return true;
+}
+
 struct RobotModelConfig
 {
     std::string group_name;
     std::vector<std::string> planning_joints;
     std::string kinematics_frame;
     std::string chain_tip_link;
+
+    // name and parameters of a closed-form IK solver to use in place of the
+    // numerical solver, if any
+    std::string ik_solver;
+    std::string ik_solver_params;
 };
 
 bool ReadRobotModelConfig(const ros::NodeHandle &nh, RobotModelConfig &config)
@@ -314,6 +412,9 @@ bool ReadRobotModelConfig(const ros::NodeHandle &nh, RobotModelConfig &config)
     // only required for generic kdl robot model?
     nh.getParam("kinematics_frame", config.kinematics_frame);
     nh.getParam("chain_tip_link", config.chain_tip_link);
+
+    nh.getParam("ik_solver", config.ik_solver);
+    nh.getParam("ik_solver_params", config.ik_solver_params);
     return true;
 }
 
@@ -402,6 +503,15 @@ auto SetupRobotModel(const std::string& urdf, const RobotModelConfig &config)
         return NULL;
     }
 
+    if (!config.ik_solver.empty()) {
+        ROS_INFO("Use analytic IK solver '%s'", config.ik_solver.c_str());
+        auto solver = smpl::MakeAnalyticIKSolver(config.ik_solver, config.ik_solver_params);
+        if (!solver || !rm->setAnalyticIKSolver(std::move(solver))) {
+            ROS_ERROR("Failed to install analytic IK solver '%s'", config.ik_solver.c_str());
+            return NULL;
+        }
+    }
+
     return std::move(rm);
 }
 
@@ -439,6 +549,23 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    // Replay the planning problem recorded in a search trace instead of the
+    // one described on the param server. The robot and collision model must
+    // be configured as they were when the trace was recorded...
+    std::string replay_trace;
+    ph.param<std::string>("replay_trace", replay_trace, "");
+
+    TraceProblem replay;
+    if (!replay_trace.empty()) {
+        if (!ReadTraceProblem(replay_trace, replay)) {
+            ROS_ERROR("Failed to read planning problem from trace");
+            return 1;
+        }
+        if (!CheckTraceBlob(replay, "robot_description", robot_description)) {
+            return 1;
+        }
+    }
+
     RobotModelConfig robot_config;
     if (!ReadRobotModelConfig(ros::NodeHandle("~robot_model"), robot_config)) {
         ROS_ERROR("Failed to read robot model config from param server");
@@ -468,6 +595,34 @@ int main(int argc, char* argv[])
     auto df_origin_y = -1.5;
     auto df_origin_z = 0.0;
     auto max_distance = 1.8;
+    auto ref_counted = false;
+
+    // ...rebuild the grid the trace was recorded in
+    if (!replay_trace.empty()) {
+        std::map<std::string, std::string> geometry;
+        if (!smpl::DecodeTraceProperties(replay.blobs["smpl/OccupancyGrid"], geometry)) {
+            ROS_ERROR("Trace contains malformed occupancy grid geometry");
+            return 1;
+        }
+        try {
+            df_size_x = std::stod(geometry.at("size_x"));
+            df_size_y = std::stod(geometry.at("size_y"));
+            df_size_z = std::stod(geometry.at("size_z"));
+            df_res = std::stod(geometry.at("resolution"));
+            df_origin_x = std::stod(geometry.at("origin_x"));
+            df_origin_y = std::stod(geometry.at("origin_y"));
+            df_origin_z = std::stod(geometry.at("origin_z"));
+            max_distance = std::stod(geometry.at("max_distance"));
+            ref_counted = geometry.at("ref_counted") == "true";
+        } catch (const std::exception& ex) { // std::out_of_range or std::invalid_argument
+            ROS_ERROR("Trace contains incomplete occupancy grid geometry");
+            return 1;
+        }
+        if (geometry["frame_id"] != planning_frame) {
+            ROS_ERROR("Trace was recorded in frame '%s', not '%s'", geometry["frame_id"].c_str(), planning_frame.c_str());
+            return 1;
+        }
+    }
 
     using DistanceMapType = smpl::EuclidDistanceMap;
 
@@ -477,9 +632,12 @@ int main(int argc, char* argv[])
             df_res,
             max_distance);
 
-    auto ref_counted = false;
     smpl::OccupancyGrid grid(df, ref_counted);
 
+    bool use_distance_pyramid;
+    ph.param("use_distance_pyramid", use_distance_pyramid, false);
+    grid.setDistancePyramidEnabled(use_distance_pyramid);
+
     grid.setReferenceFrame(planning_frame);
     SV_SHOW_INFO(grid.getBoundingBoxVisualization());
 
@@ -499,6 +657,18 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    // record the collision model in traces, in the form it was loaded from
+    std::string rcm_key;
+    XmlRpc::XmlRpcValue rcm_config;
+    ph.searchParam("robot_collision_model", rcm_key);
+    ph.getParam(rcm_key, rcm_config);
+    auto robot_collision_model = rcm_config.toXml();
+    if (!replay_trace.empty() &&
+        !CheckTraceBlob(replay, "robot_collision_model", robot_collision_model))
+    {
+        return 1;
+    }
+
     smpl::collision::CollisionSpace cc;
     if (!cc.init(
             &grid,
@@ -527,14 +697,18 @@ int main(int argc, char* argv[])
 
     scene.SetCollisionSpace(&cc);
 
-    std::string object_filename;
-    ph.param<std::string>("object_filename", object_filename, "");
-
-    // Read in collision objects from file and add to the scene...
-    if (!object_filename.empty()) {
-        auto objects = GetCollisionObjects(object_filename, planning_frame);
-        for (auto& object : objects) {
-            scene.ProcessCollisionObjectMsg(object);
+    if (!replay_trace.empty()) {
+        grid.addPointsToField(replay.voxels);
+    } else {
+        std::string object_filename;
+        ph.param<std::string>("object_filename", object_filename, "");
+
+        // Read in collision objects from file and add to the scene...
+        if (!object_filename.empty()) {
+            auto objects = GetCollisionObjects(object_filename, planning_frame);
+            for (auto& object : objects) {
+                scene.ProcessCollisionObjectMsg(object);
+            }
         }
     }
 
@@ -547,7 +721,9 @@ int main(int argc, char* argv[])
     // Read in start state from file and update the scene...
     // Start state is also required by the planner...
     moveit_msgs::RobotState start_state;
-    if (!ReadInitialConfiguration(ph, start_state)) {
+    if (!replay_trace.empty()) {
+        start_state = replay.req.start_state;
+    } else if (!ReadInitialConfiguration(ph, start_state)) {
         ROS_ERROR("Failed to get initial configuration.");
         return 1;
     }
@@ -615,6 +791,30 @@ int main(int argc, char* argv[])
     params.addParam("bfs_inflation_radius", 0.02);
     params.addParam("bfs_cost_per_cell", 100);
 
+    ph.param<std::string>("trace_output_dir", params.trace_output_dir, "");
+
+    // ...and plan with the recorded parameters
+    if (!replay_trace.empty()) {
+        std::map<std::string, std::string> robot;
+        smpl::DecodeTraceProperties(replay.blobs["smpl/RobotModel"], robot);
+        std::string planning_joints;
+        for (auto& joint : rm->getPlanningJoints()) {
+            planning_joints += joint + " ";
+        }
+        if (robot["planning_joints"] != planning_joints) {
+            ROS_ERROR("Trace was recorded with different planning joints");
+            return 1;
+        }
+
+        if (!params.deserialize(replay.blobs["smpl/PlanningParams"])) {
+            ROS_ERROR("Trace contains malformed planning parameters");
+            return 1;
+        }
+    }
+
+    planner.setTraceBlob("robot_description", robot_description);
+    planner.setTraceBlob("robot_collision_model", robot_collision_model);
+
     if (!planner.init(params)) {
         ROS_ERROR("Failed to initialize Planner Interface");
         return 1;
@@ -652,6 +852,11 @@ int main(int argc, char* argv[])
     ROS_INFO("Calling solve...");
     moveit_msgs::PlanningScene planning_scene;
     planning_scene.robot_state = start_state;
+
+    if (!replay_trace.empty()) {
+        req = replay.req;
+        planning_scene = replay.scene;
+    }
     if (!planner.solve(planning_scene, req, res)) {
         ROS_ERROR("Failed to plan.");
         return 1;
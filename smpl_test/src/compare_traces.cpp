@@ -0,0 +1,261 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+// Summarizes the searches recorded in a search trace and, given a second
+// trace of the same query, reports where the two searches first diverge and
+// how their timings compare. Traces are recorded by PlannerInterface when the
+// trace_output_dir planning parameter is set; see call_planner's replay_trace
+// parameter to re-run a recorded query.
+//
+// State ids are assigned by the graph that recorded the trace, and a planner
+// that keeps its graph across requests numbers the states of a query
+// differently than a fresh replay does. Searches are therefore compared by
+// their costs, with the state ids of one trace required only to correspond
+// one-to-one with those of the other.
+
+// standard includes
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// system includes
+#include <smpl/search/search_trace.h>
+
+struct TracedSearch
+{
+    int start_state_id = -1;
+    int goal_state_id = -1;
+    std::vector<smpl::SearchTraceRecord> expansions;
+    int iterations = 0;
+    bool solved = false;
+    bool complete = false; // whether the trace records the end of the search
+    int cost = -1;
+    std::int64_t time = 0; // nanoseconds
+};
+
+// Load the searches recorded in a trace. A trace that is truncated or corrupt
+// is loaded up to the damage, and reported as incomplete.
+static
+bool LoadTrace(
+    const std::string& filename,
+    std::vector<TracedSearch>& searches,
+    bool& complete)
+{
+    smpl::SearchTraceReader reader;
+    if (!reader.open(filename)) {
+        return false;
+    }
+
+    smpl::SearchTraceRecord record;
+    while (reader.read(record)) {
+        switch (record.type) {
+        case smpl::SearchTraceRecordType::Blob:
+            printf("%s: %s (%zu bytes)\n", filename.c_str(), record.name.c_str(), record.data.size());
+            break;
+        case smpl::SearchTraceRecordType::SearchBegin:
+            searches.emplace_back();
+            searches.back().start_state_id = record.start_state_id;
+            searches.back().goal_state_id = record.goal_state_id;
+            break;
+        case smpl::SearchTraceRecordType::Iteration:
+            if (!searches.empty()) {
+                ++searches.back().iterations;
+            }
+            break;
+        case smpl::SearchTraceRecordType::Expansion:
+            if (!searches.empty()) {
+                searches.back().expansions.push_back(record);
+            }
+            break;
+        case smpl::SearchTraceRecordType::SearchEnd:
+            if (!searches.empty()) {
+                searches.back().solved = record.solved;
+                searches.back().cost = record.cost;
+                searches.back().time = record.time;
+                searches.back().complete = true;
+            }
+            break;
+        }
+    }
+
+    complete = !reader.error();
+    if (!complete) {
+        printf("%s: truncated or corrupt after %zu searches\n", filename.c_str(), searches.size());
+    }
+    return true;
+}
+
+static
+void PrintSearch(const char* label, const TracedSearch& search)
+{
+    if (!search.complete) {
+        printf("  %s: incomplete, %zu expansions, %d iterations\n",
+                label, search.expansions.size(), search.iterations);
+        return;
+    }
+
+    auto secs = 1e-9 * (double)search.time;
+    printf("  %s: %s, cost = %d, %zu expansions, %d iterations, %0.6f s (%0.3f us/expansion)\n",
+            label,
+            search.solved ? "solved" : "unsolved",
+            search.cost,
+            search.expansions.size(),
+            search.iterations,
+            secs,
+            search.expansions.empty() ? 0.0 : 1e6 * secs / search.expansions.size());
+}
+
+// A one-to-one correspondence between the state ids of two traces, built up
+// as states are encountered
+struct StateIdMap
+{
+    std::unordered_map<int, int> a_to_b;
+    std::unordered_map<int, int> b_to_a;
+
+    // Return whether state a of one trace may be the same state as state b of
+    // the other, recording the correspondence if neither has been seen.
+    bool match(int a, int b)
+    {
+        auto ait = a_to_b.find(a);
+        auto bit = b_to_a.find(b);
+        if (ait == a_to_b.end() && bit == b_to_a.end()) {
+            a_to_b[a] = b;
+            b_to_a[b] = a;
+            return true;
+        }
+        return ait != a_to_b.end() && bit != b_to_a.end() && ait->second == b;
+    }
+};
+
+static
+bool SameExpansion(
+    const smpl::SearchTraceRecord& a,
+    const smpl::SearchTraceRecord& b,
+    StateIdMap& ids)
+{
+    if (a.g != b.g ||
+        a.h != b.h ||
+        a.f != b.f ||
+        a.costs != b.costs ||
+        a.succs.size() != b.succs.size() ||
+        !ids.match(a.state_id, b.state_id))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.succs.size(); ++i) {
+        if (!ids.match(a.succs[i], b.succs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static
+void CompareSearches(const TracedSearch& a, const TracedSearch& b)
+{
+    StateIdMap ids;
+    if (!ids.match(a.start_state_id, b.start_state_id) ||
+        !ids.match(a.goal_state_id, b.goal_state_id))
+    {
+        printf("  start and goal states do not correspond\n");
+        return;
+    }
+
+    auto count = std::min(a.expansions.size(), b.expansions.size());
+    for (size_t i = 0; i < count; ++i) {
+        auto& ea = a.expansions[i];
+        auto& eb = b.expansions[i];
+        if (!SameExpansion(ea, eb, ids)) {
+            printf("  diverged at expansion %zu:\n", i);
+            printf("    a: state %d, g = %u, h = %u, f = %u, %zu successors\n", ea.state_id, ea.g, ea.h, ea.f, ea.succs.size());
+            printf("    b: state %d, g = %u, h = %u, f = %u, %zu successors\n", eb.state_id, eb.g, eb.h, eb.f, eb.succs.size());
+            return;
+        }
+    }
+
+    if (!a.complete || !b.complete) {
+        printf("  identical for %zu expansions, before the trace of an incomplete search ends\n", count);
+        return;
+    } else if (a.expansions.size() != b.expansions.size()) {
+        printf("  identical for %zu expansions, then one search ended\n", count);
+    } else {
+        printf("  identical expansions\n");
+    }
+
+    if (a.time > 0) {
+        printf("  time ratio (b / a): %0.3f\n", (double)b.time / (double)a.time);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: compare_traces <trace> [other trace]\n");
+        return 1;
+    }
+
+    // a truncated or corrupt trace is summarized as far as it goes, but the
+    // exit status reports the damage
+    std::vector<TracedSearch> a;
+    bool a_complete;
+    if (!LoadTrace(argv[1], a, a_complete)) {
+        return 1;
+    }
+
+    if (argc == 2) {
+        for (size_t i = 0; i < a.size(); ++i) {
+            printf("search %zu\n", i);
+            PrintSearch("a", a[i]);
+        }
+        return a_complete ? 0 : 1;
+    }
+
+    std::vector<TracedSearch> b;
+    bool b_complete;
+    if (!LoadTrace(argv[2], b, b_complete)) {
+        return 1;
+    }
+
+    if (a.size() != b.size()) {
+        printf("traces contain different numbers of searches (%zu vs %zu)\n", a.size(), b.size());
+    }
+
+    for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+        printf("search %zu\n", i);
+        PrintSearch("a", a[i]);
+        PrintSearch("b", b[i]);
+        CompareSearches(a[i], b[i]);
+    }
+
+    return a_complete && b_complete ? 0 : 1;
+}
@@ -1,8 +1,11 @@
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <ostream>
+#include <random>
 #include <utility>
 
+#include <smpl/distance_map/distance_pyramid.h>
 #include <smpl/distance_map/euclid_distance_map.h>
 #include <smpl/distance_map/sparse_distance_map.h>
 
@@ -153,9 +156,78 @@ void TestSpecialMemberFunctions()
     }
 }
 
+template <class DistanceMap>
+void TestDistancePyramid()
+{
+    DistanceMap d(0.0, 0.0, 0.0, 5.0, 5.0, 5.0, 0.1, 1.0);
+    smpl::DistancePyramid pyramid(&d);
+
+    std::vector<Eigen::Vector3d> points;
+    std::default_random_engine rng;
+    std::uniform_real_distribution<double> dist(0.0, 5.0);
+    for (int i = 0; i < 50; ++i) {
+        points.emplace_back(dist(rng), dist(rng), dist(rng));
+    }
+
+    d.addPointsToMap(points);
+    pyramid.update(points);
+
+    points.resize(points.size() >> 1);
+    d.removePointsFromMap(points);
+    pyramid.update(points);
+
+    // every level must bound the full resolution distance from below
+    int violations = 0;
+    for (int i = 0; i < 100000; ++i) {
+        double x = dist(rng), y = dist(rng), z = dist(rng);
+        double df = d.getMetricDistance(x, y, z);
+        for (int l = 0; l < pyramid.numLevels(); ++l) {
+            if (pyramid.getDistanceLowerBound(l, x, y, z) > df) {
+                ++violations;
+            }
+        }
+    }
+    if (violations != 0) {
+        printf("Distance pyramid overestimated %d distances\n", violations);
+    }
+}
+
+template <class DistanceMap>
+void TestInterpolatedDistance()
+{
+    DistanceMap d(0.0, 0.0, 0.0, 2.0, 2.0, 2.0, 0.05, 0.5);
+
+    std::vector<Eigen::Vector3d> points;
+    std::default_random_engine rng;
+    std::uniform_real_distribution<double> dist(0.0, 2.0);
+    for (int i = 0; i < 20; ++i) {
+        points.emplace_back(dist(rng), dist(rng), dist(rng));
+    }
+    d.addPointsToMap(points);
+
+    // specialized lookups must agree with the generic implementation
+    int mismatches = 0;
+    for (int i = 0; i < 10000; ++i) {
+        double x = dist(rng), y = dist(rng), z = dist(rng);
+        Eigen::Vector3d g1, g2;
+        double d1 = d.getInterpMetricDistance(x, y, z, g1);
+        double d2 = d.smpl::DistanceMapInterface::getInterpMetricDistance(x, y, z, g2);
+        if (std::fabs(d1 - d2) > 1e-9 || (g1 - g2).norm() > 1e-9) {
+            ++mismatches;
+        }
+    }
+    if (mismatches != 0) {
+        printf("Interpolated distances disagree at %d points\n", mismatches);
+    }
+}
+
 int main(int argc, char* argv[])
 {
     TestSpecialMemberFunctions<smpl::SparseDistanceMap>();
+    TestDistancePyramid<smpl::EuclidDistanceMap>();
+    TestDistancePyramid<smpl::SparseDistanceMap>();
+    TestInterpolatedDistance<smpl::EuclidDistanceMap>();
+    TestInterpolatedDistance<smpl::SparseDistanceMap>();
 //    TestSpecialMemberFunctions<smpl::EuclidDistanceMap>();
     return 0;
 }
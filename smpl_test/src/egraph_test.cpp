@@ -31,13 +31,22 @@
 
 // standard includes
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// system includes
+#include <unistd.h>
 
 #define BOOST_TEST_MODULE ExperienceGraphTest
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
 
-// system includes
+// project includes
 #include <smpl/graph/experience_graph.h>
+#include <smpl/graph/experience_graph_file.h>
 
 bool IteratedAllNodes(const smpl::ExperienceGraph& eg)
 {
@@ -371,3 +380,177 @@ BOOST_AUTO_TEST_CASE(ParallelEdgeTest)
 //
 //    BOOST_CHECK_EQUAL(eg.degree(n1), 1);
 }
+
+// A path of three nodes with waypoints along its edges, and a node of its own
+void MakeTestExperienceGraph(
+    double offset,
+    smpl::ExperienceGraph& eg,
+    std::vector<std::vector<int>>& coords)
+{
+    auto n1 = eg.insert_node({ offset + 0.0, 0.0 });
+    auto n2 = eg.insert_node({ offset + 1.0, 0.5 });
+    auto n3 = eg.insert_node({ offset + 2.0, 1.0 });
+    eg.insert_node({ offset + 5.0, 5.0 });
+    eg.insert_edge(n1, n2, { { offset + 0.5, 0.25 } });
+    eg.insert_edge(n2, n3, { { offset + 1.25, 0.5 }, { offset + 1.75, 0.75 } });
+
+    coords.clear();
+    auto nodes = eg.nodes();
+    for (auto it = nodes.first; it != nodes.second; ++it) {
+        auto& state = eg.state(*it);
+        coords.push_back({ (int)(state[0] * 10.0), (int)(state[1] * 10.0) });
+    }
+}
+
+void CheckSegment(
+    const smpl::ExperienceGraphFile::Segment& segment,
+    const smpl::ExperienceGraph& eg,
+    const std::vector<std::vector<int>>& coords)
+{
+    BOOST_REQUIRE_EQUAL(segment.node_count, eg.num_nodes());
+    BOOST_REQUIRE_EQUAL(segment.edge_count, eg.num_edges());
+    BOOST_CHECK_EQUAL(segment.waypoint_count, 3);
+    BOOST_CHECK_EQUAL(segment.component_count, 2);
+
+    for (size_t n = 0; n < eg.num_nodes(); ++n) {
+        for (size_t i = 0; i < 2; ++i) {
+            BOOST_CHECK_EQUAL(segment.states[n * 2 + i], eg.state(n)[i]);
+            BOOST_CHECK_EQUAL(segment.coords[n * 2 + i], coords[n][i]);
+        }
+    }
+    BOOST_CHECK_EQUAL(segment.components[0], segment.components[1]);
+    BOOST_CHECK_EQUAL(segment.components[0], segment.components[2]);
+    BOOST_CHECK_NE(segment.components[0], segment.components[3]);
+
+    for (size_t e = 0; e < eg.num_edges(); ++e) {
+        auto& edge = segment.edges[e];
+        BOOST_CHECK_EQUAL(edge.source, eg.source(e));
+        BOOST_CHECK_EQUAL(edge.target, eg.target(e));
+        auto& waypoints = eg.waypoints(e);
+        BOOST_REQUIRE_EQUAL(edge.waypoint_count, waypoints.size());
+        for (size_t w = 0; w < waypoints.size(); ++w) {
+            for (size_t i = 0; i < 2; ++i) {
+                BOOST_CHECK_EQUAL(
+                        segment.waypoints[(edge.waypoint_offset + w) * 2 + i],
+                        waypoints[w][i]);
+            }
+        }
+    }
+}
+
+// Removes the temporary file it names on destruction
+struct TempFile
+{
+    std::string path;
+
+    TempFile()
+    {
+        char name[] = "/tmp/egraph_test_XXXXXX";
+        int fd = mkstemp(name);
+        BOOST_REQUIRE(fd != -1);
+        close(fd);
+        path = name;
+    }
+
+    ~TempFile() { std::remove(path.c_str()); }
+
+    auto size() const -> long
+    {
+        std::ifstream f(path, std::ios::binary | std::ios::ate);
+        return (long)f.tellg();
+    }
+};
+
+BOOST_AUTO_TEST_CASE(BinaryFileRoundTripTest)
+{
+    TempFile file;
+    const std::vector<double> resolutions = { 0.1, 0.1 };
+
+    smpl::ExperienceGraph eg1, eg2;
+    std::vector<std::vector<int>> coords1, coords2;
+    MakeTestExperienceGraph(0.0, eg1, coords1);
+    MakeTestExperienceGraph(10.0, eg2, coords2);
+
+    BOOST_REQUIRE(smpl::CreateExperienceGraphFile(file.path, resolutions));
+    BOOST_CHECK(smpl::IsExperienceGraphFile(file.path));
+    BOOST_REQUIRE(smpl::AppendExperienceGraphFile(file.path, eg1, coords1));
+    BOOST_REQUIRE(smpl::AppendExperienceGraphFile(file.path, eg2, coords2));
+
+    smpl::ExperienceGraphFile egf;
+    BOOST_REQUIRE(egf.open(file.path));
+    BOOST_CHECK_EQUAL(egf.variableCount(), 2);
+    BOOST_CHECK(egf.resolutions() == resolutions);
+    BOOST_REQUIRE_EQUAL(egf.segments().size(), 2);
+    BOOST_CHECK_EQUAL(egf.nodeCount(), eg1.num_nodes() + eg2.num_nodes());
+    BOOST_CHECK_EQUAL(egf.edgeCount(), eg1.num_edges() + eg2.num_edges());
+    CheckSegment(egf.segments()[0], eg1, coords1);
+    CheckSegment(egf.segments()[1], eg2, coords2);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryFileTruncatedAppendTest)
+{
+    TempFile file;
+    smpl::ExperienceGraph eg1, eg2, eg3;
+    std::vector<std::vector<int>> coords1, coords2, coords3;
+    MakeTestExperienceGraph(0.0, eg1, coords1);
+    MakeTestExperienceGraph(10.0, eg2, coords2);
+    MakeTestExperienceGraph(20.0, eg3, coords3);
+
+    BOOST_REQUIRE(smpl::CreateExperienceGraphFile(file.path, { 0.1, 0.1 }));
+    BOOST_REQUIRE(smpl::AppendExperienceGraphFile(file.path, eg1, coords1));
+    const long intact_size = file.size();
+    BOOST_REQUIRE(smpl::AppendExperienceGraphFile(file.path, eg2, coords2));
+
+    // simulate an append interrupted partway through the second segment
+    BOOST_REQUIRE(truncate(file.path.c_str(), (intact_size + file.size()) / 2) == 0);
+
+    {
+        smpl::ExperienceGraphFile egf;
+        BOOST_REQUIRE(egf.open(file.path));
+        BOOST_REQUIRE_EQUAL(egf.segments().size(), 1);
+        CheckSegment(egf.segments()[0], eg1, coords1);
+    }
+
+    // the next append discards the torn segment
+    BOOST_REQUIRE(smpl::AppendExperienceGraphFile(file.path, eg3, coords3));
+
+    smpl::ExperienceGraphFile egf;
+    BOOST_REQUIRE(egf.open(file.path));
+    BOOST_REQUIRE_EQUAL(egf.segments().size(), 2);
+    CheckSegment(egf.segments()[0], eg1, coords1);
+    CheckSegment(egf.segments()[1], eg3, coords3);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryFileBadChecksumTest)
+{
+    TempFile file;
+    smpl::ExperienceGraph eg1, eg2;
+    std::vector<std::vector<int>> coords1, coords2;
+    MakeTestExperienceGraph(0.0, eg1, coords1);
+    MakeTestExperienceGraph(10.0, eg2, coords2);
+
+    BOOST_REQUIRE(smpl::CreateExperienceGraphFile(file.path, { 0.1, 0.1 }));
+    BOOST_REQUIRE(smpl::AppendExperienceGraphFile(file.path, eg1, coords1));
+    BOOST_REQUIRE(smpl::AppendExperienceGraphFile(file.path, eg2, coords2));
+
+    // corrupt the last byte of the second segment
+    {
+        std::fstream f(file.path, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekg(-1, std::ios::end);
+        char c = (char)f.get();
+        f.seekp(-1, std::ios::end);
+        f.put((char)~c);
+    }
+
+    smpl::ExperienceGraphFile egf;
+    BOOST_REQUIRE(egf.open(file.path));
+    BOOST_REQUIRE_EQUAL(egf.segments().size(), 1);
+    CheckSegment(egf.segments()[0], eg1, coords1);
+    egf.close();
+
+    // the corrupt segment is replaced by the next append
+    BOOST_REQUIRE(smpl::AppendExperienceGraphFile(file.path, eg2, coords2));
+    BOOST_REQUIRE(egf.open(file.path));
+    BOOST_REQUIRE_EQUAL(egf.segments().size(), 2);
+    CheckSegment(egf.segments()[1], eg2, coords2);
+}
@@ -0,0 +1,376 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+// Microbenchmarks for the core data structures. Every benchmark is
+// parameterized by problem size and uses a fixed random seed, so runs are
+// comparable across commits. Run with --benchmark_format=json or
+// --benchmark_out=<file> to record results as JSON.
+
+// standard includes
+#include <random>
+#include <thread>
+#include <vector>
+
+// system includes
+#include <benchmark/benchmark.h>
+#include <smpl/types.h>
+#include <smpl/bfs3d/bfs3d.h>
+#include <smpl/distance_map/chessboard_distance_map.h>
+#include <smpl/distance_map/edge_euclid_distance_map.h>
+#include <smpl/distance_map/euclid_distance_map.h>
+#include <smpl/distance_map/sparse_distance_map.h>
+#include <smpl/graph/manip_lattice.h>
+#include <smpl/grid/grid.h>
+#include <smpl/grid/sparse_grid.h>
+#include <smpl/heap/intrusive_heap.h>
+
+static const unsigned int SEED = 0xABADCAFE;
+
+////////////////////
+// Intrusive Heap //
+////////////////////
+
+struct open_element : smpl::heap_element
+{
+    long priority;
+};
+
+struct open_element_compare
+{
+    bool operator()(const open_element& a, const open_element& b) const
+    {
+        return a.priority < b.priority;
+    }
+};
+
+using heap_type = smpl::intrusive_heap<open_element, open_element_compare>;
+
+static
+auto MakeElements(int count) -> std::vector<open_element>
+{
+    std::mt19937 gen(SEED);
+    std::uniform_int_distribution<long> dist(0, 1000000);
+    std::vector<open_element> elements(count);
+    for (auto& e : elements) {
+        e.priority = dist(gen);
+    }
+    return elements;
+}
+
+static void BM_IntrusiveHeapPushPop(benchmark::State& state)
+{
+    auto elements = MakeElements(state.range(0));
+    heap_type heap;
+    heap.reserve(elements.size());
+    for (auto _ : state) {
+        for (auto& e : elements) {
+            heap.push(&e);
+        }
+        while (!heap.empty()) {
+            benchmark::DoNotOptimize(heap.min());
+            heap.pop();
+        }
+    }
+    state.SetItemsProcessed(2 * state.iterations() * elements.size());
+}
+BENCHMARK(BM_IntrusiveHeapPushPop)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+static void BM_IntrusiveHeapDecrease(benchmark::State& state)
+{
+    auto elements = MakeElements(state.range(0));
+
+    std::mt19937 gen(SEED);
+    std::uniform_int_distribution<long> dist(1, 16);
+    std::vector<long> deltas(elements.size());
+    for (auto& d : deltas) {
+        d = dist(gen);
+    }
+
+    heap_type heap;
+    for (auto& e : elements) {
+        heap.push(&e);
+    }
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < elements.size(); ++i) {
+            elements[i].priority -= deltas[i];
+            heap.decrease(&elements[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * elements.size());
+}
+BENCHMARK(BM_IntrusiveHeapDecrease)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+///////////
+// Grids //
+///////////
+
+struct Coord
+{
+    int x, y, z;
+};
+
+static
+auto MakeCoords(int size, int count) -> std::vector<Coord>
+{
+    std::mt19937 gen(SEED);
+    std::uniform_int_distribution<int> dist(0, size - 1);
+    std::vector<Coord> coords(count);
+    for (auto& c : coords) {
+        c.x = dist(gen);
+        c.y = dist(gen);
+        c.z = dist(gen);
+    }
+    return coords;
+}
+
+static void BM_Grid3Traversal(benchmark::State& state)
+{
+    auto n = (size_t)state.range(0);
+    smpl::Grid3<int> grid(n, n, n, 1);
+    for (auto _ : state) {
+        long sum = 0;
+        for (size_t x = 0; x < n; ++x) {
+        for (size_t y = 0; y < n; ++y) {
+        for (size_t z = 0; z < n; ++z) {
+            sum += grid(x, y, z);
+        }
+        }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * grid.size());
+}
+BENCHMARK(BM_Grid3Traversal)->RangeMultiplier(2)->Range(32, 256);
+
+static const int SPARSE_GRID_ACCESSES = 1 << 14;
+
+static void BM_SparseGridSet(benchmark::State& state)
+{
+    auto n = (int)state.range(0);
+    auto coords = MakeCoords(n, SPARSE_GRID_ACCESSES);
+    smpl::SparseGrid<int> grid(n, n, n);
+    auto value = 0;
+    for (auto _ : state) {
+        // alternate values so that every set modifies the tree
+        ++value;
+        for (auto& c : coords) {
+            grid.set(c.x, c.y, c.z, value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * coords.size());
+}
+BENCHMARK(BM_SparseGridSet)->RangeMultiplier(4)->Range(64, 1024);
+
+static void BM_SparseGridGet(benchmark::State& state)
+{
+    auto n = (int)state.range(0);
+    auto coords = MakeCoords(n, SPARSE_GRID_ACCESSES);
+    smpl::SparseGrid<int> grid(n, n, n);
+    for (size_t i = 0; i < coords.size(); ++i) {
+        grid.set(coords[i].x, coords[i].y, coords[i].z, (int)i);
+    }
+    for (auto _ : state) {
+        long sum = 0;
+        for (auto& c : coords) {
+            sum += grid.get(c.x, c.y, c.z);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * coords.size());
+}
+BENCHMARK(BM_SparseGridGet)->RangeMultiplier(4)->Range(64, 1024);
+
+///////////////////
+// Distance Maps //
+///////////////////
+
+// all distance maps cover a 1m cube at 2cm resolution
+template <class DistanceMapType>
+auto MakeDistanceMap() -> DistanceMapType
+{
+    return DistanceMapType(0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 0.02, 0.2);
+}
+
+static
+auto MakePoints(int count) -> std::vector<smpl::Vector3>
+{
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<smpl::Vector3> points(count);
+    for (auto& p : points) {
+        p = smpl::Vector3(dist(gen), dist(gen), dist(gen));
+    }
+    return points;
+}
+
+template <class DistanceMapType>
+void BM_DistanceMapAddRemove(benchmark::State& state)
+{
+    auto dmap = MakeDistanceMap<DistanceMapType>();
+    auto points = MakePoints(state.range(0));
+    for (auto _ : state) {
+        dmap.addPointsToMap(points);
+        dmap.removePointsFromMap(points);
+    }
+    state.SetItemsProcessed(2 * state.iterations() * points.size());
+}
+BENCHMARK_TEMPLATE(BM_DistanceMapAddRemove, smpl::EuclidDistanceMap)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_DistanceMapAddRemove, smpl::EdgeEuclidDistanceMap)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_DistanceMapAddRemove, smpl::ChessboardDistanceMap)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_DistanceMapAddRemove, smpl::SparseDistanceMap)->RangeMultiplier(8)->Range(8, 4096);
+
+template <class DistanceMapType>
+void BM_DistanceMapQuery(benchmark::State& state)
+{
+    auto dmap = MakeDistanceMap<DistanceMapType>();
+    dmap.addPointsToMap(MakePoints(state.range(0)));
+    auto queries = MakePoints(1 << 14);
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (auto& q : queries) {
+            sum += dmap.getMetricDistance(q.x(), q.y(), q.z());
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK_TEMPLATE(BM_DistanceMapQuery, smpl::EuclidDistanceMap)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_DistanceMapQuery, smpl::EdgeEuclidDistanceMap)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_DistanceMapQuery, smpl::ChessboardDistanceMap)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_DistanceMapQuery, smpl::SparseDistanceMap)->RangeMultiplier(8)->Range(8, 4096);
+
+///////////////////////////
+// Manip Lattice Hashing //
+///////////////////////////
+
+// Mirrors the table ManipLattice uses to map coordinates to state ids
+using StateKey = smpl::ManipLatticeState;
+using StateTable = smpl::hash_map<
+        StateKey*,
+        int,
+        smpl::PointerValueHash<StateKey>,
+        smpl::PointerValueEqual<StateKey>>;
+
+static
+auto MakeLatticeStates(int count) -> std::vector<StateKey>
+{
+    std::mt19937 gen(SEED);
+    std::uniform_int_distribution<int> dist(-180, 180);
+    std::vector<StateKey> states(count);
+    for (auto& s : states) {
+        s.coord.resize(7);
+        for (auto& c : s.coord) {
+            c = dist(gen);
+        }
+    }
+    return states;
+}
+
+static void BM_ManipLatticeCoordHash(benchmark::State& state)
+{
+    auto states = MakeLatticeStates(state.range(0));
+    std::hash<StateKey> hasher;
+    for (auto _ : state) {
+        for (auto& s : states) {
+            benchmark::DoNotOptimize(hasher(s));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * states.size());
+}
+BENCHMARK(BM_ManipLatticeCoordHash)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+static void BM_ManipLatticeCoordInsert(benchmark::State& state)
+{
+    auto states = MakeLatticeStates(state.range(0));
+    StateTable table;
+    for (auto _ : state) {
+        table.clear();
+        for (size_t i = 0; i < states.size(); ++i) {
+            table[&states[i]] = (int)i;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * states.size());
+}
+BENCHMARK(BM_ManipLatticeCoordInsert)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+static void BM_ManipLatticeCoordLookup(benchmark::State& state)
+{
+    // half of the lookups hit a state in the table
+    auto states = MakeLatticeStates(2 * state.range(0));
+    StateTable table;
+    for (size_t i = 0; i < states.size(); i += 2) {
+        table[&states[i]] = (int)i;
+    }
+    for (auto _ : state) {
+        for (auto& s : states) {
+            benchmark::DoNotOptimize(table.find(&s));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * states.size());
+}
+BENCHMARK(BM_ManipLatticeCoordLookup)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+////////////
+// BFS 3D //
+////////////
+
+static void BM_BFS3DRun(benchmark::State& state)
+{
+    auto n = (int)state.range(0);
+    smpl::BFS_3D bfs(n, n, n);
+
+    // occupy 10% of the cells, leaving the start cell free
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    for (int x = 0; x < n; ++x) {
+    for (int y = 0; y < n; ++y) {
+    for (int z = 0; z < n; ++z) {
+        if (dist(gen) < 0.1) {
+            bfs.setWall(x, y, z);
+        }
+    }
+    }
+    }
+    bfs.escapeCell(n / 2, n / 2, n / 2);
+
+    // the search runs in a separate thread, so only wall time is meaningful
+    for (auto _ : state) {
+        bfs.run(n / 2, n / 2, n / 2);
+        while (bfs.isRunning()) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n * n * n);
+}
+BENCHMARK(BM_BFS3DRun)->RangeMultiplier(2)->Range(16, 128)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
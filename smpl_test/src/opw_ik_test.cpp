@@ -0,0 +1,275 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+// standard includes
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE OPWIKTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// system includes
+#include <smpl/angles.h>
+#include <smpl/ik/opw_ik_solver.h>
+
+// KUKA KR 6 R700 sixx, whose joint zeros and directions differ from the model
+static
+auto MakeKukaParams() -> smpl::OPWParameters
+{
+    smpl::OPWParameters p;
+    p.a1 = 0.025;
+    p.a2 = -0.035;
+    p.b = 0.0;
+    p.c1 = 0.4;
+    p.c2 = 0.315;
+    p.c3 = 0.365;
+    p.c4 = 0.08;
+    p.offsets[1] = -0.5 * M_PI;
+    int signs[6] = { -1, 1, 1, -1, 1, -1 };
+    std::copy(signs, signs + 6, p.sign_corrections);
+    return p;
+}
+
+// An arm whose wrist is offset sideways from the plane of the shoulder
+static
+auto MakeWristOffsetParams() -> smpl::OPWParameters
+{
+    smpl::OPWParameters p;
+    p.a1 = 0.1;
+    p.a2 = -0.05;
+    p.b = 0.08;
+    p.c1 = 0.5;
+    p.c2 = 0.45;
+    p.c3 = 0.4;
+    p.c4 = 0.1;
+    return p;
+}
+
+static
+bool SameAngles(const smpl::RobotState& a, const smpl::RobotState& b)
+{
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (smpl::angles::shortest_angle_dist(a[i], b[i]) > 1.0e-6) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static
+bool SamePose(const smpl::Affine3& a, const smpl::Affine3& b)
+{
+    return (a.translation() - b.translation()).norm() < 1.0e-8 &&
+            (a.linear() - b.linear()).norm() < 1.0e-8;
+}
+
+// Solve for the poses of random joint configurations. Every branch must reach
+// the pose, the branches must be distinct, and one of them must be the
+// configuration the pose came from. Return the number of poses for which all
+// eight branches were found.
+static
+int CheckRoundTrips(const smpl::OPWParameters& params, int count)
+{
+    smpl::OPWIKSolver solver(params);
+    std::default_random_engine rng(count);
+    std::uniform_real_distribution<double> dist(-M_PI, M_PI);
+
+    auto all_branch_count = 0;
+    for (int n = 0; n < count; ++n) {
+        smpl::RobotState q(6);
+        for (auto& v : q) {
+            v = dist(rng);
+        }
+
+        // stay away from the wrist singularity, where the wrist branches
+        // coincide
+        if (std::fabs(std::sin(q[4] * params.sign_corrections[4] - params.offsets[4])) < 0.05) {
+            continue;
+        }
+
+        auto pose = solver.computeFK(q);
+
+        std::vector<smpl::RobotState> solutions;
+        auto solution_count = solver.computeIKBatch(pose, 0.0, solutions);
+        BOOST_REQUIRE_EQUAL(solution_count, (int)solutions.size());
+
+        // branches come in wrist pairs
+        BOOST_CHECK_EQUAL(solution_count % 2, 0);
+        BOOST_CHECK_LE(solution_count, 8);
+
+        auto found = false;
+        for (size_t i = 0; i < solutions.size(); ++i) {
+            BOOST_REQUIRE_EQUAL(solutions[i].size(), 6);
+            BOOST_CHECK_MESSAGE(
+                    SamePose(solver.computeFK(solutions[i]), pose),
+                    "branch " << i << " of pose " << n << " misses the pose");
+            for (size_t j = 0; j < i; ++j) {
+                BOOST_CHECK_MESSAGE(
+                        !SameAngles(solutions[i], solutions[j]),
+                        "branches " << j << " and " << i << " of pose " << n << " coincide");
+            }
+            found = found || SameAngles(solutions[i], q);
+        }
+        BOOST_CHECK_MESSAGE(found, "no branch of pose " << n << " matches its configuration");
+
+        if (solution_count == 8) {
+            ++all_branch_count;
+        }
+    }
+    return all_branch_count;
+}
+
+BOOST_AUTO_TEST_CASE(RoundTripTest)
+{
+    // some random poses must be reachable from all shoulder and elbow
+    // configurations
+    BOOST_CHECK_GT(CheckRoundTrips(MakeKukaParams(), 500), 0);
+}
+
+BOOST_AUTO_TEST_CASE(WristOffsetRoundTripTest)
+{
+    BOOST_CHECK_GT(CheckRoundTrips(MakeWristOffsetParams(), 500), 0);
+}
+
+BOOST_AUTO_TEST_CASE(AllBranchesTest)
+{
+    // the wrist center is near the base, within reach of both shoulder and
+    // elbow configurations
+    smpl::OPWIKSolver solver(MakeWristOffsetParams());
+    smpl::RobotState q = { 0.3, -0.4, 2.0, 0.5, 1.0, -0.7 };
+    auto pose = solver.computeFK(q);
+
+    std::vector<smpl::RobotState> solutions;
+    BOOST_REQUIRE_EQUAL(solver.computeIKBatch(pose, 0.0, solutions), 8);
+    for (auto& solution : solutions) {
+        BOOST_CHECK(SamePose(solver.computeFK(solution), pose));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(UnreachableTest)
+{
+    smpl::OPWIKSolver solver(MakeKukaParams());
+    smpl::Affine3 pose(smpl::Translation3(2.0, 0.0, 0.5));
+
+    std::vector<smpl::RobotState> solutions(1);
+    BOOST_CHECK_EQUAL(solver.computeIKBatch(pose, 0.0, solutions), 0);
+    BOOST_CHECK_EQUAL(solutions.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(WrapAngleToLimitsTest)
+{
+    auto check = [](double angle, double min, double max, double expected)
+    {
+        BOOST_REQUIRE(smpl::WrapAngleToLimits(angle, min, max));
+        BOOST_CHECK_CLOSE_FRACTION(angle, expected, 1.0e-12);
+    };
+    check(0.5, -M_PI, M_PI, 0.5);
+    check(1.5 * M_PI, -M_PI, M_PI, -0.5 * M_PI);
+    check(-4.0, 0.0, 2.0 * M_PI, 2.0 * M_PI - 4.0);
+    check(7.0 * M_PI + 0.5, -3.0, 3.0, -M_PI + 0.5);
+    check(-0.5, 2.0, 2.0 * M_PI + 1.0, 2.0 * M_PI - 0.5);
+
+    // no equivalent angle within the limits
+    auto angle = 0.5;
+    BOOST_CHECK(!smpl::WrapAngleToLimits(angle, 1.0, 2.0));
+    angle = std::nan("");
+    BOOST_CHECK(!smpl::WrapAngleToLimits(angle, -M_PI, M_PI));
+}
+
+BOOST_AUTO_TEST_CASE(WrappedRoundTripTest)
+{
+    // joint limits that admit the first and fourth joints of the source
+    // configuration only after wrapping
+    double min[6] = { 2.0, -2.0, 0.5, -7.0, -1.0, 0.0 };
+    double max[6] = { 8.0, 2.0, 4.0, -2.0, 5.5, 2.0 * M_PI };
+
+    smpl::OPWIKSolver solver(MakeKukaParams());
+    smpl::RobotState q = { 0.2, -0.3, 0.6, -0.4, 0.8, 0.3 };
+    auto pose = solver.computeFK(q);
+
+    std::vector<smpl::RobotState> solutions;
+    solver.computeIKBatch(pose, 0.0, solutions);
+    BOOST_REQUIRE(!solutions.empty());
+
+    auto found = false;
+    for (auto& solution : solutions) {
+        auto valid = true;
+        for (int i = 0; i < 6; ++i) {
+            if (!smpl::WrapAngleToLimits(solution[i], min[i], max[i])) {
+                valid = false;
+                break;
+            }
+            BOOST_CHECK_GE(solution[i], min[i]);
+            BOOST_CHECK_LE(solution[i], max[i]);
+        }
+        if (valid) {
+            BOOST_CHECK(SamePose(solver.computeFK(solution), pose));
+            found = found || SameAngles(solution, q);
+        }
+    }
+    BOOST_CHECK(found);
+}
+
+BOOST_AUTO_TEST_CASE(MakeAnalyticIKSolverTest)
+{
+    auto solver = smpl::MakeAnalyticIKSolver(
+            "opw",
+            "0.025 -0.035 0.0 0.4 0.315 0.365 0.08 "
+            "0 -1.5707963267948966 0 0 0 0 "
+            "-1 1 1 -1 1 -1 ");
+    BOOST_REQUIRE(solver);
+    BOOST_CHECK_EQUAL(solver->variableCount(), 6);
+    BOOST_CHECK_EQUAL(solver->freeVariableIndex(), -1);
+
+    // matches a solver constructed directly
+    smpl::OPWIKSolver expected(MakeKukaParams());
+    smpl::RobotState q = { 0.2, -0.3, 0.6, -0.4, 0.8, 0.3 };
+    auto* opw = dynamic_cast<smpl::OPWIKSolver*>(solver.get());
+    BOOST_REQUIRE(opw != NULL);
+    BOOST_CHECK(SamePose(opw->computeFK(q), expected.computeFK(q)));
+
+    // offsets and sign corrections are optional
+    smpl::OPWParameters params;
+    BOOST_CHECK(smpl::ParseOPWParameters("0.1 -0.05 0.08 0.5 0.45 0.4 0.1", params));
+    BOOST_CHECK_EQUAL(params.b, 0.08);
+    BOOST_CHECK_EQUAL(params.sign_corrections[5], 1);
+
+    BOOST_CHECK(!smpl::ParseOPWParameters("0.1 -0.05 0.08 0.5 0.45 0.4", params));
+    BOOST_CHECK(!smpl::ParseOPWParameters("0.1 -0.05 0.08 0.5 0.45 0.4 0.1 0 0", params));
+    BOOST_CHECK(!smpl::ParseOPWParameters("0.1 -0.05 0.08 0.5 0.45 0.4 0.1 x", params));
+    BOOST_CHECK(!smpl::ParseOPWParameters(
+            "0.1 -0.05 0.08 0.5 0.45 0.4 0.1 0 0 0 0 0 0 1 1 2 1 1 1", params));
+    BOOST_CHECK(!smpl::MakeAnalyticIKSolver("opw", "1 2 3"));
+    BOOST_CHECK(!smpl::MakeAnalyticIKSolver("ikfast", ""));
+}
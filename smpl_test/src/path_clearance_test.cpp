@@ -0,0 +1,268 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#define BOOST_TEST_MODULE PathClearanceTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// system includes
+#include <smpl/collision_checker.h>
+#include <smpl/occupancy_grid.h>
+#include <smpl/post_processing.h>
+#include <smpl/robot_model.h>
+
+// A sphere that translates freely within the unit cube, whose state is the
+// position of its center
+class PointRobotModel : public smpl::RobotModel
+{
+public:
+
+    PointRobotModel() { setPlanningJoints({ "x", "y", "z" }); }
+
+    double minPosLimit(int jidx) const override { return 0.0; }
+    double maxPosLimit(int jidx) const override { return 1.0; }
+    bool hasPosLimit(int jidx) const override { return true; }
+    bool isContinuous(int jidx) const override { return false; }
+    double velLimit(int jidx) const override { return 1.0; }
+    double accLimit(int jidx) const override { return 1.0; }
+
+    bool checkJointLimits(const smpl::RobotState& state, bool verbose = false) override
+    {
+        for (auto v : state) {
+            if (v < 0.0 || v > 1.0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto getExtension(size_t class_code) -> smpl::Extension* override
+    {
+        return NULL;
+    }
+};
+
+// Collision checking and CHOMP obstacle costs for a PointRobotModel against an
+// occupancy grid, using interpolated distances as the collision space does
+class PointCollisionChecker :
+    public smpl::CollisionChecker,
+    public smpl::ObstacleCostExtension
+{
+public:
+
+    PointCollisionChecker(const smpl::OccupancyGrid* grid, double radius) :
+        m_grid(grid), m_radius(radius)
+    { }
+
+    // distance from the surface of the sphere to the nearest obstacle
+    double clearance(const smpl::RobotState& state) const
+    {
+        return m_grid->getInterpDistanceFromPoint(state[0], state[1], state[2]) - m_radius;
+    }
+
+    bool isStateValid(const smpl::RobotState& state, bool verbose = false) override
+    {
+        return clearance(state) > 0.0;
+    }
+
+    bool isStateToStateValid(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        bool verbose = false) override
+    {
+        std::vector<smpl::RobotState> path;
+        return interpolatePath(start, finish, path) &&
+                std::all_of(path.begin(), path.end(),
+                        [&](const smpl::RobotState& s) { return isStateValid(s); });
+    }
+
+    bool interpolatePath(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        std::vector<smpl::RobotState>& path) override
+    {
+        const double step = 0.5 * m_grid->resolution();
+        double len = 0.0;
+        for (size_t i = 0; i < start.size(); ++i) {
+            len += (finish[i] - start[i]) * (finish[i] - start[i]);
+        }
+        const int count = std::max(1, (int)std::ceil(std::sqrt(len) / step));
+        path.clear();
+        for (int k = 0; k <= count; ++k) {
+            smpl::RobotState s(start.size());
+            for (size_t i = 0; i < start.size(); ++i) {
+                s[i] = start[i] + (double)k / (double)count * (finish[i] - start[i]);
+            }
+            path.push_back(std::move(s));
+        }
+        return true;
+    }
+
+    double obstacleCost(const smpl::RobotState& state, double margin) override
+    {
+        std::vector<double> grad;
+        return obstacleCostGradient(state, margin, grad);
+    }
+
+    double obstacleCostGradient(
+        const smpl::RobotState& state,
+        double margin,
+        std::vector<double>& grad) override
+    {
+        smpl::Vector3 dgrad;
+        const double d = m_grid->getInterpDistanceFromPoint(
+                state[0], state[1], state[2], dgrad) - m_radius;
+        grad.assign(3, 0.0);
+        if (d < 0.0) {
+            for (int i = 0; i < 3; ++i) {
+                grad[i] = -dgrad[i];
+            }
+            return 0.5 * margin - d;
+        } else if (d < margin) {
+            for (int i = 0; i < 3; ++i) {
+                grad[i] = (d - margin) / margin * dgrad[i];
+            }
+            return 0.5 * (d - margin) * (d - margin) / margin;
+        } else {
+            return 0.0;
+        }
+    }
+
+    auto getExtension(size_t class_code) -> smpl::Extension* override
+    {
+        if (class_code == smpl::GetClassCode<smpl::CollisionChecker>() ||
+            class_code == smpl::GetClassCode<smpl::ObstacleCostExtension>())
+        {
+            return this;
+        }
+        return NULL;
+    }
+
+private:
+
+    const smpl::OccupancyGrid* m_grid;
+    double m_radius;
+};
+
+double MinClearance(
+    PointCollisionChecker& cc,
+    const std::vector<smpl::RobotState>& path)
+{
+    auto min_clearance = std::numeric_limits<double>::infinity();
+    for (size_t i = 1; i < path.size(); ++i) {
+        std::vector<smpl::RobotState> segment;
+        cc.interpolatePath(path[i - 1], path[i], segment);
+        for (auto& state : segment) {
+            min_clearance = std::min(min_clearance, cc.clearance(state));
+        }
+    }
+    return min_clearance;
+}
+
+void AddBox(
+    smpl::OccupancyGrid& grid,
+    double min_x, double min_y, double min_z,
+    double max_x, double max_y, double max_z)
+{
+    std::vector<smpl::Vector3> points;
+    const double res = grid.resolution();
+    for (double x = min_x; x <= max_x; x += res) {
+    for (double y = min_y; y <= max_y; y += res) {
+    for (double z = min_z; z <= max_z; z += res) {
+        points.emplace_back(x, y, z);
+    }
+    }
+    }
+    grid.addPointsToField(points);
+}
+
+BOOST_AUTO_TEST_CASE(GrazingPathClearanceIncreasesTest)
+{
+    smpl::OccupancyGrid grid(1.0, 1.0, 1.0, 0.02, 0.0, 0.0, 0.0, 0.2);
+    AddBox(grid, 0.4, 0.4, 0.4, 0.6, 0.6, 0.6);
+
+    PointRobotModel robot;
+    PointCollisionChecker cc(&grid, 0.02);
+
+    // a straight path that passes just over the top of the box
+    std::vector<smpl::RobotState> path = {
+        { 0.1, 0.65, 0.5 },
+        { 0.9, 0.65, 0.5 },
+    };
+
+    BOOST_REQUIRE(cc.isStateToStateValid(path.front(), path.back()));
+
+    smpl::PathClearanceParams params;
+    params.margin = 0.1;
+    const double clearance_before = MinClearance(cc, path);
+    BOOST_REQUIRE(clearance_before < params.margin);
+
+    auto optimized = path;
+    BOOST_REQUIRE(smpl::OptimizePathClearance(&robot, &cc, optimized, params));
+
+    BOOST_CHECK_EQUAL(optimized.front()[0], path.front()[0]);
+    BOOST_CHECK_EQUAL(optimized.back()[0], path.back()[0]);
+    for (size_t i = 1; i < optimized.size(); ++i) {
+        BOOST_CHECK(cc.isStateToStateValid(optimized[i - 1], optimized[i]));
+    }
+
+    const double clearance_after = MinClearance(cc, optimized);
+    BOOST_TEST_MESSAGE("clearance " << clearance_before << " -> " << clearance_after);
+    BOOST_CHECK_GT(clearance_after, clearance_before + 0.5 * grid.resolution());
+}
+
+BOOST_AUTO_TEST_CASE(ClearPathUnchangedTest)
+{
+    smpl::OccupancyGrid grid(1.0, 1.0, 1.0, 0.02, 0.0, 0.0, 0.0, 0.2);
+    AddBox(grid, 0.4, 0.4, 0.4, 0.6, 0.6, 0.6);
+
+    PointRobotModel robot;
+    PointCollisionChecker cc(&grid, 0.02);
+
+    // a straight path far from the box is already optimal
+    std::vector<smpl::RobotState> path = {
+        { 0.1, 0.9, 0.5 },
+        { 0.9, 0.9, 0.5 },
+    };
+
+    auto optimized = path;
+    BOOST_REQUIRE(smpl::OptimizePathClearance(&robot, &cc, optimized));
+    for (auto& state : optimized) {
+        BOOST_CHECK_CLOSE(state[1], 0.9, 1e-6);
+        BOOST_CHECK_CLOSE(state[2], 0.5, 1e-6);
+    }
+}
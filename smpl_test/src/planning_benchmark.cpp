@@ -0,0 +1,754 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+// Offline planning benchmark. Loads a scenario file describing a robot, a
+// world, a list of queries, and a list of planner configurations, and reports
+// planning statistics for each planner. Does not require a ROS master or the
+// parameter server. See smpl_test/experiments/tabletop_arm.scenario for the
+// scenario file format.
+
+// standard includes
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// system includes
+#include <Eigen/Dense>
+#include <sbpl_collision_checking/collision_space.h>
+#include <sbpl_collision_checking/shapes.h>
+#include <sbpl_kdl_robot_model/kdl_robot_model.h>
+#include <smpl/angles.h>
+#include <smpl/batch_planner.h>
+#include <smpl/collision_checker.h>
+#include <smpl/occupancy_grid.h>
+#include <smpl/planning_params.h>
+#include <smpl/robot_model.h>
+#include <smpl/console/console.h>
+#include <smpl/distance_map/euclid_distance_map.h>
+#include <smpl/ros/factories.h>
+#include <smpl/stl/memory.h>
+
+struct ScenarioObject
+{
+    std::string id;
+    std::string type; // "box", "sphere", or "cylinder"
+    std::vector<double> dims;
+    Eigen::Vector3d position;
+};
+
+struct ScenarioPlanner
+{
+    std::string name;
+    std::string search;
+    std::string heuristic;
+    std::string graph;
+    double allowed_time = 1.0;
+    int repetitions = 1;
+    smpl::PlanningParams params;
+};
+
+struct Scenario
+{
+    std::string urdf_filename;
+    std::string group_name = "manipulator";
+    std::vector<std::string> planning_joints;
+    std::string kinematics_frame;
+    std::string chain_tip_link;
+    std::string ik_solver;
+    std::string ik_solver_params;
+
+    std::vector<std::string> collision_links;
+    double sphere_radius = 0.05;
+    std::vector<std::pair<std::string, std::string>> allowed_collisions;
+
+    // origin_x origin_y origin_z size_x size_y size_z resolution max_distance
+    double world[8] = { -1.0, -1.0, -1.0, 2.0, 2.0, 2.0, 0.02, 0.2 };
+
+    std::vector<ScenarioObject> objects;
+    std::vector<smpl::PlanningQuery> queries;
+    std::vector<ScenarioPlanner> planners;
+};
+
+// Resolve a path relative to the directory containing the scenario file.
+static
+auto ResolvePath(const std::string& scenario_filename, const std::string& path)
+    -> std::string
+{
+    if (path.empty() || path[0] == '/') {
+        return path;
+    }
+    auto slash = scenario_filename.find_last_of('/');
+    if (slash == std::string::npos) {
+        return path;
+    }
+    return scenario_filename.substr(0, slash + 1) + path;
+}
+
+static
+bool ReadValues(std::istringstream& ss, int count, std::vector<double>& values)
+{
+    values.resize(count);
+    for (auto& value : values) {
+        if (!(ss >> value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Add a planner parameter, inferring its type from its textual value. Values
+// that do not parse as a bool, int, or double are stored as strings.
+static
+void AddPlannerParam(
+    smpl::PlanningParams& params,
+    const std::string& key,
+    const std::string& value)
+{
+    if (value == "true" || value == "false") {
+        params.addParam(key, value == "true");
+        return;
+    }
+
+    char* end = NULL;
+    auto i = strtol(value.c_str(), &end, 10);
+    if (!value.empty() && *end == '\0') {
+        params.addParam(key, (int)i);
+        return;
+    }
+
+    auto d = strtod(value.c_str(), &end);
+    if (!value.empty() && *end == '\0') {
+        params.addParam(key, d);
+        return;
+    }
+
+    params.addParam(key, value);
+}
+
+// Parse a goal of the given type, following the start state, from a query
+// line. Joint goals are followed by a tolerance, position goals by an xyz
+// tolerance, and pose goals by an xyz and an rpy tolerance.
+static
+bool ReadQueryGoal(
+    std::istringstream& ss,
+    const std::string& type,
+    int variable_count,
+    smpl::GoalConstraint& goal)
+{
+    std::vector<double> values;
+    if (type == "query_joints") {
+        if (!ReadValues(ss, variable_count + 1, values)) {
+            return false;
+        }
+        goal.type = smpl::GoalType::JOINT_STATE_GOAL;
+        goal.angles.assign(values.begin(), values.begin() + variable_count);
+        goal.angle_tolerances.assign(variable_count, values.back());
+        return true;
+    } else if (type == "query_position") {
+        if (!ReadValues(ss, 4, values)) {
+            return false;
+        }
+        goal.type = smpl::GoalType::XYZ_GOAL;
+        goal.pose = Eigen::Translation3d(values[0], values[1], values[2]);
+        std::fill(goal.xyz_tolerance, goal.xyz_tolerance + 3, values[3]);
+        std::fill(goal.rpy_tolerance, goal.rpy_tolerance + 3, M_PI);
+        return true;
+    } else if (type == "query_pose") {
+        if (!ReadValues(ss, 8, values)) {
+            return false;
+        }
+        goal.type = smpl::GoalType::XYZ_RPY_GOAL;
+        goal.pose = Eigen::Translation3d(values[0], values[1], values[2]) *
+                Eigen::AngleAxisd(values[5], Eigen::Vector3d::UnitZ()) *
+                Eigen::AngleAxisd(values[4], Eigen::Vector3d::UnitY()) *
+                Eigen::AngleAxisd(values[3], Eigen::Vector3d::UnitX());
+        std::fill(goal.xyz_tolerance, goal.xyz_tolerance + 3, values[6]);
+        std::fill(goal.rpy_tolerance, goal.rpy_tolerance + 3, values[7]);
+        return true;
+    }
+    return false;
+}
+
+bool LoadScenario(const std::string& filename, Scenario& scenario)
+{
+    std::ifstream f(filename);
+    if (!f.is_open()) {
+        SMPL_ERROR("Failed to open scenario file '%s'", filename.c_str());
+        return false;
+    }
+
+    ScenarioPlanner* planner = NULL;
+
+    std::string line;
+    int line_num = 0;
+    while (std::getline(f, line)) {
+        ++line_num;
+        auto hash = line.find('#');
+        if (hash != std::string::npos) {
+            line.erase(hash);
+        }
+
+        std::istringstream ss(line);
+        std::string key;
+        if (!(ss >> key)) {
+            continue; // blank line
+        }
+
+        auto malformed = [&]()
+        {
+            SMPL_ERROR("%s:%d: malformed '%s' entry", filename.c_str(), line_num, key.c_str());
+            return false;
+        };
+
+        // everything between 'planner' and 'end' configures that planner
+        if (planner != NULL) {
+            if (key == "end") {
+                planner = NULL;
+            } else if (key == "search") {
+                ss >> planner->search;
+            } else if (key == "heuristic") {
+                ss >> planner->heuristic;
+            } else if (key == "graph") {
+                ss >> planner->graph;
+            } else if (key == "allowed_time") {
+                if (!(ss >> planner->allowed_time)) return malformed();
+            } else if (key == "repetitions") {
+                if (!(ss >> planner->repetitions)) return malformed();
+            } else {
+                std::string value;
+                std::getline(ss >> std::ws, value);
+                while (!value.empty() && isspace(value.back())) {
+                    value.pop_back();
+                }
+                if (key == "mprim_filename" || key == "egraph_path") {
+                    value = ResolvePath(filename, value);
+                }
+                AddPlannerParam(planner->params, key, value);
+            }
+            continue;
+        }
+
+        if (key == "urdf") {
+            if (!(ss >> scenario.urdf_filename)) return malformed();
+            scenario.urdf_filename = ResolvePath(filename, scenario.urdf_filename);
+        } else if (key == "group") {
+            if (!(ss >> scenario.group_name)) return malformed();
+        } else if (key == "planning_joints") {
+            std::string name;
+            while (ss >> name) {
+                scenario.planning_joints.push_back(name);
+            }
+        } else if (key == "kinematics_frame") {
+            if (!(ss >> scenario.kinematics_frame)) return malformed();
+        } else if (key == "chain_tip_link") {
+            if (!(ss >> scenario.chain_tip_link)) return malformed();
+        } else if (key == "ik_solver") {
+            if (!(ss >> scenario.ik_solver)) return malformed();
+            std::getline(ss >> std::ws, scenario.ik_solver_params);
+        } else if (key == "collision_links") {
+            std::string name;
+            while (ss >> name) {
+                scenario.collision_links.push_back(name);
+            }
+        } else if (key == "sphere_radius") {
+            if (!(ss >> scenario.sphere_radius)) return malformed();
+        } else if (key == "allow_collision") {
+            std::string a, b;
+            if (!(ss >> a >> b)) return malformed();
+            scenario.allowed_collisions.emplace_back(a, b);
+        } else if (key == "world") {
+            for (auto& value : scenario.world) {
+                if (!(ss >> value)) return malformed();
+            }
+        } else if (key == "box" || key == "sphere" || key == "cylinder") {
+            ScenarioObject object;
+            object.type = key;
+            std::vector<double> values;
+            auto dim_count = key == "box" ? 3 : key == "sphere" ? 1 : 2;
+            if (!(ss >> object.id) || !ReadValues(ss, 3 + dim_count, values)) {
+                return malformed();
+            }
+            object.position = Eigen::Vector3d(values[0], values[1], values[2]);
+            object.dims.assign(values.begin() + 3, values.end());
+            scenario.objects.push_back(object);
+        } else if (key == "query_joints" ||
+            key == "query_position" ||
+            key == "query_pose")
+        {
+            if (scenario.planning_joints.empty()) {
+                SMPL_ERROR("%s:%d: 'planning_joints' must precede queries", filename.c_str(), line_num);
+                return false;
+            }
+            smpl::PlanningQuery query;
+            if (!ReadValues(ss, scenario.planning_joints.size(), query.start) ||
+                !ReadQueryGoal(ss, key, scenario.planning_joints.size(), query.goal))
+            {
+                return malformed();
+            }
+            scenario.queries.push_back(query);
+        } else if (key == "planner") {
+            scenario.planners.emplace_back();
+            planner = &scenario.planners.back();
+            if (!(ss >> planner->name)) return malformed();
+        } else {
+            SMPL_ERROR("%s:%d: unrecognized entry '%s'", filename.c_str(), line_num, key.c_str());
+            return false;
+        }
+    }
+
+    if (planner != NULL) {
+        SMPL_ERROR("%s: planner '%s' is missing 'end'", filename.c_str(), planner->name.c_str());
+        return false;
+    }
+
+    if (scenario.urdf_filename.empty() ||
+        scenario.planning_joints.empty() ||
+        scenario.kinematics_frame.empty() ||
+        scenario.chain_tip_link.empty())
+    {
+        SMPL_ERROR("%s: scenario requires 'urdf', 'planning_joints', 'kinematics_frame', and 'chain_tip_link'", filename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+// Forwards collision checks to another collision checker, counting them.
+class CountingCollisionChecker : public smpl::CollisionChecker
+{
+public:
+
+    smpl::CollisionChecker* checker = NULL;
+    std::uint64_t state_checks = 0;
+    std::uint64_t motion_checks = 0;
+
+    bool isStateValid(const smpl::RobotState& state, bool verbose) override
+    {
+        ++state_checks;
+        return checker->isStateValid(state, verbose);
+    }
+
+    bool isStateToStateValid(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        bool verbose) override
+    {
+        ++motion_checks;
+        return checker->isStateToStateValid(start, finish, verbose);
+    }
+
+    bool interpolatePath(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        std::vector<smpl::RobotState>& path) override
+    {
+        return checker->interpolatePath(start, finish, path);
+    }
+
+    auto getCollisionModelVisualization(const smpl::RobotState& state)
+        -> std::vector<smpl::visual::Marker> override
+    {
+        return checker->getCollisionModelVisualization(state);
+    }
+
+    auto getExtension(size_t class_code) -> smpl::Extension* override
+    {
+        if (class_code == smpl::GetClassCode<smpl::CollisionChecker>()) {
+            return this;
+        }
+        return checker->getExtension(class_code);
+    }
+};
+
+using SpaceFactory = std::function<
+        std::unique_ptr<smpl::RobotPlanningSpace>(
+                smpl::RobotModel*,
+                smpl::CollisionChecker*,
+                const smpl::PlanningParams&,
+                const smpl::OccupancyGrid*)>;
+
+using HeuristicFactory = std::function<
+        std::unique_ptr<smpl::RobotHeuristic>(
+                smpl::RobotPlanningSpace*,
+                const smpl::PlanningParams&,
+                const smpl::OccupancyGrid*)>;
+
+using SearchFactory = std::function<
+        std::unique_ptr<SBPLPlanner>(
+                smpl::RobotPlanningSpace*,
+                smpl::RobotHeuristic*,
+                const smpl::PlanningParams&)>;
+
+// Percentile of a sorted sequence, using the nearest-rank method
+static
+double Percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    auto rank = (size_t)std::ceil(p * (double)sorted.size());
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+// read a memory field (e.g. VmRSS, VmHWM) of this process, in megabytes
+static
+double ReadProcessMemoryMB(const std::string& field)
+{
+    std::ifstream ifs("/proc/self/status");
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.compare(0, field.size(), field) == 0 &&
+            line.size() > field.size() && line[field.size()] == ':')
+        {
+            std::istringstream iss(line.substr(field.size() + 1));
+            double kb;
+            if (iss >> kb) {
+                return kb / 1024.0;
+            }
+        }
+    }
+    return 0.0;
+}
+
+// reset the peak resident set size (VmHWM) of this process to its current
+// resident set size
+static
+bool ResetPeakMemory()
+{
+    std::ofstream ofs("/proc/self/clear_refs");
+    ofs << "5";
+    ofs.close();
+    return !ofs.fail();
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: planning_benchmark <scenario file>\n");
+        return 1;
+    }
+
+    Scenario scenario;
+    if (!LoadScenario(argv[1], scenario)) {
+        return 1;
+    }
+
+    //////////////////////
+    // Robot Model Init //
+    //////////////////////
+
+    std::ifstream urdf_file(scenario.urdf_filename);
+    if (!urdf_file.is_open()) {
+        SMPL_ERROR("Failed to open URDF '%s'", scenario.urdf_filename.c_str());
+        return 1;
+    }
+    std::string robot_description(
+            (std::istreambuf_iterator<char>(urdf_file)),
+            std::istreambuf_iterator<char>());
+
+    smpl::KDLRobotModel rm;
+    if (!rm.init(
+            robot_description,
+            scenario.kinematics_frame,
+            scenario.chain_tip_link))
+    {
+        SMPL_ERROR("Failed to initialize robot model");
+        return 1;
+    }
+
+    if (!scenario.ik_solver.empty()) {
+        auto solver = smpl::MakeAnalyticIKSolver(
+                scenario.ik_solver, scenario.ik_solver_params);
+        if (!solver || !rm.setAnalyticIKSolver(std::move(solver))) {
+            SMPL_ERROR("Failed to install analytic IK solver '%s'", scenario.ik_solver.c_str());
+            return 1;
+        }
+    }
+
+    // workspace heuristics expect the pose of the planning link at the goal
+    auto* fk_iface = rm.getExtension<smpl::ForwardKinematicsInterface>();
+    for (auto& query : scenario.queries) {
+        if (query.goal.type == smpl::GoalType::JOINT_STATE_GOAL) {
+            if (fk_iface) {
+                query.goal.pose = fk_iface->computeFK(query.goal.angles);
+            } else {
+                query.goal.pose = Eigen::Affine3d::Identity();
+            }
+        }
+    }
+
+    ////////////////////
+    // Occupancy Grid //
+    ////////////////////
+
+    auto& w = scenario.world;
+    auto df = std::make_shared<smpl::EuclidDistanceMap>(
+            w[0], w[1], w[2], w[3], w[4], w[5], w[6], w[7]);
+    smpl::OccupancyGrid grid(df);
+    grid.setReferenceFrame(scenario.kinematics_frame);
+
+    ///////////////////////////
+    // Collision Space Setup //
+    ///////////////////////////
+
+    smpl::collision::CollisionModelConfig cc_conf;
+    cc_conf.world_joint.name = "world_joint";
+    cc_conf.world_joint.type = "fixed";
+    for (auto& link : scenario.collision_links) {
+        smpl::collision::CollisionSpheresModelConfig spheres_config;
+        spheres_config.link_name = link;
+        spheres_config.autogenerate = true;
+        spheres_config.radius = scenario.sphere_radius;
+        cc_conf.spheres_models.push_back(spheres_config);
+    }
+    smpl::collision::CollisionGroupConfig group_config;
+    group_config.name = scenario.group_name;
+    group_config.links = scenario.collision_links;
+    cc_conf.groups.push_back(group_config);
+
+    smpl::collision::CollisionSpace cc;
+    if (!cc.init(
+            &grid,
+            rm.m_urdf,
+            cc_conf,
+            scenario.group_name,
+            scenario.planning_joints))
+    {
+        SMPL_ERROR("Failed to initialize Collision Space");
+        return 1;
+    }
+    cc.setWorldToModelTransform(Eigen::Affine3d::Identity());
+
+    // links sharing a joint are always in contact
+    smpl::collision::AllowedCollisionMatrix acm;
+    for (auto& entry : rm.m_urdf.links_) {
+        auto& link = entry.second;
+        if (link->getParent()) {
+            acm.setEntry(link->name, link->getParent()->name, true);
+        }
+    }
+    for (auto& pair : scenario.allowed_collisions) {
+        acm.setEntry(pair.first, pair.second, true);
+    }
+    cc.setAllowedCollisionMatrix(acm);
+
+    std::vector<std::unique_ptr<smpl::collision::CollisionShape>> shapes;
+    std::vector<std::unique_ptr<smpl::collision::CollisionObject>> objects;
+    for (auto& o : scenario.objects) {
+        std::unique_ptr<smpl::collision::CollisionShape> shape;
+        if (o.type == "box") {
+            shape = smpl::make_unique<smpl::collision::BoxShape>(
+                    o.dims[0], o.dims[1], o.dims[2]);
+        } else if (o.type == "sphere") {
+            shape = smpl::make_unique<smpl::collision::SphereShape>(o.dims[0]);
+        } else {
+            shape = smpl::make_unique<smpl::collision::CylinderShape>(
+                    o.dims[0], o.dims[1]);
+        }
+
+        auto object = smpl::make_unique<smpl::collision::CollisionObject>();
+        object->id = o.id;
+        object->shapes.push_back(shape.get());
+        object->shape_poses.push_back(
+                Eigen::Affine3d(Eigen::Translation3d(o.position)));
+        shapes.push_back(std::move(shape));
+        objects.push_back(std::move(object));
+
+        if (!cc.insertObject(objects.back().get())) {
+            SMPL_ERROR("Failed to insert object '%s'", o.id.c_str());
+            return 1;
+        }
+    }
+
+    SMPL_INFO("Loaded scenario with %zu objects, %zu queries, and %zu planners", scenario.objects.size(), scenario.queries.size(), scenario.planners.size());
+
+    CountingCollisionChecker counting_cc;
+    counting_cc.checker = &cc;
+
+    ///////////////
+    // Factories //
+    ///////////////
+
+    std::map<std::string, SpaceFactory> space_factories;
+    space_factories["manip"] = smpl::MakeManipLattice;
+    space_factories["manip_lattice_egraph"] = smpl::MakeManipLatticeEGraph;
+    space_factories["workspace"] = smpl::MakeWorkspaceLattice;
+    space_factories["workspace_egraph"] = smpl::MakeWorkspaceLatticeEGraph;
+    space_factories["adaptive_workspace_lattice"] = smpl::MakeAdaptiveWorkspaceLattice;
+
+    std::map<std::string, HeuristicFactory> heuristic_factories;
+    heuristic_factories["mfbfs"] = smpl::MakeMultiFrameBFSHeuristic;
+    heuristic_factories["bfs"] = smpl::MakeBFSHeuristic;
+    heuristic_factories["euclid"] = [](
+        smpl::RobotPlanningSpace* space,
+        const smpl::PlanningParams& params,
+        const smpl::OccupancyGrid*)
+    {
+        return smpl::MakeEuclidDistHeuristic(space, params);
+    };
+    heuristic_factories["joint_distance"] = [](
+        smpl::RobotPlanningSpace* space,
+        const smpl::PlanningParams& params,
+        const smpl::OccupancyGrid*)
+    {
+        return smpl::MakeJointDistHeuristic(space, params);
+    };
+    heuristic_factories["bfs_egraph"] = smpl::MakeDijkstraEgraphHeuristic3D;
+    heuristic_factories["joint_distance_egraph"] = [](
+        smpl::RobotPlanningSpace* space,
+        const smpl::PlanningParams& params,
+        const smpl::OccupancyGrid*)
+    {
+        return smpl::MakeJointDistEGraphHeuristic(space, params);
+    };
+
+    std::map<std::string, SearchFactory> search_factories;
+    search_factories["arastar"] = smpl::MakeARAStar;
+    search_factories["awastar"] = smpl::MakeAWAStar;
+    search_factories["mhastar"] = smpl::MakeMHAStar;
+    search_factories["larastar"] = smpl::MakeLARAStar;
+    search_factories["egwastar"] = smpl::MakeEGWAStar;
+    search_factories["padastar"] = smpl::MakePADAStar;
+
+    ////////////////
+    // Benchmarks //
+    ////////////////
+
+    printf("%-28s %7s %7s %9s %9s %9s %9s %12s %12s %10s %9s\n",
+            "planner", "queries", "solved",
+            "t_p50", "t_p90", "t_p99", "t_max",
+            "expands/s", "checks/s", "cost_mean", "mem_mb");
+
+    auto status = 0;
+    for (auto& planner : scenario.planners) {
+        auto sit = space_factories.find(planner.graph);
+        auto hit = heuristic_factories.find(planner.heuristic);
+        auto pit = search_factories.find(planner.search);
+        if (sit == end(space_factories) ||
+            hit == end(heuristic_factories) ||
+            pit == end(search_factories))
+        {
+            SMPL_ERROR("Planner '%s' has an unrecognized graph, heuristic, or search", planner.name.c_str());
+            status = 1;
+            continue;
+        }
+
+        // Memory is reported as the peak resident set size while this planner
+        // is constructed and run, less the resident set size beforehand, so
+        // that memory is not attributed to later planners
+        auto base_mb = ReadProcessMemoryMB("VmRSS");
+        if (!ResetPeakMemory()) {
+            SMPL_WARN_ONCE("Failed to reset peak memory; mem_mb reports growth over the previous peak");
+            base_mb = ReadProcessMemoryMB("VmHWM");
+        }
+
+        // Queries are solved one at a time, by a single worker, so that
+        // timings are not perturbed by contention between workers
+        smpl::BatchPlanner batch;
+        auto init_ok = batch.init(1, [&](int, smpl::BatchPlannerWorker& worker)
+        {
+            worker.space = sit->second(&rm, &counting_cc, planner.params, &grid);
+            if (!worker.space) {
+                return false;
+            }
+            auto heuristic = hit->second(worker.space.get(), planner.params, &grid);
+            if (!heuristic || !worker.space->insertHeuristic(heuristic.get())) {
+                return false;
+            }
+            worker.search = pit->second(
+                    worker.space.get(), heuristic.get(), planner.params);
+            worker.heuristics.push_back(std::move(heuristic));
+            return worker.search != nullptr;
+        });
+        if (!init_ok) {
+            SMPL_ERROR("Failed to initialize planner '%s'", planner.name.c_str());
+            status = 1;
+            continue;
+        }
+
+        auto queries = scenario.queries;
+        for (auto& query : queries) {
+            query.allowed_time = planner.allowed_time;
+        }
+
+        std::vector<double> times;
+        std::uint64_t expansions = 0;
+        std::uint64_t solved = 0;
+        double total_cost = 0.0;
+
+        counting_cc.state_checks = 0;
+        counting_cc.motion_checks = 0;
+
+        for (int r = 0; r < planner.repetitions; ++r) {
+            std::vector<smpl::PlanningQueryResult> results;
+            batch.solve(queries, results);
+            for (auto& result : results) {
+                times.push_back(result.planning_time);
+                expansions += result.expansions;
+                if (result.solved) {
+                    ++solved;
+                    total_cost += result.cost;
+                }
+            }
+        }
+
+        std::sort(begin(times), end(times));
+        auto total_time = std::accumulate(begin(times), end(times), 0.0);
+        auto checks = counting_cc.state_checks + counting_cc.motion_checks;
+
+        printf("%-28s %7zu %7llu %9.4f %9.4f %9.4f %9.4f %12.1f %12.1f %10.1f %9.1f\n",
+                planner.name.c_str(),
+                times.size(),
+                (unsigned long long)solved,
+                Percentile(times, 0.5),
+                Percentile(times, 0.9),
+                Percentile(times, 0.99),
+                times.empty() ? 0.0 : times.back(),
+                total_time > 0.0 ? (double)expansions / total_time : 0.0,
+                total_time > 0.0 ? (double)checks / total_time : 0.0,
+                solved > 0 ? total_cost / (double)solved : 0.0,
+                std::max(0.0, ReadProcessMemoryMB("VmHWM") - base_mb));
+    }
+
+    return status;
+}
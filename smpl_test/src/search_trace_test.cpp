@@ -0,0 +1,266 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+// standard includes
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+// system includes
+#include <unistd.h>
+
+#define BOOST_TEST_MODULE SearchTraceTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// project includes
+#include <smpl/planning_params.h>
+#include <smpl/search/search_trace.h>
+
+// Removes the temporary file it names on destruction
+struct TempFile
+{
+    std::string path;
+
+    TempFile()
+    {
+        char name[] = "/tmp/search_trace_test_XXXXXX";
+        int fd = mkstemp(name);
+        BOOST_REQUIRE(fd != -1);
+        close(fd);
+        path = name;
+    }
+
+    ~TempFile() { std::remove(path.c_str()); }
+};
+
+// Record a problem blob and a search with two iterations
+void WriteTestTrace(const std::string& path)
+{
+    smpl::SearchTraceWriter writer;
+    BOOST_REQUIRE(writer.open(path));
+
+    const std::string problem = "problem data";
+    writer.writeBlob("test/Problem", problem.data(), problem.size());
+
+    writer.beginSearch(5, 1);
+    writer.beginIteration(0, 100.0);
+    writer.expansion(5, 0, 40, 4000, { 7, 3, 1000 }, { 10, 20, 30 });
+    writer.beginIteration(1, 1.5);
+    writer.expansion(7, 10, 30, 55, { }, { });
+    writer.endSearch(true, 42, 2);
+    writer.close();
+}
+
+BOOST_AUTO_TEST_CASE(RoundTripTest)
+{
+    TempFile file;
+    WriteTestTrace(file.path);
+
+    smpl::SearchTraceReader reader;
+    BOOST_REQUIRE(reader.open(file.path));
+
+    smpl::SearchTraceRecord record;
+    BOOST_REQUIRE(reader.read(record));
+    BOOST_CHECK(record.type == smpl::SearchTraceRecordType::Blob);
+    BOOST_CHECK_EQUAL(record.name, "test/Problem");
+    BOOST_CHECK_EQUAL(record.data, "problem data");
+
+    BOOST_REQUIRE(reader.read(record));
+    BOOST_CHECK(record.type == smpl::SearchTraceRecordType::SearchBegin);
+    BOOST_CHECK_EQUAL(record.start_state_id, 5);
+    BOOST_CHECK_EQUAL(record.goal_state_id, 1);
+
+    BOOST_REQUIRE(reader.read(record));
+    BOOST_CHECK(record.type == smpl::SearchTraceRecordType::Iteration);
+    BOOST_CHECK_EQUAL(record.iteration, 0);
+    BOOST_CHECK_EQUAL(record.eps, 100.0);
+
+    BOOST_REQUIRE(reader.read(record));
+    BOOST_CHECK(record.type == smpl::SearchTraceRecordType::Expansion);
+    BOOST_CHECK_EQUAL(record.state_id, 5);
+    BOOST_CHECK_EQUAL(record.g, 0);
+    BOOST_CHECK_EQUAL(record.h, 40);
+    BOOST_CHECK_EQUAL(record.f, 4000);
+    BOOST_CHECK(record.succs == std::vector<int>({ 7, 3, 1000 }));
+    BOOST_CHECK(record.costs == std::vector<int>({ 10, 20, 30 }));
+    const auto first_time = record.time;
+    BOOST_CHECK_GE(first_time, 0);
+
+    BOOST_REQUIRE(reader.read(record));
+    BOOST_CHECK(record.type == smpl::SearchTraceRecordType::Iteration);
+    BOOST_CHECK_EQUAL(record.iteration, 1);
+    BOOST_CHECK_EQUAL(record.eps, 1.5);
+
+    BOOST_REQUIRE(reader.read(record));
+    BOOST_CHECK(record.type == smpl::SearchTraceRecordType::Expansion);
+    BOOST_CHECK_EQUAL(record.state_id, 7);
+    BOOST_CHECK(record.succs.empty());
+    BOOST_CHECK_GE(record.time, first_time);
+
+    BOOST_REQUIRE(reader.read(record));
+    BOOST_CHECK(record.type == smpl::SearchTraceRecordType::SearchEnd);
+    BOOST_CHECK(record.solved);
+    BOOST_CHECK_EQUAL(record.cost, 42);
+    BOOST_CHECK_EQUAL(record.expansions, 2);
+
+    // a clean end is not an error
+    BOOST_CHECK(!reader.read(record));
+    BOOST_CHECK(!reader.error());
+}
+
+BOOST_AUTO_TEST_CASE(TruncatedTraceTest)
+{
+    TempFile file;
+    WriteTestTrace(file.path);
+
+    // cut the trace short in the middle of the last record
+    std::FILE* f = std::fopen(file.path.c_str(), "rb");
+    BOOST_REQUIRE(f);
+    std::fseek(f, 0, SEEK_END);
+    auto size = std::ftell(f);
+    std::fclose(f);
+    BOOST_REQUIRE(truncate(file.path.c_str(), size - 1) == 0);
+
+    smpl::SearchTraceReader reader;
+    BOOST_REQUIRE(reader.open(file.path));
+
+    smpl::SearchTraceRecord record;
+    int count = 0;
+    while (reader.read(record)) {
+        ++count;
+        BOOST_CHECK(record.type != smpl::SearchTraceRecordType::SearchEnd);
+    }
+    BOOST_CHECK_EQUAL(count, 6);
+    BOOST_CHECK(reader.error());
+}
+
+// Check that a trace of one search, followed by the given bytes, reads back
+// the search and then reports an error rather than failing in some other way.
+static
+void CheckCorruptTrace(const std::vector<unsigned char>& bytes)
+{
+    TempFile file;
+    {
+        smpl::SearchTraceWriter writer;
+        BOOST_REQUIRE(writer.open(file.path));
+        writer.beginSearch(0, 1);
+        writer.close();
+    }
+
+    std::FILE* f = std::fopen(file.path.c_str(), "ab");
+    BOOST_REQUIRE(f);
+    std::fwrite(bytes.data(), 1, bytes.size(), f);
+    std::fclose(f);
+
+    smpl::SearchTraceReader reader;
+    BOOST_REQUIRE(reader.open(file.path));
+    smpl::SearchTraceRecord record;
+    BOOST_REQUIRE(reader.read(record));
+    BOOST_CHECK(!reader.read(record));
+    BOOST_CHECK(reader.error());
+}
+
+BOOST_AUTO_TEST_CASE(CorruptTraceTest)
+{
+    const unsigned char blob = (unsigned char)smpl::SearchTraceRecordType::Blob;
+    const unsigned char expansion = (unsigned char)smpl::SearchTraceRecordType::Expansion;
+
+    // an unrecognized record type
+    CheckCorruptTrace({ 0x7F });
+
+    // blob names and payloads longer than the rest of the trace, including
+    // lengths too large to allocate
+    CheckCorruptTrace({ blob, 0x10, 'a', 'b' });
+    CheckCorruptTrace({ blob, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F });
+    CheckCorruptTrace({ blob, 0x01, 'a', 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 });
+
+    // more successors than fit in the rest of the trace
+    CheckCorruptTrace({ expansion, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00 });
+    CheckCorruptTrace({ expansion, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F });
+}
+
+BOOST_AUTO_TEST_CASE(PropertiesRoundTripTest)
+{
+    std::map<std::string, std::string> props = {
+        { "frame_id", "odom combined" },
+        { "resolution", "0.02" },
+        { "empty", "" },
+    };
+
+    std::map<std::string, std::string> decoded;
+    BOOST_REQUIRE(smpl::DecodeTraceProperties(smpl::EncodeTraceProperties(props), decoded));
+    BOOST_CHECK(decoded == props);
+
+    BOOST_CHECK(!smpl::DecodeTraceProperties("no_value\n", decoded));
+}
+
+BOOST_AUTO_TEST_CASE(PlanningParamsRoundTripTest)
+{
+    smpl::PlanningParams params;
+    params.shortcut_path = true;
+    params.shortcut_type = smpl::ShortcutType::EUCLID_SPACE;
+    params.clearance_margin = 0.1;
+    params.trace_output_dir = "/tmp/traces";
+    params.addParam("epsilon", 100.0);
+    params.addParam("search_mode", true);
+    params.addParam("bfs_cost_per_cell", 100);
+    params.addParam("mprim_filename", std::string("/path with spaces/pr2.mprim"));
+    params.addParam("repair_time", 0.1);
+
+    smpl::PlanningParams replayed;
+    replayed.addParam("stale", 1);
+    replayed.trace_output_dir = "/tmp/replay";
+    BOOST_REQUIRE(replayed.deserialize(params.serialize()));
+
+    BOOST_CHECK(replayed.shortcut_path);
+    BOOST_CHECK(replayed.shortcut_type == smpl::ShortcutType::EUCLID_SPACE);
+    BOOST_CHECK_EQUAL(replayed.clearance_margin, 0.1);
+    BOOST_CHECK_EQUAL(replayed.cost_per_cell, params.cost_per_cell);
+
+    // logging fields are not part of the problem
+    BOOST_CHECK_EQUAL(replayed.trace_output_dir, "/tmp/replay");
+
+    double d;
+    bool b;
+    int i;
+    std::string s;
+    BOOST_CHECK(replayed.getParam("epsilon", d) && d == 100.0);
+    BOOST_CHECK(replayed.getParam("repair_time", d) && d == 0.1);
+    BOOST_CHECK(replayed.getParam("search_mode", b) && b);
+    BOOST_CHECK(replayed.getParam("bfs_cost_per_cell", i) && i == 100);
+    BOOST_CHECK(replayed.getParam("mprim_filename", s) && s == "/path with spaces/pr2.mprim");
+    BOOST_CHECK(!replayed.hasParam("stale"));
+
+    BOOST_CHECK(!replayed.deserialize("x epsilon 1\n"));
+}
@@ -0,0 +1,227 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#define BOOST_TEST_MODULE ShortcutTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// system includes
+#include <smpl/collision_checker.h>
+#include <smpl/post_processing.h>
+#include <smpl/robot_model.h>
+
+// A point that translates freely within the unit square
+class PointRobotModel : public smpl::RobotModel
+{
+public:
+
+    PointRobotModel() { setPlanningJoints({ "x", "y" }); }
+
+    double minPosLimit(int jidx) const override { return 0.0; }
+    double maxPosLimit(int jidx) const override { return 1.0; }
+    bool hasPosLimit(int jidx) const override { return true; }
+    bool isContinuous(int jidx) const override { return false; }
+    double velLimit(int jidx) const override { return 1.0; }
+    double accLimit(int jidx) const override { return 1.0; }
+
+    bool checkJointLimits(const smpl::RobotState& state, bool verbose = false) override
+    {
+        for (auto v : state) {
+            if (v < 0.0 || v > 1.0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto getExtension(size_t class_code) -> smpl::Extension* override
+    {
+        return NULL;
+    }
+};
+
+// Collision checking for a PointRobotModel against an axis-aligned box. Each
+// instance counts its checks, without synchronization, as a stateful checker
+// would, so instances must not be shared between threads.
+class BoxCollisionChecker : public smpl::CollisionChecker
+{
+public:
+
+    BoxCollisionChecker(double min_x, double min_y, double max_x, double max_y) :
+        m_min_x(min_x), m_min_y(min_y), m_max_x(max_x), m_max_y(max_y)
+    { }
+
+    int check_count = 0;
+
+    bool isStateValid(const smpl::RobotState& state, bool verbose = false) override
+    {
+        ++check_count;
+        return state[0] < m_min_x || state[0] > m_max_x ||
+                state[1] < m_min_y || state[1] > m_max_y;
+    }
+
+    bool isStateToStateValid(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        bool verbose = false) override
+    {
+        std::vector<smpl::RobotState> path;
+        return interpolatePath(start, finish, path) &&
+                std::all_of(path.begin(), path.end(),
+                        [&](const smpl::RobotState& s) { return isStateValid(s); });
+    }
+
+    bool interpolatePath(
+        const smpl::RobotState& start,
+        const smpl::RobotState& finish,
+        std::vector<smpl::RobotState>& path) override
+    {
+        const double step = 0.005;
+        const double len = std::hypot(finish[0] - start[0], finish[1] - start[1]);
+        const int count = std::max(1, (int)std::ceil(len / step));
+        path.clear();
+        for (int k = 0; k <= count; ++k) {
+            const double alpha = (double)k / (double)count;
+            path.push_back({
+                start[0] + alpha * (finish[0] - start[0]),
+                start[1] + alpha * (finish[1] - start[1]) });
+        }
+        return true;
+    }
+
+    auto getExtension(size_t class_code) -> smpl::Extension* override
+    {
+        if (class_code == smpl::GetClassCode<smpl::CollisionChecker>()) {
+            return this;
+        }
+        return NULL;
+    }
+
+private:
+
+    double m_min_x;
+    double m_min_y;
+    double m_max_x;
+    double m_max_y;
+};
+
+// the joint-space path cost minimized by shortcutting
+double PathCost(const std::vector<smpl::RobotState>& path)
+{
+    double cost = 0.0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        for (size_t j = 0; j < path[i].size(); ++j) {
+            cost += std::fabs(path[i][j] - path[i - 1][j]);
+        }
+    }
+    return cost;
+}
+
+// A densely sampled, wandering path from the lower left to the upper right
+// that detours around the box
+std::vector<smpl::RobotState> MakeDetourPath()
+{
+    std::vector<smpl::RobotState> path;
+    const int count = 60;
+    for (int k = 0; k <= count; ++k) {
+        const double alpha = (double)k / (double)count;
+        const double wiggle = 0.02 * std::sin(37.0 * alpha);
+        path.push_back({ 0.1 + 0.05 * alpha, 0.1 + 0.8 * alpha + wiggle });
+    }
+    for (int k = 1; k <= count; ++k) {
+        const double alpha = (double)k / (double)count;
+        const double wiggle = 0.02 * std::sin(23.0 * alpha);
+        path.push_back({ 0.15 + 0.75 * alpha, 0.9 + wiggle });
+    }
+    return path;
+}
+
+BOOST_AUTO_TEST_CASE(ParallelShortcutNoWorseThanSerialTest)
+{
+    PointRobotModel robot;
+
+    const int thread_count = 4;
+    std::vector<BoxCollisionChecker> checkers(
+            thread_count, BoxCollisionChecker(0.3, 0.3, 0.7, 0.7));
+    std::vector<smpl::CollisionChecker*> checker_ptrs;
+    for (auto& checker : checkers) {
+        checker_ptrs.push_back(&checker);
+    }
+
+    auto path = MakeDetourPath();
+    for (size_t i = 1; i < path.size(); ++i) {
+        BOOST_REQUIRE(checkers[0].isStateToStateValid(path[i - 1], path[i]));
+    }
+
+    std::vector<smpl::RobotState> serial_path;
+    smpl::ShortcutPath(
+            &robot, &checkers[0], path, serial_path,
+            smpl::ShortcutType::JOINT_SPACE);
+
+    std::vector<smpl::RobotState> parallel_path;
+    smpl::ParallelShortcutPath(&robot, checker_ptrs, path, parallel_path, 0.5);
+
+    BOOST_REQUIRE_GE(parallel_path.size(), 2);
+    BOOST_CHECK(parallel_path.front() == path.front());
+    BOOST_CHECK(parallel_path.back() == path.back());
+    for (size_t i = 1; i < parallel_path.size(); ++i) {
+        BOOST_CHECK(checkers[0].isStateToStateValid(
+                parallel_path[i - 1], parallel_path[i]));
+    }
+
+    const double serial_cost = PathCost(serial_path);
+    const double parallel_cost = PathCost(parallel_path);
+    BOOST_TEST_MESSAGE("cost " << PathCost(path) << " -> serial " << serial_cost << ", parallel " << parallel_cost);
+    BOOST_CHECK_LE(parallel_cost, serial_cost + 1e-9);
+    BOOST_CHECK_LT(parallel_cost, PathCost(path));
+
+    // every worker thread took part, each with its own checker
+    for (auto& checker : checkers) {
+        BOOST_CHECK_GT(checker.check_count, 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ParallelShortcutShortPathTest)
+{
+    PointRobotModel robot;
+    BoxCollisionChecker checker(0.3, 0.3, 0.7, 0.7);
+    std::vector<smpl::CollisionChecker*> checkers = { &checker };
+
+    std::vector<smpl::RobotState> path = { { 0.1, 0.1 }, { 0.1, 0.9 } };
+    std::vector<smpl::RobotState> shortcut_path;
+    smpl::ParallelShortcutPath(&robot, checkers, path, shortcut_path, 0.5);
+    BOOST_CHECK(shortcut_path == path);
+}
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+// standard includes
+#include <cmath>
+#include <vector>
+
+#define BOOST_TEST_MODULE TimeParameterizationTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// system includes
+#include <smpl/post_processing.h>
+#include <smpl/robot_model.h>
+
+// A point that translates within the unit cube, with unit velocity and
+// acceleration limits
+class PointRobotModel : public smpl::RobotModel
+{
+public:
+
+    PointRobotModel() { setPlanningJoints({ "x", "y", "z" }); }
+
+    double minPosLimit(int jidx) const override { return 0.0; }
+    double maxPosLimit(int jidx) const override { return 1.0; }
+    bool hasPosLimit(int jidx) const override { return true; }
+    bool isContinuous(int jidx) const override { return false; }
+    double velLimit(int jidx) const override { return 1.0; }
+    double accLimit(int jidx) const override { return 1.0; }
+
+    bool checkJointLimits(const smpl::RobotState& state, bool verbose = false) override
+    {
+        return true;
+    }
+
+    auto getExtension(size_t class_code) -> smpl::Extension* override
+    {
+        return NULL;
+    }
+};
+
+// A rest-to-rest move of length l along one joint takes 2 * sqrt(l / acc) if
+// it never reaches the velocity limit, and l / vel + vel / acc otherwise
+static
+double MinMoveTime(double l)
+{
+    return l <= 1.0 ? 2.0 * std::sqrt(l) : l + 1.0;
+}
+
+BOOST_AUTO_TEST_CASE(ShortMoveTest)
+{
+    PointRobotModel robot;
+
+    // moves that span a single step of the parameterization grid
+    for (auto l : { 1.0e-3, 0.01, 0.04 }) {
+        std::vector<smpl::RobotState> path = {
+            { 0.5, 0.5, 0.5 },
+            { 0.5 + l, 0.5, 0.5 },
+        };
+        std::vector<double> times;
+        BOOST_REQUIRE(smpl::ComputeTimeOptimalParameterization(&robot, path, times, 1.0));
+        BOOST_REQUIRE_EQUAL(times.size(), path.size());
+        BOOST_CHECK_EQUAL(times[0], 0.0);
+        BOOST_CHECK_CLOSE(times[1], MinMoveTime(l), 1.0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(LongMoveTest)
+{
+    PointRobotModel robot;
+
+    // reaches the velocity limit halfway along the move
+    std::vector<smpl::RobotState> path = {
+        { 0.0, 0.5, 0.5 },
+        { 0.25, 0.5, 0.5 },
+        { 1.0, 0.5, 0.5 },
+    };
+    std::vector<double> times;
+    BOOST_REQUIRE(smpl::ComputeTimeOptimalParameterization(&robot, path, times, 1.0));
+    BOOST_CHECK_EQUAL(times[0], 0.0);
+    BOOST_CHECK_GT(times[1], 0.0);
+    BOOST_CHECK_LT(times[1], times[2]);
+    BOOST_CHECK_CLOSE(times[2], MinMoveTime(1.0), 5.0);
+}
+
+BOOST_AUTO_TEST_CASE(DuplicateWaypointsTest)
+{
+    PointRobotModel robot;
+
+    std::vector<smpl::RobotState> path = {
+        { 0.5, 0.5, 0.5 },
+        { 0.5, 0.5, 0.5 },
+        { 0.52, 0.5, 0.5 },
+        { 0.52, 0.5, 0.5 },
+    };
+    std::vector<double> times;
+    BOOST_REQUIRE(smpl::ComputeTimeOptimalParameterization(&robot, path, times, 1.0));
+    BOOST_CHECK_EQUAL(times[0], 0.0);
+    BOOST_CHECK_EQUAL(times[1], 0.0);
+    BOOST_CHECK_CLOSE(times[2], MinMoveTime(0.02), 1.0);
+    BOOST_CHECK_EQUAL(times[3], times[2]);
+
+    // a path that never moves takes no time
+    path.resize(2);
+    BOOST_REQUIRE(smpl::ComputeTimeOptimalParameterization(&robot, path, times, 1.0));
+    BOOST_CHECK_EQUAL(times[1], 0.0);
+}
@@ -0,0 +1,275 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2017, Andrew Dornbush
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     1. Redistributions of source code must retain the above copyright notice
+//        this list of conditions and the following disclaimer.
+//     2. Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//     3. Neither the name of the copyright holder nor the names of its
+//        contributors may be used to endorse or promote products derived from
+//        this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+/// \author Andrew Dornbush
+
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE VPTreeTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// system includes
+#include <smpl/vp_tree/vp_tree.h>
+
+using Point = std::vector<double>;
+
+struct EuclideanDistance
+{
+    double operator()(const Point& a, const Point& b) const
+    {
+        auto sum = 0.0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            auto d = a[i] - b[i];
+            sum += d * d;
+        }
+        return std::sqrt(sum);
+    }
+};
+
+using PointTree = smpl::VPTree<Point, EuclideanDistance>;
+
+static
+auto RandomPoint(std::default_random_engine& rng, int dim) -> Point
+{
+    std::uniform_real_distribution<double> dist(-3.0, 3.0);
+    Point p(dim);
+    for (auto& x : p) {
+        x = dist(rng);
+    }
+    return p;
+}
+
+static
+auto RandomPoints(std::default_random_engine& rng, int count, int dim)
+    -> std::vector<Point>
+{
+    std::vector<Point> points;
+    for (int i = 0; i < count; ++i) {
+        points.push_back(RandomPoint(rng, dim));
+    }
+    return points;
+}
+
+static
+void CheckRadiusSearch(
+    const PointTree& tree,
+    const std::vector<Point>& points,
+    const Point& q,
+    double radius)
+{
+    std::vector<int> found;
+    tree.radiusSearch(q, radius, [&](int i, double d)
+    {
+        BOOST_CHECK_CLOSE(d, EuclideanDistance()(q, points[i]), 1.0e-9);
+        found.push_back(i);
+    });
+    std::sort(found.begin(), found.end());
+
+    std::vector<int> expected;
+    for (int i = 0; i < (int)points.size(); ++i) {
+        if (EuclideanDistance()(q, points[i]) <= radius) {
+            expected.push_back(i);
+        }
+    }
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+            found.begin(), found.end(), expected.begin(), expected.end());
+}
+
+// Check that a bounded search finds the minimum of offset(i) + slope * d(q, i)
+// over all items, along with the item that attains it.
+static
+void CheckBoundedSearch(
+    const PointTree& tree,
+    const std::vector<Point>& points,
+    const Point& q,
+    double slope)
+{
+    auto expected = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < (int)points.size(); ++i) {
+        auto cost = tree.offset(i) + slope * EuclideanDistance()(q, points[i]);
+        expected = std::min(expected, cost);
+    }
+
+    auto best = std::numeric_limits<double>::infinity();
+    auto best_item = -1;
+    auto bound = tree.boundedSearch(
+            q, slope, std::numeric_limits<double>::infinity(),
+            [&](int i, double d)
+            {
+                auto cost = tree.offset(i) + slope * d;
+                if (cost < best) {
+                    best = cost;
+                    best_item = i;
+                }
+                return best;
+            });
+
+    BOOST_CHECK_CLOSE(best, expected, 1.0e-9);
+    BOOST_CHECK_EQUAL(bound, best);
+    BOOST_REQUIRE(best_item != -1);
+    BOOST_CHECK_CLOSE(
+            tree.offset(best_item) + slope * EuclideanDistance()(q, points[best_item]),
+            expected,
+            1.0e-9);
+}
+
+BOOST_AUTO_TEST_CASE(EmptyTreeTest)
+{
+    PointTree tree;
+    std::vector<Point> points;
+    tree.build(points.begin(), points.end());
+    BOOST_CHECK(tree.empty());
+
+    auto visits = 0;
+    tree.radiusSearch(Point(3, 0.0), 1.0, [&](int, double) { ++visits; });
+    auto bound = tree.boundedSearch(Point(3, 0.0), 1.0, 5.0,
+            [&](int, double) { ++visits; return 0.0; });
+    BOOST_CHECK_EQUAL(visits, 0);
+    BOOST_CHECK_EQUAL(bound, 5.0);
+}
+
+BOOST_AUTO_TEST_CASE(RadiusSearchTest)
+{
+    std::default_random_engine rng(1);
+    auto points = RandomPoints(rng, 2000, 7);
+
+    PointTree tree;
+    tree.build(points.begin(), points.end());
+    BOOST_REQUIRE_EQUAL(tree.size(), points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        BOOST_REQUIRE(tree.item(i) == points[i]);
+    }
+
+    for (auto radius : { 0.0, 1.0, 2.5, 6.0, 100.0 }) {
+        for (int t = 0; t < 20; ++t) {
+            CheckRadiusSearch(tree, points, RandomPoint(rng, 7), radius);
+            // queries at the items themselves
+            CheckRadiusSearch(tree, points, points[t], radius);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(DuplicateItemsTest)
+{
+    // many items at the same distance from every vantage item
+    std::default_random_engine rng(2);
+    auto distinct = RandomPoints(rng, 5, 3);
+    std::vector<Point> points;
+    for (int i = 0; i < 200; ++i) {
+        points.push_back(distinct[i % distinct.size()]);
+    }
+
+    PointTree tree;
+    tree.build(points.begin(), points.end());
+
+    std::vector<double> offsets(points.size());
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        offsets[i] = (double)((i * 7) % 13);
+    }
+    tree.setOffsets(offsets);
+
+    for (int t = 0; t < 20; ++t) {
+        auto q = RandomPoint(rng, 3);
+        CheckRadiusSearch(tree, points, q, 2.0);
+        CheckRadiusSearch(tree, points, distinct[t % distinct.size()], 0.0);
+        CheckBoundedSearch(tree, points, q, 4.0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BoundedSearchTest)
+{
+    std::default_random_engine rng(3);
+    auto points = RandomPoints(rng, 2000, 7);
+
+    PointTree tree;
+    tree.build(points.begin(), points.end());
+
+    // without offsets, a bounded search is a nearest neighbor search
+    for (int t = 0; t < 20; ++t) {
+        CheckBoundedSearch(tree, points, RandomPoint(rng, 7), 1.0);
+    }
+
+    std::uniform_real_distribution<double> offset_dist(0.0, 1000.0);
+    std::vector<double> offsets(points.size());
+    for (auto& offset : offsets) {
+        offset = offset_dist(rng);
+    }
+    tree.setOffsets(offsets);
+
+    for (auto slope : { 0.0, 1.0, 50.0, 500.0 }) {
+        for (int t = 0; t < 20; ++t) {
+            CheckBoundedSearch(tree, points, RandomPoint(rng, 7), slope);
+        }
+    }
+
+    // a bound below the minimum cost prunes every item
+    auto q = RandomPoint(rng, 7);
+    auto visits = 0;
+    auto bound = tree.boundedSearch(q, 1.0, -1.0,
+            [&](int, double) { ++visits; return -1.0; });
+    BOOST_CHECK_EQUAL(visits, 0);
+    BOOST_CHECK_EQUAL(bound, -1.0);
+}
+
+BOOST_AUTO_TEST_CASE(SetOffsetTest)
+{
+    std::default_random_engine rng(4);
+    auto points = RandomPoints(rng, 1000, 4);
+
+    PointTree tree;
+    tree.build(points.begin(), points.end());
+
+    std::uniform_real_distribution<double> offset_dist(0.0, 100.0);
+    std::vector<double> offsets(points.size());
+    for (auto& offset : offsets) {
+        offset = offset_dist(rng);
+    }
+    tree.setOffsets(offsets);
+
+    // raise and lower single offsets, including that of the minimum item
+    std::uniform_int_distribution<int> item_dist(0, (int)points.size() - 1);
+    for (int t = 0; t < 50; ++t) {
+        auto i = item_dist(rng);
+        if (t % 2 == 0) {
+            i = (int)(std::min_element(offsets.begin(), offsets.end()) - offsets.begin());
+        }
+        offsets[i] = offset_dist(rng) * (t % 3 == 0 ? 0.01 : 2.0);
+        tree.setOffset(i, offsets[i]);
+        BOOST_REQUIRE_EQUAL(tree.offset(i), offsets[i]);
+
+        CheckBoundedSearch(tree, points, RandomPoint(rng, 4), 1.0);
+    }
+}
@@ -18,6 +18,7 @@ namespace smpl {
 namespace urdf {
 
 enum struct JointType;
+enum struct JointKernel;
 struct RobotModel;
 struct JointSpec;
 struct Link;
@@ -97,6 +98,7 @@ auto CollisionBodies(const Link* link) -> range<const LinkCollision*>;
 //////////////////////
 
 auto GetJointType(const Joint* joint) -> JointType;
+auto GetJointKernel(const Joint* joint) -> JointKernel;
 auto GetJointOrigin(const Joint* joint) -> const Affine3*;
 auto GetJointAxis(const Joint* joint) -> const Vector3*;
 auto GetVariableCount(const Joint* joint) -> size_t;
@@ -201,6 +203,21 @@ enum struct JointType
     Floating,   // 6 DOF rigid body motion
 };
 
+// Specialized form of a joint's transform, selected when the model is loaded,
+// so that transform updates only require the sine and cosine of the joint
+// position rather than a general rotation about the joint axis.
+enum struct JointKernel
+{
+    Identity,   // fixed joint
+    RotateX,    // revolute about the x axis
+    RotateY,    // revolute about the y axis
+    RotateZ,    // revolute about the z axis
+    Rotate,     // revolute about an arbitrary axis
+    Translate,  // prismatic along an arbitrary axis
+    Planar,
+    Floating,
+};
+
 struct Joint
 {
     std::string name;
@@ -209,6 +226,9 @@ struct Joint
     Affine3 origin;
     Vector3 axis;   // the axis for revolute and prismatic joints
 
+    JointKernel kernel = JointKernel::Identity;
+    double axis_sign = 1.0; // sign of the axis for RotateX/Y/Z kernels
+
     JointVariable* vfirst = NULL;
     JointVariable* vlast = NULL;
 
@@ -123,6 +123,24 @@ void UpdateVisualBodyTransforms(RobotState* state);
 void UpdateVisualBodyTransform(RobotState* state, const LinkVisual* visual);
 void UpdateVisualBodyTransform(RobotState* state, int index);
 
+// Number of configurations evaluated together by ComputeLinkTransforms.
+constexpr int FK_BATCH_WIDTH = 4;
+
+// Compute the transform of a link for each of a batch of configurations. Each
+// configuration, positions[i], holds values for the variables whose indices
+// are listed in \p variables; all other variables take their positions from
+// \p state. Configurations are evaluated FK_BATCH_WIDTH at a time, one per
+// lane, using the joint kernels selected when the model was loaded. The
+// transforms in \p state are only updated above the first joint that varies.
+void ComputeLinkTransforms(
+    RobotState* state,
+    const Link* link,
+    const int* variables,
+    int variable_count,
+    const double* const* positions,
+    int count,
+    Affine3* transforms);
+
 // Retrieve transforms.
 auto GetLinkTransform(const RobotState* state, const Link* link) -> const Affine3*;
 auto GetLinkTransform(const RobotState* state, int index) -> const Affine3*;
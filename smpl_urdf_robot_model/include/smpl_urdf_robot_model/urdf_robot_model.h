@@ -38,6 +38,11 @@ struct URDFRobotModel :
     auto computeFK(const smpl::RobotState& state)
         -> Eigen::Affine3d override;
 
+    void computeFKBatch(
+        const smpl::RobotState* states,
+        int count,
+        Eigen::Affine3d* poses) override;
+
     double minPosLimit(int jidx) const override;
     double maxPosLimit(int jidx) const override;
     bool hasPosLimit(int jidx) const override;
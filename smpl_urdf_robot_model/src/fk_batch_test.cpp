@@ -0,0 +1,272 @@
+#define BOOST_TEST_MODULE FKBatchTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// standard includes
+#include <random>
+#include <string>
+#include <vector>
+
+// system includes
+#include <urdf_parser/urdf_parser.h>
+
+// project includes
+#include <smpl_urdf_robot_model/smpl_urdf_robot_model.h>
+
+using namespace smpl::urdf;
+
+// An arm on a planar base, with revolute joints about positive, negative, and
+// arbitrary axes, a prismatic joint along an arbitrary axis, fixed joints
+// within the chain, and a branch off of the chain.
+static const char* TEST_URDF = R"(
+<robot name="fk_batch_test_robot">
+  <link name="base_link"/>
+  <link name="shoulder_link"/>
+  <link name="upper_arm_link"/>
+  <link name="slide_link"/>
+  <link name="forearm_link"/>
+  <link name="mount_link"/>
+  <link name="wrist_link"/>
+  <link name="tool_link"/>
+  <link name="side_link"/>
+  <joint name="shoulder_pan_joint" type="revolute">
+    <parent link="base_link"/>
+    <child link="shoulder_link"/>
+    <origin xyz="0.1 0.0 0.3" rpy="0.0 0.0 0.0"/>
+    <axis xyz="0 0 1"/>
+    <limit lower="-2.0" upper="2.0" effort="10.0" velocity="1.0"/>
+  </joint>
+  <joint name="shoulder_lift_joint" type="revolute">
+    <parent link="shoulder_link"/>
+    <child link="upper_arm_link"/>
+    <origin xyz="0.05 0.02 0.1" rpy="0.1 0.2 0.3"/>
+    <axis xyz="0 -1 0"/>
+    <limit lower="-2.0" upper="2.0" effort="10.0" velocity="1.0"/>
+  </joint>
+  <joint name="extend_joint" type="prismatic">
+    <parent link="upper_arm_link"/>
+    <child link="slide_link"/>
+    <origin xyz="0.4 0.0 0.0" rpy="0.0 0.5 0.0"/>
+    <axis xyz="0.6 0.0 0.8"/>
+    <limit lower="0.0" upper="0.3" effort="10.0" velocity="1.0"/>
+  </joint>
+  <joint name="elbow_joint" type="continuous">
+    <parent link="slide_link"/>
+    <child link="forearm_link"/>
+    <origin xyz="0.0 0.1 0.05" rpy="-0.4 0.0 0.2"/>
+    <axis xyz="0.6 0.8 0.0"/>
+  </joint>
+  <joint name="mount_joint" type="fixed">
+    <parent link="forearm_link"/>
+    <child link="mount_link"/>
+    <origin xyz="0.3 0.0 0.0" rpy="0.0 0.0 1.0"/>
+  </joint>
+  <joint name="wrist_roll_joint" type="revolute">
+    <parent link="mount_link"/>
+    <child link="wrist_link"/>
+    <origin xyz="0.0 0.0 0.05" rpy="0.3 -0.2 0.1"/>
+    <axis xyz="-1 0 0"/>
+    <limit lower="-3.0" upper="3.0" effort="10.0" velocity="1.0"/>
+  </joint>
+  <joint name="tool_joint" type="fixed">
+    <parent link="wrist_link"/>
+    <child link="tool_link"/>
+    <origin xyz="0.1 0.02 -0.03" rpy="0.0 0.7 0.0"/>
+  </joint>
+  <joint name="side_joint" type="prismatic">
+    <parent link="shoulder_link"/>
+    <child link="side_link"/>
+    <origin xyz="0.0 0.2 0.0" rpy="0.0 0.0 0.0"/>
+    <axis xyz="0 1 0"/>
+    <limit lower="0.0" upper="0.2" effort="10.0" velocity="1.0"/>
+  </joint>
+</robot>
+)";
+
+struct TestRobot
+{
+    RobotModel robot_model;
+    URDFRobotModel urdf_model;
+};
+
+static
+bool InitTestRobot(
+    TestRobot* robot,
+    const std::vector<std::string>& planning_joints,
+    const char* planning_link)
+{
+    auto urdf = ::urdf::parseURDF(TEST_URDF);
+    if (!urdf) {
+        return false;
+    }
+
+    JointSpec world_joint;
+    world_joint.name = "base_joint";
+    world_joint.origin = smpl::Affine3::Identity();
+    world_joint.axis = smpl::Vector3::UnitZ();
+    world_joint.type = JointType::Planar;
+    if (!InitRobotModel(&robot->robot_model, urdf.get(), &world_joint)) {
+        return false;
+    }
+
+    if (!Init(&robot->urdf_model, &robot->robot_model, &planning_joints)) {
+        return false;
+    }
+
+    return SetPlanningLink(&robot->urdf_model, planning_link);
+}
+
+// The transform of a joint, evaluated directly from its definition, without
+// the specialized joint kernels.
+static
+auto NaiveJointTransform(const Joint* joint, const double* q) -> smpl::Affine3
+{
+    switch (GetJointType(joint)) {
+    case JointType::Fixed:
+        return smpl::Affine3::Identity();
+    case JointType::Revolute:
+        return smpl::Affine3(smpl::AngleAxis(q[0], *GetJointAxis(joint)));
+    case JointType::Prismatic:
+        return smpl::Affine3(smpl::Translation3(q[0] * *GetJointAxis(joint)));
+    case JointType::Planar:
+        return smpl::Translation3(q[0], q[1], 0.0) *
+                smpl::AngleAxis(q[2], smpl::Vector3::UnitZ());
+    case JointType::Floating:
+        return smpl::Translation3(q[0], q[1], q[2]) *
+                smpl::Quaternion(q[6], q[3], q[4], q[5]);
+    default:
+        return smpl::Affine3::Identity();
+    }
+}
+
+// The transform of a link, given the positions of all variables in the model,
+// by multiplying out the chain of joints from the root.
+static
+auto NaiveLinkTransform(
+    const RobotModel* model,
+    const Link* link,
+    const std::vector<double>& positions)
+    -> smpl::Affine3
+{
+    smpl::Affine3 T(smpl::Affine3::Identity());
+    for (auto* joint = link->parent; joint != NULL;
+        joint = GetParentLink(joint) != NULL ? GetParentLink(joint)->parent : NULL)
+    {
+        auto* q = positions.data();
+        if (GetVariableCount(joint) != 0) {
+            q += GetVariableIndex(model, GetFirstVariable(joint));
+        }
+        T = *GetJointOrigin(joint) * NaiveJointTransform(joint, q) * T;
+    }
+    return T;
+}
+
+static
+auto RandomPositions(const RobotModel* model, std::default_random_engine& rng)
+    -> std::vector<double>
+{
+    std::uniform_real_distribution<double> dist(-3.0, 3.0);
+    std::vector<double> positions;
+    for (auto& variable : Variables(model)) {
+        auto* limits = GetVariableLimits(&variable);
+        if (limits->has_position_limits) {
+            positions.push_back(std::uniform_real_distribution<double>(
+                    limits->min_position, limits->max_position)(rng));
+        } else {
+            positions.push_back(dist(rng));
+        }
+    }
+    return positions;
+}
+
+// Check that batch FK agrees with scalar FK and with naive FK for a batch of
+// random configurations, with the remaining variables held at a random
+// reference state. The batch size is not a multiple of FK_BATCH_WIDTH so that
+// partial batches are covered.
+static
+void CheckBatchFK(
+    const std::vector<std::string>& planning_joints,
+    const char* planning_link)
+{
+    TestRobot robot;
+    BOOST_REQUIRE(InitTestRobot(&robot, planning_joints, planning_link));
+
+    auto* model = &robot.robot_model;
+    auto* urdf_model = &robot.urdf_model;
+    auto* link = GetLink(model, planning_link);
+    BOOST_REQUIRE(link != NULL);
+
+    std::default_random_engine rng(planning_joints.size());
+
+    auto reference = RandomPositions(model, rng);
+    SetReferenceState(urdf_model, reference.data());
+
+    const int count = 4 * FK_BATCH_WIDTH + 3;
+
+    std::vector<smpl::RobotState> states(count);
+    std::vector<std::vector<double>> full_states(count);
+    for (int i = 0; i < count; ++i) {
+        auto positions = RandomPositions(model, rng);
+        full_states[i] = reference;
+        for (size_t v = 0; v < urdf_model->planning_to_state_variable.size(); ++v) {
+            auto sidx = urdf_model->planning_to_state_variable[v];
+            states[i].push_back(positions[sidx]);
+            full_states[i][sidx] = positions[sidx];
+        }
+    }
+
+    std::vector<smpl::Affine3, Eigen::aligned_allocator<smpl::Affine3>> poses(count);
+    urdf_model->computeFKBatch(states.data(), count, poses.data());
+
+    const double tol = 1.0e-9;
+    for (int i = 0; i < count; ++i) {
+        auto expected = NaiveLinkTransform(model, link, full_states[i]);
+        auto scalar = urdf_model->computeFK(states[i]);
+        BOOST_CHECK_MESSAGE(
+                poses[i].isApprox(expected, tol),
+                "batch FK differs from naive FK for state " << i);
+        BOOST_CHECK_MESSAGE(
+                scalar.isApprox(expected, tol),
+                "scalar FK differs from naive FK for state " << i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(FullChainTest)
+{
+    CheckBatchFK(
+            {
+                "base_joint",
+                "shoulder_pan_joint",
+                "shoulder_lift_joint",
+                "extend_joint",
+                "elbow_joint",
+                "wrist_roll_joint",
+            },
+            "tool_link");
+}
+
+BOOST_AUTO_TEST_CASE(PartialChainTest)
+{
+    // the base and the shoulder pan joint are taken from the reference state,
+    // and the planning joints are listed out of chain order
+    CheckBatchFK(
+            {
+                "wrist_roll_joint",
+                "shoulder_lift_joint",
+                "elbow_joint",
+                "extend_joint",
+            },
+            "tool_link");
+}
+
+BOOST_AUTO_TEST_CASE(BranchTest)
+{
+    // only the planar base and a joint off of the planning link's chain vary
+    CheckBatchFK({ "side_joint", "base_joint" }, "mount_link");
+}
+
+BOOST_AUTO_TEST_CASE(NoVaryingJointsTest)
+{
+    // the planning link is above every planning joint
+    CheckBatchFK({ "elbow_joint", "wrist_roll_joint" }, "upper_arm_link");
+}
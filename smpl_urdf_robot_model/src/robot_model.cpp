@@ -1,5 +1,9 @@
 #include <smpl_urdf_robot_model/robot_model.h>
 
+// standard includes
+#include <cmath>
+
+// system includes
 #include <urdf_model/model.h>
 
 namespace smpl {
@@ -18,6 +22,47 @@ auto VectorURDFToEigen(const ::urdf::Vector3& v) -> Vector3
     return Vector3(v.x, v.y, v.z);
 }
 
+// Select the specialized transform for a joint. Revolute joints about a
+// (positive or negative) coordinate axis only need to mix two columns of the
+// parent rotation.
+static
+void SelectJointKernel(Joint* joint)
+{
+    joint->axis_sign = 1.0;
+    switch (joint->type) {
+    case JointType::Fixed:
+        joint->kernel = JointKernel::Identity;
+        break;
+    case JointType::Revolute:
+    {
+        joint->kernel = JointKernel::Rotate;
+        auto eps = 1e-12;
+        for (int i = 0; i < 3; ++i) {
+            auto j = (i + 1) % 3;
+            auto k = (i + 2) % 3;
+            if (std::fabs(std::fabs(joint->axis[i]) - 1.0) < eps &&
+                std::fabs(joint->axis[j]) < eps &&
+                std::fabs(joint->axis[k]) < eps)
+            {
+                joint->kernel = (JointKernel)((int)JointKernel::RotateX + i);
+                joint->axis_sign = joint->axis[i] < 0.0 ? -1.0 : 1.0;
+                break;
+            }
+        }
+        break;
+    }
+    case JointType::Prismatic:
+        joint->kernel = JointKernel::Translate;
+        break;
+    case JointType::Planar:
+        joint->kernel = JointKernel::Planar;
+        break;
+    case JointType::Floating:
+        joint->kernel = JointKernel::Floating;
+        break;
+    }
+}
+
 static
 void AddPlanarJointVariables(
     const std::string* name,
@@ -304,6 +349,11 @@ bool InitRobotModel(
         robot_model.joints.push_back(std::move(joint));
     }
 
+    // ...select specialized transform kernels
+    for (auto& joint : robot_model.joints) {
+        SelectJointKernel(&joint);
+    }
+
     ////////////////////////////////////
     // Initialize variable properties //
     ////////////////////////////////////
@@ -557,6 +607,11 @@ auto GetJointType(const Joint* joint) -> JointType
     return joint->type;
 }
 
+auto GetJointKernel(const Joint* joint) -> JointKernel
+{
+    return joint->kernel;
+}
+
 auto GetJointOrigin(const Joint* joint) -> const Affine3*
 {
     return &joint->origin;
@@ -13,20 +13,46 @@
 namespace smpl {
 namespace urdf {
 
+// Return the indices of the columns of a rotation mixed by a revolute joint
+// about a coordinate axis, such that R * Rj = R with columns a and b replaced by
+// (c * a + s * b) and (c * b - s * a).
+static
+void GetRotationPlane(JointKernel kernel, int* a, int* b)
+{
+    auto i = (int)kernel - (int)JointKernel::RotateX;
+    *a = (i + 1) % 3;
+    *b = (i + 2) % 3;
+}
+
 static
 Affine3 ComputeJointTransform(const Joint* joint, const double* variables)
 {
-    switch (joint->type) {
-    case JointType::Fixed:
+    switch (joint->kernel) {
+    case JointKernel::Identity:
         return Affine3::Identity();
-    case JointType::Revolute:
+    case JointKernel::RotateX:
+    case JointKernel::RotateY:
+    case JointKernel::RotateZ:
+    {
+        int a, b;
+        GetRotationPlane(joint->kernel, &a, &b);
+        auto c = cos(variables[0]);
+        auto s = joint->axis_sign * sin(variables[0]);
+        Affine3 transform(Affine3::Identity());
+        transform(a, a) = c;
+        transform(b, b) = c;
+        transform(b, a) = s;
+        transform(a, b) = -s;
+        return transform;
+    }
+    case JointKernel::Rotate:
         return Affine3(AngleAxis(variables[0], joint->axis));
-    case JointType::Prismatic:
+    case JointKernel::Translate:
         return Affine3(Translation3(variables[0] * joint->axis));
-    case JointType::Planar:
+    case JointKernel::Planar:
         return Translation3(variables[0], variables[1], 0.0) *
                 AngleAxis(variables[2], Vector3::UnitZ());
-    case JointType::Floating:
+    case JointKernel::Floating:
         return Translation3(variables[0], variables[1], variables[2]) *
                 Quaternion(variables[6], variables[3], variables[4], variables[5]);
     default:
@@ -34,6 +60,46 @@ Affine3 ComputeJointTransform(const Joint* joint, const double* variables)
     }
 }
 
+// Compute parent * origin * joint_transform, exploiting the structure of the
+// joint transform to avoid a general matrix product where possible.
+static
+void ComposeLinkTransform(
+    const Affine3& parent,
+    const Joint* joint,
+    const Affine3& joint_transform,
+    Affine3* link_transform)
+{
+    *link_transform = parent * joint->origin;
+    switch (joint->kernel) {
+    case JointKernel::Identity:
+        return;
+    case JointKernel::RotateX:
+    case JointKernel::RotateY:
+    case JointKernel::RotateZ:
+    {
+        int a, b;
+        GetRotationPlane(joint->kernel, &a, &b);
+        auto c = joint_transform(a, a);
+        auto s = joint_transform(b, a);
+        auto& R = link_transform->matrix();
+        for (int i = 0; i < 3; ++i) {
+            auto ra = R(i, a);
+            auto rb = R(i, b);
+            R(i, a) = c * ra + s * rb;
+            R(i, b) = c * rb - s * ra;
+        }
+        return;
+    }
+    case JointKernel::Translate:
+        link_transform->translation() +=
+                link_transform->linear() * joint_transform.translation();
+        return;
+    default:
+        *link_transform = *link_transform * joint_transform;
+        return;
+    }
+}
+
 static
 void GetTransformVariables(
     const Joint* joint,
@@ -441,9 +507,11 @@ void UpdateLinkTransforms(RobotState* state, std::vector<const Joint*>* q)
             auto& parent_transform =
                     state->link_transforms[
                             GetLinkIndex(state->model, joint->parent)];
-            link_transform = parent_transform * joint->origin * joint_transform;
+            ComposeLinkTransform(
+                    parent_transform, joint, joint_transform, &link_transform);
         } else {
-            link_transform = joint->origin * joint_transform;
+            ComposeLinkTransform(
+                    Affine3::Identity(), joint, joint_transform, &link_transform);
         }
 
         // recurse on children
@@ -614,6 +682,269 @@ void UpdateVisualBodyTransform(RobotState* state, int index)
     return UpdateVisualBodyTransform(state, GetVisualBody(state->model, index));
 }
 
+// Rigid transforms for FK_BATCH_WIDTH configurations, stored with one lane per
+// configuration so that updates are applied to all lanes in lockstep.
+struct TransformLanes
+{
+    double r[3][3][FK_BATCH_WIDTH];
+    double t[3][FK_BATCH_WIDTH];
+};
+
+static
+void SetLanes(TransformLanes* x, const Affine3& T)
+{
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            for (int l = 0; l < FK_BATCH_WIDTH; ++l) {
+                x->r[i][j][l] = T(i, j);
+            }
+        }
+        for (int l = 0; l < FK_BATCH_WIDTH; ++l) {
+            x->t[i][l] = T(i, 3);
+        }
+    }
+}
+
+// x = x * T, for a transform T shared by all lanes
+static
+void ApplyTransform(TransformLanes* x, const Affine3& T)
+{
+    TransformLanes y;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            for (int l = 0; l < FK_BATCH_WIDTH; ++l) {
+                y.r[i][j][l] =
+                        x->r[i][0][l] * T(0, j) +
+                        x->r[i][1][l] * T(1, j) +
+                        x->r[i][2][l] * T(2, j);
+            }
+        }
+        for (int l = 0; l < FK_BATCH_WIDTH; ++l) {
+            y.t[i][l] =
+                    x->r[i][0][l] * T(0, 3) +
+                    x->r[i][1][l] * T(1, 3) +
+                    x->r[i][2][l] * T(2, 3) +
+                    x->t[i][l];
+        }
+    }
+    *x = y;
+}
+
+// x[l] = x[l] * T, for a single lane
+static
+void ApplyLaneTransform(TransformLanes* x, int l, const Affine3& T)
+{
+    for (int i = 0; i < 3; ++i) {
+        double r[3];
+        for (int j = 0; j < 3; ++j) {
+            r[j] =
+                    x->r[i][0][l] * T(0, j) +
+                    x->r[i][1][l] * T(1, j) +
+                    x->r[i][2][l] * T(2, j);
+        }
+        x->t[i][l] +=
+                x->r[i][0][l] * T(0, 3) +
+                x->r[i][1][l] * T(1, 3) +
+                x->r[i][2][l] * T(2, 3);
+        for (int j = 0; j < 3; ++j) {
+            x->r[i][j][l] = r[j];
+        }
+    }
+}
+
+// x = x * Rj, for revolute joints about a coordinate axis
+static
+void ApplyPlaneRotation(
+    TransformLanes* x,
+    int a,
+    int b,
+    const double* c,
+    const double* s)
+{
+    for (int i = 0; i < 3; ++i) {
+        for (int l = 0; l < FK_BATCH_WIDTH; ++l) {
+            auto ra = x->r[i][a][l];
+            auto rb = x->r[i][b][l];
+            x->r[i][a][l] = c[l] * ra + s[l] * rb;
+            x->r[i][b][l] = c[l] * rb - s[l] * ra;
+        }
+    }
+}
+
+// x = x * Tj, for prismatic joints
+static
+void ApplyAxisTranslation(TransformLanes* x, const Vector3& axis, const double* q)
+{
+    for (int i = 0; i < 3; ++i) {
+        for (int l = 0; l < FK_BATCH_WIDTH; ++l) {
+            x->t[i][l] += q[l] * (
+                    x->r[i][0][l] * axis[0] +
+                    x->r[i][1][l] * axis[1] +
+                    x->r[i][2][l] * axis[2]);
+        }
+    }
+}
+
+// A joint whose position varies across the batch, preceded by the constant
+// transform accumulated since the previous varying joint.
+struct BatchJoint
+{
+    Affine3 pre;
+    const Joint* joint;
+    int variable_count;
+    int state_index[7]; // index of each joint variable in the robot state
+    int batch_index[7]; // index into each batch configuration, or -1
+};
+
+void ComputeLinkTransforms(
+    RobotState* state,
+    const Link* link,
+    const int* variables,
+    int variable_count,
+    const double* const* positions,
+    int count,
+    Affine3* transforms)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    auto* model = state->model;
+
+    // gather the chain of joints from the root to the link
+    std::vector<const Joint*> chain;
+    for (auto* joint = link->parent; joint != NULL;
+        joint = joint->parent != NULL ? joint->parent->parent : NULL)
+    {
+        chain.push_back(joint);
+    }
+    std::reverse(begin(chain), end(chain));
+
+    // compile the chain into varying joints separated by constant transforms
+    std::vector<BatchJoint, Eigen::aligned_allocator<BatchJoint>> program;
+    Affine3 acc(Affine3::Identity());
+    for (auto* joint : chain) {
+        BatchJoint bj;
+        bj.joint = joint;
+        bj.variable_count = 0;
+        auto varying = false;
+        for (auto& variable : Variables(joint)) {
+            auto vidx = (int)GetVariableIndex(model, &variable);
+            auto bidx = (int)(std::find(variables, variables + variable_count, vidx) - variables);
+            bj.state_index[bj.variable_count] = vidx;
+            bj.batch_index[bj.variable_count] = bidx < variable_count ? bidx : -1;
+            varying |= bidx < variable_count;
+            ++bj.variable_count;
+        }
+
+        if (!varying) {
+            if (program.empty()) {
+                // shared with the reference state; resolved below
+                continue;
+            }
+            acc = acc * joint->origin *
+                    ComputeJointTransform(joint, GetJointPositions(state, joint));
+            continue;
+        }
+
+        if (program.empty()) {
+            // everything above the first varying joint is taken directly from
+            // the reference state
+            if (joint->parent != NULL) {
+                acc = *GetUpdatedLinkTransform(state, joint->parent);
+            }
+        }
+
+        bj.pre = acc * joint->origin;
+        program.push_back(bj);
+        acc = Affine3::Identity();
+    }
+
+    if (program.empty()) {
+        auto* T = GetUpdatedLinkTransform(state, link);
+        std::fill(transforms, transforms + count, *T);
+        return;
+    }
+
+    auto post_identity = acc.matrix().isIdentity(0.0);
+
+    for (int first = 0; first < count; first += FK_BATCH_WIDTH) {
+        auto n = std::min(FK_BATCH_WIDTH, count - first);
+
+        TransformLanes x;
+        for (size_t o = 0; o < program.size(); ++o) {
+            auto& bj = program[o];
+            if (o == 0) {
+                SetLanes(&x, bj.pre);
+            } else {
+                ApplyTransform(&x, bj.pre);
+            }
+
+            // gather joint positions; unused lanes repeat the last
+            // configuration
+            double q[7][FK_BATCH_WIDTH];
+            for (int v = 0; v < bj.variable_count; ++v) {
+                for (int l = 0; l < FK_BATCH_WIDTH; ++l) {
+                    if (bj.batch_index[v] >= 0) {
+                        q[v][l] = positions[first + std::min(l, n - 1)][bj.batch_index[v]];
+                    } else {
+                        q[v][l] = state->positions[bj.state_index[v]];
+                    }
+                }
+            }
+
+            auto* joint = bj.joint;
+            switch (joint->kernel) {
+            case JointKernel::RotateX:
+            case JointKernel::RotateY:
+            case JointKernel::RotateZ:
+            {
+                int a, b;
+                GetRotationPlane(joint->kernel, &a, &b);
+                double c[FK_BATCH_WIDTH];
+                double s[FK_BATCH_WIDTH];
+                for (int l = 0; l < FK_BATCH_WIDTH; ++l) {
+                    c[l] = cos(q[0][l]);
+                    s[l] = joint->axis_sign * sin(q[0][l]);
+                }
+                ApplyPlaneRotation(&x, a, b, c, s);
+                break;
+            }
+            case JointKernel::Translate:
+                ApplyAxisTranslation(&x, joint->axis, q[0]);
+                break;
+            default:
+            {
+                for (int l = 0; l < n; ++l) {
+                    double lane_positions[7];
+                    for (int v = 0; v < bj.variable_count; ++v) {
+                        lane_positions[v] = q[v][l];
+                    }
+                    ApplyLaneTransform(
+                            &x, l, ComputeJointTransform(joint, lane_positions));
+                }
+                break;
+            }
+            }
+        }
+
+        if (!post_identity) {
+            ApplyTransform(&x, acc);
+        }
+
+        for (int l = 0; l < n; ++l) {
+            auto& T = transforms[first + l];
+            T.setIdentity();
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    T(i, j) = x.r[i][j][l];
+                }
+                T(i, 3) = x.t[i][l];
+            }
+        }
+    }
+}
+
 auto GetLinkTransform(const RobotState* state, const Link* link)
     -> const Affine3*
 {
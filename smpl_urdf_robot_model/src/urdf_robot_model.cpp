@@ -100,6 +100,25 @@ auto URDFRobotModel::computeFK(const smpl::RobotState& state)
     return *GetLinkTransform(&this->robot_state, this->planning_link);
 }
 
+void URDFRobotModel::computeFKBatch(
+    const smpl::RobotState* states,
+    int count,
+    Eigen::Affine3d* poses)
+{
+    std::vector<const double*> positions(count);
+    for (auto i = 0; i < count; ++i) {
+        positions[i] = states[i].data();
+    }
+    ComputeLinkTransforms(
+            &this->robot_state,
+            this->planning_link,
+            this->planning_to_state_variable.data(),
+            (int)this->planning_to_state_variable.size(),
+            positions.data(),
+            count,
+            poses);
+}
+
 double URDFRobotModel::minPosLimit(int jidx) const
 {
     return this->vprops[jidx].min_position;